@@ -43,9 +43,18 @@
 #include "disruptor_types.h"
 
 #include <limits.h>
+#include <stddef.h>
+#include <sched.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
+#include <sys/mman.h>
+#if defined __linux__
+    #include <linux/futex.h>
+    #include <linux/mempolicy.h>
+    #include <sys/syscall.h>
+#endif
 #ifdef HAVE_CONFIG_H
     #include "ac_config.h"
 #endif
@@ -65,13 +74,35 @@
 #define UNLIKELY__(expr__) (__builtin_expect(((expr__) ? 1 : 0), 0))
 
 /*
- * The number of times __builtin_ia32_pause() is being called before sched_yield().
- * Please experiment and find the best value for your use case and hardware.
+ * For how long, in nanoseconds, __builtin_ia32_pause() is being called
+ * before sched_yield(). The cost of a pause differs more than tenfold
+ * between x86 generations, so it is measured when a ring buffer is
+ * initialized and the spin budget is turned into a number of pauses
+ * from this. See also ring_buffer_set_spin_budget().
+ */
+#ifdef BUILTIN_SPIN_NANOSECONDS__
+#undef BUILTIN_SPIN_NANOSECONDS__
+#endif
+#define BUILTIN_SPIN_NANOSECONDS__ (20000)
+
+/*
+ * For how long, in nanoseconds, __builtin_ia32_pause() is being called
+ * in between two sched_yield() once the spin budget is spent. Yielding
+ * back to back would keep the core busy with system calls when no
+ * other thread is runnable.
  */
-#ifdef BUILTIN_WAIT_COUNT__
-#undef BUILTIN_WAIT_COUNT__
+#ifdef BUILTIN_YIELD_SPIN_NANOSECONDS__
+#undef BUILTIN_YIELD_SPIN_NANOSECONDS__
 #endif
-#define BUILTIN_WAIT_COUNT__ (5120)
+#define BUILTIN_YIELD_SPIN_NANOSECONDS__ (20000)
+
+/*
+ * The fewest pauses the adaptive spin budget goes down to.
+ */
+#ifdef BUILTIN_ADAPTIVE_MIN_SPINS__
+#undef BUILTIN_ADAPTIVE_MIN_SPINS__
+#endif
+#define BUILTIN_ADAPTIVE_MIN_SPINS__ (64)
 
 /*
  * An entry processor cursor spot that has this value is not used and
@@ -79,6 +110,673 @@
  */
 #define VACANT__ (UINT_FAST64_MAX)
 
+/*
+ * The wait strategies. They decide what entry processors and entry
+ * publishers do while waiting in the blocking functions:
+ *
+ * WAIT_STRATEGY_YIELD: Call __builtin_ia32_pause() for as long as the
+ * spin budget of the ring buffer allows and then sched_yield() after
+ * every BUILTIN_YIELD_SPIN_NANOSECONDS__ worth of pauses. The
+ * condition waited for is checked after every pause. This is the
+ * default.
+ *
+ * WAIT_STRATEGY_BUSY_SPIN: Call __builtin_ia32_pause() and nothing
+ * else. Lowest latency, but burns a full core.
+ *
+ * WAIT_STRATEGY_BLOCKING: Like WAIT_STRATEGY_YIELD for
+ * BUILTIN_YIELD_ROUNDS__ yields and then sleep on a futex until woken
+ * by a commit or a release. Only threads that are actually sleeping
+ * cost the other side anything. Falls back to WAIT_STRATEGY_TIMED on
+ * platforms without futexes.
+ *
+ * WAIT_STRATEGY_TIMED: Like WAIT_STRATEGY_YIELD for
+ * BUILTIN_YIELD_ROUNDS__ yields and then sleep for
+ * BUILTIN_PARK_NANOSECONDS__ at a time.
+ */
+#define WAIT_STRATEGY_YIELD (0)
+#define WAIT_STRATEGY_BUSY_SPIN (1)
+#define WAIT_STRATEGY_BLOCKING (2)
+#define WAIT_STRATEGY_TIMED (3)
+
+/*
+ * The number of sched_yield() calls after the spin budget, each one
+ * after BUILTIN_YIELD_SPIN_NANOSECONDS__ worth of pauses, before the
+ * blocking and timed wait strategies go to sleep.
+ */
+#ifdef BUILTIN_YIELD_ROUNDS__
+#undef BUILTIN_YIELD_ROUNDS__
+#endif
+#define BUILTIN_YIELD_ROUNDS__ (4)
+
+/*
+ * For how long the timed wait strategy sleeps at a time.
+ */
+#ifdef BUILTIN_PARK_NANOSECONDS__
+#undef BUILTIN_PARK_NANOSECONDS__
+#endif
+#define BUILTIN_PARK_NANOSECONDS__ (100000)
+
+/*
+ * Per call state of a waiting thread.
+ */
+struct waiter_t {
+        uint_fast64_t rounds;
+        uint32_t futex;
+        int sleeping;
+        const struct timespec *deadline;
+};
+
+/*
+ * How many busy spin rounds, or rounds within the spin budget, go by
+ * between reading the clock when waiting with a deadline.
+ */
+#define BUILTIN_DEADLINE_SPIN_ROUNDS__ (256)
+
+/*
+ * Opt-in statistics, compiled in by defining DISRUPTOR_STATS before
+ * including this file. Every thread counts in its own struct
+ * disruptor_stats_t, so counting costs neither locked instructions
+ * nor cache line transfers:
+ *
+ *   full_waits:   entry publishers waiting on a full ring buffer
+ *   commit_waits: entry publishers waiting on preceding commits
+ *   empty_waits:  entry processors waiting on an empty ring buffer
+ *   spins:        __builtin_ia32_pause() calls while waiting
+ *   yields:       sched_yield() calls while waiting
+ *   sleeps:       futex waits and sleeps while waiting
+ *   timeouts:     waits given up because of a deadline
+ *   batches:      entries made available per wait of entry processors
+ *
+ * A monitoring thread reads the statistics of all threads by
+ * disruptor_stats_snapshot() or disruptor_stats_foreach() without
+ * disturbing them. The statistics of a thread are kept after it
+ * exits. Please note that, as with everything else in this file,
+ * each translation unit has its own statistics.
+ *
+ * See also entry_processor_barrier_lag(), which is always available.
+ */
+#ifdef DISRUPTOR_STATS
+
+struct disruptor_stats_thread_t {
+        struct disruptor_stats_t stats;
+        struct disruptor_stats_thread_t *next;
+};
+
+static struct disruptor_stats_thread_t *disruptor_stats_threads__ __attribute__((unused));
+static __thread struct disruptor_stats_thread_t *disruptor_stats_self__ __attribute__((unused));
+
+/*
+ * Allocates the statistics of the calling thread on first use.
+ */
+static __attribute__((noinline, unused)) struct disruptor_stats_t*
+disruptor_stats_attach(void)
+{
+        static struct disruptor_stats_t discard;
+        struct disruptor_stats_thread_t *self;
+
+        if (posix_memalign((void**)&self, CACHE_LINE_SIZE, sizeof(struct disruptor_stats_thread_t)))
+                return &discard;
+        memset(self, 0, sizeof(struct disruptor_stats_thread_t));
+        self->next = __atomic_load_n(&disruptor_stats_threads__, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&disruptor_stats_threads__, &self->next, self, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+                ;
+        disruptor_stats_self__ = self;
+
+        return &self->stats;
+}
+
+static inline struct disruptor_stats_t*
+disruptor_stats_self(void)
+{
+        if (UNLIKELY__(!disruptor_stats_self__))
+                return disruptor_stats_attach();
+        return &disruptor_stats_self__->stats;
+}
+
+/*
+ * Copies the statistics in src, as written by another thread, to dst.
+ */
+static __attribute__((noinline, unused)) void
+disruptor_stats_copy(struct disruptor_stats_t * const dst,
+                     const struct disruptor_stats_t * const src)
+{
+        unsigned int n;
+
+        dst->full_waits = __atomic_load_n(&src->full_waits, __ATOMIC_RELAXED);
+        dst->commit_waits = __atomic_load_n(&src->commit_waits, __ATOMIC_RELAXED);
+        dst->empty_waits = __atomic_load_n(&src->empty_waits, __ATOMIC_RELAXED);
+        dst->spins = __atomic_load_n(&src->spins, __ATOMIC_RELAXED);
+        dst->yields = __atomic_load_n(&src->yields, __ATOMIC_RELAXED);
+        dst->sleeps = __atomic_load_n(&src->sleeps, __ATOMIC_RELAXED);
+        dst->timeouts = __atomic_load_n(&src->timeouts, __ATOMIC_RELAXED);
+        for (n = 0; n < DISRUPTOR_STATS_BATCH_BUCKETS; ++n)
+                dst->batches[n] = __atomic_load_n(&src->batches[n], __ATOMIC_RELAXED);
+}
+
+/*
+ * Calls func with a snapshot of the statistics of every thread that
+ * has counted anything and returns the number of threads.
+ */
+static __attribute__((noinline, unused)) unsigned int
+disruptor_stats_foreach(void (*func)(const struct disruptor_stats_t *snapshot, void *arg),
+                        void *arg)
+{
+        const struct disruptor_stats_thread_t *thread;
+        struct disruptor_stats_t snapshot;
+        unsigned int retv = 0;
+
+        for (thread = __atomic_load_n(&disruptor_stats_threads__, __ATOMIC_ACQUIRE); thread; thread = thread->next) {
+                disruptor_stats_copy(&snapshot, &thread->stats);
+                func(&snapshot, arg);
+                ++retv;
+        }
+
+        return retv;
+}
+
+/*
+ * Sums up the statistics of all threads in total and returns the
+ * number of threads.
+ */
+static __attribute__((noinline, unused)) unsigned int
+disruptor_stats_snapshot(struct disruptor_stats_t * const total)
+{
+        const struct disruptor_stats_thread_t *thread;
+        struct disruptor_stats_t snapshot;
+        unsigned int retv = 0;
+        unsigned int n;
+
+        memset(total, 0, sizeof(struct disruptor_stats_t));
+        for (thread = __atomic_load_n(&disruptor_stats_threads__, __ATOMIC_ACQUIRE); thread; thread = thread->next) {
+                disruptor_stats_copy(&snapshot, &thread->stats);
+                total->full_waits += snapshot.full_waits;
+                total->commit_waits += snapshot.commit_waits;
+                total->empty_waits += snapshot.empty_waits;
+                total->spins += snapshot.spins;
+                total->yields += snapshot.yields;
+                total->sleeps += snapshot.sleeps;
+                total->timeouts += snapshot.timeouts;
+                for (n = 0; n < DISRUPTOR_STATS_BATCH_BUCKETS; ++n)
+                        total->batches[n] += snapshot.batches[n];
+                ++retv;
+        }
+
+        return retv;
+}
+
+/*
+ * Only the owning thread writes, so a plain add stored atomically
+ * suffices for readers to never see torn values.
+ */
+#define STATS_ADD__(field__, n__)                                                                                \
+        do {                                                                                                     \
+                struct disruptor_stats_t * const stats__ = disruptor_stats_self();                               \
+                __atomic_store_n(&stats__->field__, stats__->field__ + (n__), __ATOMIC_RELAXED);                 \
+        } while (0)
+
+/*
+ * Counts the first round of a wait, so every wait counts once however
+ * long it takes.
+ */
+#define STATS_WAIT__(waiter__, stall__)                                 \
+        do {                                                            \
+                if (!(waiter__)->rounds && !(waiter__)->sleeping)       \
+                        STATS_ADD__(stall__, 1);                        \
+        } while (0)
+
+/*
+ * Counts the batch lo__ up to and including hi__ in the bucket of its
+ * power of two.
+ */
+#define STATS_BATCH__(lo__, hi__)                                                                                                \
+        do {                                                                                                                     \
+                struct disruptor_stats_t * const stats__ = disruptor_stats_self();                                               \
+                const unsigned int bucket__ = 63 - (unsigned int)__builtin_clzll((unsigned long long)((hi__) - (lo__) + 1) | 1); \
+                __atomic_store_n(&stats__->batches[bucket__], stats__->batches[bucket__] + 1, __ATOMIC_RELAXED);                 \
+        } while (0)
+
+#else
+
+#define STATS_ADD__(field__, n__) do { } while (0)
+#define STATS_WAIT__(waiter__, stall__) do { } while (0)
+#define STATS_BATCH__(lo__, hi__) do { } while (0)
+
+#endif
+
+/*
+ * Sets deadline to nanoseconds from now on the CLOCK_MONOTONIC
+ * clock, for use with the timed functions.
+ */
+static __attribute__((noinline, unused)) void
+deadline_after(struct timespec * const deadline,
+               const uint_fast64_t nanoseconds)
+{
+        clock_gettime(CLOCK_MONOTONIC, deadline);
+        deadline->tv_sec += (time_t)(nanoseconds / 1000000000);
+        deadline->tv_nsec += (long)(nanoseconds % 1000000000);
+        if (deadline->tv_nsec >= 1000000000) {
+                deadline->tv_nsec -= 1000000000;
+                ++deadline->tv_sec;
+        }
+}
+
+/*
+ * Returns the nanoseconds left until deadline, 0 (zero) if it has
+ * passed.
+ */
+static __attribute__((noinline, unused)) uint_fast64_t
+deadline_remaining(const struct timespec * const deadline)
+{
+        struct timespec now;
+        int_fast64_t remaining;
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        remaining = (int_fast64_t)(deadline->tv_sec - now.tv_sec) * 1000000000 + (deadline->tv_nsec - now.tv_nsec);
+
+        return remaining > 0 ? (uint_fast64_t)remaining : 0;
+}
+
+/*
+ * The spin budget in pauses, adaptive or not.
+ */
+#define SPIN_COUNT__(wait_strategy__, wait_state__) \
+        ((wait_strategy__)->adaptive ? __atomic_load_n(&(wait_state__)->spin_count, __ATOMIC_RELAXED) : (wait_strategy__)->spin_count)
+
+/*
+ * Called in a loop until the condition waited for is met. The
+ * blocking wait strategy first announces the thread as a waiter and
+ * returns so that the condition is checked once more before the
+ * thread is put to sleep. Otherwise a wake up could be lost.
+ *
+ * Returns 0 (zero) if the deadline of the waiter, if any, has passed,
+ * 1 (one) otherwise. The clock is only read in between rounds of
+ * back-off, so waiting with a deadline costs about the same as
+ * waiting without.
+ *
+ * Waiting is the slow path and thus kept out of line.
+ */
+static __attribute__((noinline, unused)) int
+wait_strategy_wait(const struct wait_strategy_t * const wait_strategy,
+                   struct wait_state_t * const wait_state,
+                   struct waiter_t * const waiter)
+{
+        struct timespec park = { 0, BUILTIN_PARK_NANOSECONDS__ };
+        uint_fast64_t remaining = BUILTIN_PARK_NANOSECONDS__;
+        const uint_fast64_t spin_count = SPIN_COUNT__(wait_strategy, wait_state);
+        const uint_fast64_t period = wait_strategy->yield_spin_count + 1;
+        const int within_budget = waiter->rounds < spin_count;
+        const uint_fast64_t backoff = within_budget ? 0 : waiter->rounds - spin_count;
+        const int yielding = backoff / period < BUILTIN_YIELD_ROUNDS__;
+        /* past the spin budget, only every period-th round backs off further */
+        const int spinning = WAIT_STRATEGY_BUSY_SPIN == wait_strategy->strategy || within_budget
+                || ((period - 1 != backoff % period) && (WAIT_STRATEGY_YIELD == wait_strategy->strategy || yielding));
+
+        if (waiter->deadline && (!spinning || !(waiter->rounds % BUILTIN_DEADLINE_SPIN_ROUNDS__))) {
+                remaining = deadline_remaining(waiter->deadline);
+                if (!remaining) {
+                        STATS_ADD__(timeouts, 1);
+                        return 0;
+                }
+        }
+
+        if (waiter->sleeping) {
+                STATS_ADD__(sleeps, 1);
+#if defined __linux__
+                if (waiter->deadline)
+                        syscall(SYS_futex, &wait_state->futex, FUTEX_WAIT_BITSET, waiter->futex, waiter->deadline, NULL, FUTEX_BITSET_MATCH_ANY);
+                else
+                        syscall(SYS_futex, &wait_state->futex, FUTEX_WAIT, waiter->futex, NULL, NULL, 0);
+#endif
+                __atomic_fetch_sub(&wait_state->waiters, 1, __ATOMIC_RELAXED);
+                waiter->sleeping = 0;
+                return 1;
+        }
+
+        ++waiter->rounds;
+        if (spinning) {
+                STATS_ADD__(spins, 1);
+                __builtin_ia32_pause();
+                return 1;
+        }
+        switch (wait_strategy->strategy) {
+#if defined __linux__
+        case WAIT_STRATEGY_BLOCKING:
+                if (yielding)
+                        break;
+                waiter->futex = __atomic_load_n(&wait_state->futex, __ATOMIC_ACQUIRE);
+                __atomic_fetch_add(&wait_state->waiters, 1, __ATOMIC_SEQ_CST);
+                __atomic_thread_fence(__ATOMIC_SEQ_CST);
+                waiter->sleeping = 1;
+                return 1;
+#else
+        case WAIT_STRATEGY_BLOCKING:
+#endif
+        case WAIT_STRATEGY_TIMED:
+                if (yielding)
+                        break;
+                if (remaining < BUILTIN_PARK_NANOSECONDS__)
+                        park.tv_nsec = (long)remaining;
+                STATS_ADD__(sleeps, 1);
+                nanosleep(&park, NULL);
+                return 1;
+        default:
+                break;
+        }
+        STATS_ADD__(yields, 1);
+        sched_yield();
+
+        return 1;
+}
+
+/*
+ * Ends a wait that took at least one round. Moves the adaptive spin
+ * budget an eighth of the way towards twice the pauses the wait took,
+ * if it ended while spinning or right after the first sched_yield(),
+ * and towards half the budget otherwise. Spinning thereby follows the
+ * waits that it can shorten and gives up on those that it cannot. The
+ * budget stays within BUILTIN_ADAPTIVE_MIN_SPINS__ and the calibrated
+ * spin budget.
+ */
+static __attribute__((noinline, unused)) void
+wait_strategy_finish(const struct wait_strategy_t * const wait_strategy,
+                     struct wait_state_t * const wait_state,
+                     const struct waiter_t * const waiter)
+{
+        const int_fast64_t spin_count = (int_fast64_t)SPIN_COUNT__(wait_strategy, wait_state);
+        int_fast64_t target;
+
+        if (waiter->sleeping)
+                __atomic_fetch_sub(&wait_state->waiters, 1, __ATOMIC_RELAXED);
+        if (!wait_strategy->adaptive || WAIT_STRATEGY_BUSY_SPIN == wait_strategy->strategy)
+                return;
+
+        if ((int_fast64_t)waiter->rounds <= spin_count + (int_fast64_t)wait_strategy->yield_spin_count + 1)
+                target = 2 * (int_fast64_t)waiter->rounds;
+        else
+                target = spin_count / 2;
+        if (target < BUILTIN_ADAPTIVE_MIN_SPINS__)
+                target = BUILTIN_ADAPTIVE_MIN_SPINS__;
+        if (target > (int_fast64_t)wait_strategy->spin_count)
+                target = (int_fast64_t)wait_strategy->spin_count;
+        target = spin_count + (target - spin_count) / 8;
+        __atomic_store_n(&wait_state->spin_count, (uint_fast64_t)target, __ATOMIC_RELAXED);
+}
+
+/*
+ * Must be called when the condition waited for has been met. Always
+ * in line, as it is no more than a test of waiter->rounds unless the
+ * thread had to wait.
+ */
+static inline __attribute__((always_inline)) void
+wait_strategy_done(const struct wait_strategy_t * const wait_strategy,
+                   struct wait_state_t * const wait_state,
+                   struct waiter_t * const waiter)
+{
+        if (UNLIKELY__(waiter->rounds))
+                wait_strategy_finish(wait_strategy, wait_state, waiter);
+}
+
+/*
+ * The number of runs of 1000 pauses when measuring their cost.
+ */
+#ifdef BUILTIN_CALIBRATION_RUNS__
+#undef BUILTIN_CALIBRATION_RUNS__
+#endif
+#define BUILTIN_CALIBRATION_RUNS__ (8)
+
+/*
+ * Returns the cost of __builtin_ia32_pause() in picoseconds, as
+ * measured on first use. The fastest run is taken, so that being
+ * preempted while measuring does not count, and its nanoseconds are
+ * the picoseconds of a single pause.
+ */
+static __attribute__((noinline, unused)) uint_fast64_t
+pause_picoseconds(void)
+{
+        static uint_fast64_t picoseconds;
+        struct timespec start;
+        struct timespec end;
+        int_fast64_t elapsed;
+        int_fast64_t fastest = INT_FAST64_MAX;
+        unsigned int run;
+        unsigned int n;
+
+        if (__atomic_load_n(&picoseconds, __ATOMIC_RELAXED))
+                return picoseconds;
+        for (run = 0; run < BUILTIN_CALIBRATION_RUNS__; ++run) {
+                clock_gettime(CLOCK_MONOTONIC, &start);
+                for (n = 0; n < 1000; ++n)
+                        __builtin_ia32_pause();
+                clock_gettime(CLOCK_MONOTONIC, &end);
+                elapsed = (int_fast64_t)(end.tv_sec - start.tv_sec) * 1000000000 + (end.tv_nsec - start.tv_nsec);
+                if (elapsed < fastest)
+                        fastest = elapsed;
+        }
+        __atomic_store_n(&picoseconds, fastest > 0 ? (uint_fast64_t)fastest : 1, __ATOMIC_RELAXED);
+
+        return picoseconds;
+}
+
+/*
+ * Sets the spin budget to nanoseconds worth of pauses and turns the
+ * adaptive spin budget on or off.
+ */
+static __attribute__((noinline, unused)) void
+wait_strategy_set_spin_budget(struct wait_strategy_t * const wait_strategy,
+                              struct wait_state_t * const wait_state,
+                              const uint_fast64_t nanoseconds,
+                              const int adaptive)
+{
+        const uint_fast64_t spin_count = nanoseconds * 1000 / pause_picoseconds();
+        const uint_fast64_t yield_spin_count = BUILTIN_YIELD_SPIN_NANOSECONDS__ * 1000 / pause_picoseconds();
+
+        __atomic_store_n(&wait_strategy->spin_count, spin_count, __ATOMIC_RELAXED);
+        __atomic_store_n(&wait_strategy->yield_spin_count, yield_spin_count, __ATOMIC_RELAXED);
+        __atomic_store_n(&wait_state->spin_count, spin_count, __ATOMIC_RELAXED);
+        __atomic_store_n(&wait_strategy->adaptive, adaptive ? 1 : 0, __ATOMIC_SEQ_CST);
+}
+
+/*
+ * Values of the signal field of struct wait_strategy_t. Threads
+ * sleeping in the blocking wait strategy and pollers sleeping on an
+ * eventfd are each woken up by commits and releases.
+ */
+#define SIGNAL_FUTEX__ (1)
+#define SIGNAL_EVENTFD__ (2)
+
+/*
+ * Wakes up all sleeping threads, if any, and signals the eventfd of
+ * the ring buffer once per poller about to sleep on it.
+ */
+static __attribute__((noinline, unused)) void
+wait_strategy_wake(struct wait_state_t * const wait_state)
+{
+        uint64_t armed;
+
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&wait_state->waiters, __ATOMIC_RELAXED)) {
+                __atomic_fetch_add(&wait_state->futex, 1, __ATOMIC_RELEASE);
+#if defined __linux__
+                syscall(SYS_futex, &wait_state->futex, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#endif
+        }
+        if (__atomic_load_n(&wait_state->armed, __ATOMIC_RELAXED) && (armed = __atomic_exchange_n(&wait_state->armed, 0, __ATOMIC_ACQ_REL))) {
+                if (sizeof(armed) != write(__atomic_load_n(&wait_state->event_fd, __ATOMIC_RELAXED), &armed, sizeof(armed)))
+                        __atomic_fetch_add(&wait_state->armed, (uint32_t)armed, __ATOMIC_RELAXED);
+        }
+}
+
+/*
+ * Waits, as per the wait strategy of the ring buffer, until
+ * condition__ is true or, unless deadline__ is NULL, the
+ * CLOCK_MONOTONIC clock has passed deadline__. Evaluates to the last
+ * value of condition__. The wait state is mutable even in ring
+ * buffers that are otherwise only read, hence the cast.
+ *
+ * stall__ names the field of struct disruptor_stats_t counting the
+ * wait, if DISRUPTOR_STATS is defined.
+ */
+#define WAIT_UNTIL_DEADLINE__(ring_buffer__, condition__, deadline__, stall__)                                                             \
+({                                                                                                                                         \
+        int met__;                                                                                                                         \
+        struct waiter_t waiter__ = { 0, 0, 0, (deadline__) };                                                                              \
+                                                                                                                                           \
+        while (!(met__ = (condition__))) {                                                                                                 \
+                STATS_WAIT__(&waiter__, stall__);                                                                                          \
+                if (!wait_strategy_wait(&(ring_buffer__)->wait_strategy, (struct wait_state_t*)&(ring_buffer__)->wait_state, &waiter__)) { \
+                        met__ = (condition__);                                                                                             \
+                        break;                                                                                                             \
+                }                                                                                                                          \
+        }                                                                                                                                  \
+        wait_strategy_done(&(ring_buffer__)->wait_strategy, (struct wait_state_t*)&(ring_buffer__)->wait_state, &waiter__);                \
+        met__;                                                                                                                             \
+})
+
+/*
+ * Waits, as per the wait strategy of the ring buffer, until
+ * condition__ is true.
+ */
+#define WAIT_UNTIL__(ring_buffer__, condition__, stall__) \
+        ((void)WAIT_UNTIL_DEADLINE__(ring_buffer__, condition__, NULL, stall__))
+
+/*
+ * Wakes up sleeping threads after a commit or a release. Costs a load
+ * and a branch unless the blocking wait strategy or an eventfd is in
+ * use.
+ */
+#define SIGNAL__(ring_buffer__)                                           \
+        do {                                                              \
+                if (UNLIKELY__((ring_buffer__)->wait_strategy.signal))    \
+                        wait_strategy_wake(&(ring_buffer__)->wait_state); \
+        } while (0)
+
+/*
+ * Options for the ring buffer mapping functions defined by
+ * DEFINE_RING_BUFFER_MMAP and DEFINE_RUNTIME_RING_BUFFER_MMAP.
+ *
+ * RING_BUFFER_MAP_HUGETLB maps explicit huge pages, which must have
+ * been reserved by the administrator. If none are available then
+ * transparent huge pages are used instead, as if
+ * RING_BUFFER_MAP_THP had been given.
+ *
+ * RING_BUFFER_MAP_THP aligns the ring buffer to a huge page and
+ * advises the kernel to back it by transparent huge pages.
+ *
+ * RING_BUFFER_MAP_PREFAULT touches every page of the ring buffer, so
+ * that the first laps of the ring buffer take no page faults.
+ *
+ * RING_BUFFER_MAP_NUMA_BIND makes placement on the given NUMA node
+ * mandatory instead of preferred. Mapping fails if that is not
+ * possible.
+ *
+ * Huge pages are assumed to be HUGE_PAGE_SIZE bytes.
+ */
+#define RING_BUFFER_MAP_HUGETLB (1)
+#define RING_BUFFER_MAP_THP (2)
+#define RING_BUFFER_MAP_PREFAULT (4)
+#define RING_BUFFER_MAP_NUMA_BIND (8)
+
+/*
+ * Pass as numa_node to leave the placement of a ring buffer to the
+ * kernel.
+ */
+#define RING_BUFFER_ANY_NUMA_NODE (-1)
+
+#ifndef HUGE_PAGE_SIZE
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#endif
+
+/*
+ * Returns the length of the mapping for size bytes.
+ */
+static inline size_t
+memory_map_length(const size_t size,
+                  const unsigned int flags)
+{
+        const size_t granularity = (flags & (RING_BUFFER_MAP_HUGETLB | RING_BUFFER_MAP_THP)) ? HUGE_PAGE_SIZE : PAGE_SIZE;
+
+        return ((size + granularity - 1) / granularity) * granularity;
+}
+
+/*
+ * Maps size bytes of zeroed memory as per flags and places it on
+ * numa_node unless that is RING_BUFFER_ANY_NUMA_NODE. Returns NULL on
+ * failure. Huge page and NUMA options are ignored where unsupported.
+ */
+static __attribute__((noinline, unused)) void*
+memory_map(const size_t size,
+           const unsigned int flags,
+           const int numa_node)
+{
+        const size_t length = memory_map_length(size, flags);
+        uint8_t *addr = (uint8_t*)MAP_FAILED;
+        uint8_t *raw;
+        size_t head;
+        size_t n;
+
+#if defined MAP_HUGETLB
+        if (flags & RING_BUFFER_MAP_HUGETLB)
+                addr = (uint8_t*)mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+        if (MAP_FAILED == addr) {
+                if (flags & (RING_BUFFER_MAP_HUGETLB | RING_BUFFER_MAP_THP)) {
+                        // over-allocate and trim to get huge page alignment
+                        raw = (uint8_t*)mmap(NULL, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                        if (MAP_FAILED == raw)
+                                return NULL;
+                        head = (HUGE_PAGE_SIZE - ((uintptr_t)raw & (HUGE_PAGE_SIZE - 1))) & (HUGE_PAGE_SIZE - 1);
+                        addr = raw + head;
+                        if (head)
+                                munmap(raw, head);
+                        munmap(addr + length, HUGE_PAGE_SIZE - head);
+#if defined MADV_HUGEPAGE
+                        madvise(addr, length, MADV_HUGEPAGE);
+#endif
+                } else {
+                        addr = (uint8_t*)mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                        if (MAP_FAILED == addr)
+                                return NULL;
+                }
+        }
+
+#if defined __linux__
+        if (RING_BUFFER_ANY_NUMA_NODE != numa_node) {
+                unsigned long nodemask[16] = { 0 };
+
+                if ((numa_node < 0) || ((unsigned int)numa_node >= 8 * sizeof(nodemask)))
+                        goto err;
+                nodemask[numa_node / (8 * sizeof(unsigned long))] = 1UL << (numa_node % (8 * sizeof(unsigned long)));
+                if (syscall(SYS_mbind, addr, length, (flags & RING_BUFFER_MAP_NUMA_BIND) ? MPOL_BIND : MPOL_PREFERRED,
+                            nodemask, 8 * sizeof(nodemask), 0) && (flags & RING_BUFFER_MAP_NUMA_BIND))
+                        goto err;
+        }
+#endif
+
+        if (flags & RING_BUFFER_MAP_PREFAULT) {
+                for (n = 0; n < length; n += PAGE_SIZE)
+                        __atomic_store_n(addr + n, 0, __ATOMIC_RELAXED);
+        }
+
+        return addr;
+#if defined __linux__
+err:
+        munmap(addr, length);
+        return NULL;
+#endif
+}
+
+/*
+ * Unmaps memory mapped by memory_map(). size and flags must be the
+ * same as when mapping.
+ */
+static inline void
+memory_unmap(void * const addr,
+             const size_t size,
+             const unsigned int flags)
+{
+        munmap(addr, memory_map_length(size, flags));
+}
+
 /*
  * Cacheline padded elements of ring.
  */
@@ -88,6 +786,19 @@
             uint8_t padding[(CACHE_LINE_SIZE > sizeof(content_type__)) ? (CACHE_LINE_SIZE - sizeof(content_type__)) : (sizeof(uint_fast64_t) % CACHE_LINE_SIZE)]; \
     } __attribute__((aligned(CACHE_LINE_SIZE)))
 
+/*
+ * Densely packed elements of ring, for small contents. Entries share
+ * cache lines, so a batch of entries is read with fewer cache misses
+ * and hardware prefetching works in the favour of entry
+ * processors. Entry publishers writing neighbouring entries do however
+ * contend for the same cache lines, so prefer the padded entries with
+ * many entry publishers or large contents.
+ */
+#define DEFINE_PACKED_ENTRY_TYPE(content_type__, entry_type_name__) \
+    struct entry_type_name__ {                                      \
+            content_type__ content;                                 \
+    }
+
 /*
  * Entry processors may read up to and including max_read_cursor, but
  * no futher.
@@ -100,14 +811,97 @@
 #define DEFINE_RING_BUFFER_TYPE(entry_processor_capacity__, entry_capacity__, entry_type_name__, ring_buffer_type_name__) \
     struct ring_buffer_type_name__ {                                                                                      \
             struct count_t reduced_size;                                                                                  \
+            struct count_t entry_processor_capacity;                                                                      \
+            struct wait_strategy_t wait_strategy;                                                                         \
+            struct wait_state_t wait_state;                                                                               \
             struct cursor_t slowest_entry_processor;                                                                      \
             struct cursor_t max_read_cursor;                                                                              \
             struct cursor_t write_cursor;                                                                                 \
             struct cursor_t entry_processor_cursors[entry_processor_capacity__];                                          \
-            struct entry_type_name__ buffer[entry_capacity__];                                                            \
+            uint8_t entry_processor_gating[entry_processor_capacity__] __attribute__((aligned(CACHE_LINE_SIZE)));         \
+            struct entry_type_name__ buffer[entry_capacity__] __attribute__((aligned(CACHE_LINE_SIZE)));                  \
     } __attribute__((aligned(PAGE_SIZE)))
 
 
+/*
+ * Like DEFINE_RING_BUFFER_TYPE, but for ring buffers with multiple
+ * entry publishers that commit out of order.
+ *
+ * Each entry has a spot in the available array which holds the
+ * sequence number of the entry last committed into it. A sequence
+ * number is unique across wraps of the ring buffer, so this works as
+ * a published-round flag and no entry publisher ever waits for
+ * another to commit. Entry processors instead compute the highest
+ * contiguous committed sequence number themselves, so there is no
+ * max_read_cursor.
+ *
+ * entry_capacity__ MUST be a power of two.
+ */
+#define DEFINE_MP_RING_BUFFER_TYPE(entry_processor_capacity__, entry_capacity__, entry_type_name__, ring_buffer_type_name__) \
+    struct ring_buffer_type_name__ {                                                                                         \
+            struct count_t reduced_size;                                                                                     \
+            struct count_t entry_processor_capacity;                                                                         \
+            struct wait_strategy_t wait_strategy;                                                                            \
+            struct wait_state_t wait_state;                                                                                  \
+            struct cursor_t slowest_entry_processor;                                                                         \
+            struct cursor_t write_cursor;                                                                                    \
+            struct cursor_t entry_processor_cursors[entry_processor_capacity__];                                             \
+            uint8_t entry_processor_gating[entry_processor_capacity__] __attribute__((aligned(CACHE_LINE_SIZE)));            \
+            uint_fast64_t available[entry_capacity__] __attribute__((aligned(CACHE_LINE_SIZE)));                             \
+            struct entry_type_name__ buffer[entry_capacity__] __attribute__((aligned(CACHE_LINE_SIZE)));                     \
+    } __attribute__((aligned(PAGE_SIZE)))
+
+/*
+ * Like DEFINE_RING_BUFFER_TYPE, but for ring buffers with exactly one
+ * entry publisher.
+ *
+ * The write cursor is owned by the publisher, which also caches the
+ * slowest entry processor in it. Claiming and committing entries
+ * thereby needs no locked instructions at all. Use the SP publisher
+ * functions below together with the ordinary entry processor
+ * functions.
+ *
+ * entry_capacity__ MUST be a power of two.
+ */
+#define DEFINE_SP_RING_BUFFER_TYPE(entry_processor_capacity__, entry_capacity__, entry_type_name__, ring_buffer_type_name__) \
+    struct ring_buffer_type_name__ {                                                                                         \
+            struct count_t reduced_size;                                                                                     \
+            struct count_t entry_processor_capacity;                                                                         \
+            struct wait_strategy_t wait_strategy;                                                                            \
+            struct wait_state_t wait_state;                                                                                  \
+            struct cursor_t slowest_entry_processor;                                                                         \
+            struct cursor_t max_read_cursor;                                                                                 \
+            struct publisher_cursor_t write_cursor;                                                                          \
+            struct cursor_t entry_processor_cursors[entry_processor_capacity__];                                             \
+            uint8_t entry_processor_gating[entry_processor_capacity__] __attribute__((aligned(CACHE_LINE_SIZE)));            \
+            struct entry_type_name__ buffer[entry_capacity__] __attribute__((aligned(CACHE_LINE_SIZE)));                     \
+    } __attribute__((aligned(PAGE_SIZE)))
+
+/*
+ * Like DEFINE_RING_BUFFER_TYPE, but the number of entries and of entry
+ * processors is chosen at run time, when the ring buffer is allocated
+ * by the function defined by DEFINE_RUNTIME_RING_BUFFER_MALLOC. Such
+ * ring buffers are initialized by the function defined by
+ * DEFINE_RUNTIME_RING_BUFFER_INIT and otherwise used with the very
+ * same functions as those of DEFINE_RING_BUFFER_TYPE.
+ *
+ * The entries are a flexible array member. The entry processor cursors
+ * and gating flags follow the entries in the same allocation.
+ */
+#define DEFINE_RUNTIME_RING_BUFFER_TYPE(entry_type_name__, ring_buffer_type_name__)             \
+    struct ring_buffer_type_name__ {                                                            \
+            struct count_t reduced_size;                                                        \
+            struct count_t entry_processor_capacity;                                            \
+            struct wait_strategy_t wait_strategy;                                               \
+            struct wait_state_t wait_state;                                                     \
+            struct cursor_t slowest_entry_processor;                                            \
+            struct cursor_t max_read_cursor;                                                    \
+            struct cursor_t write_cursor;                                                       \
+            struct cursor_t *entry_processor_cursors __attribute__((aligned(CACHE_LINE_SIZE))); \
+            uint8_t *entry_processor_gating;                                                    \
+            struct entry_type_name__ buffer[] __attribute__((aligned(CACHE_LINE_SIZE)));        \
+    } __attribute__((aligned(PAGE_SIZE)))
+
 /*
  * This function returns a properly aligned ring buffer or NULL.
  */
@@ -120,20 +914,219 @@ ring_buffer_prefix__ ## ring_buffer_malloc(void)
         return (posix_memalign((void**)&retv, PAGE_SIZE, sizeof(struct ring_buffer_type_name__)) ? NULL : retv); \
 }
 
+/*
+ * Like the function defined by DEFINE_RING_BUFFER_MALLOC but maps the
+ * ring buffer as per flags, see RING_BUFFER_MAP_HUGETLB and friends,
+ * on numa_node. The ring buffer must be unmapped by the also defined
+ * ring_buffer_munmap() with the same flags.
+ */
+#define DEFINE_RING_BUFFER_MMAP(ring_buffer_type_name__, ring_buffer_prefix__...)                                     \
+static struct ring_buffer_type_name__ *                                                                               \
+ring_buffer_prefix__ ## ring_buffer_mmap(const unsigned int flags,                                                    \
+                                         const int numa_node)                                                         \
+{                                                                                                                     \
+        return (struct ring_buffer_type_name__*)memory_map(sizeof(struct ring_buffer_type_name__), flags, numa_node); \
+}                                                                                                                     \
+                                                                                                                      \
+static void                                                                                                           \
+ring_buffer_prefix__ ## ring_buffer_munmap(struct ring_buffer_type_name__ * const ring_buffer,                        \
+                                           const unsigned int flags)                                                  \
+{                                                                                                                     \
+        memory_unmap(ring_buffer, sizeof(struct ring_buffer_type_name__), flags);                                     \
+}
+
+/*
+ * Like the function defined by DEFINE_RUNTIME_RING_BUFFER_MALLOC but
+ * maps the ring buffer as per flags, see RING_BUFFER_MAP_HUGETLB and
+ * friends, on numa_node. The ring buffer must be unmapped by the also
+ * defined ring_buffer_munmap() with the same flags.
+ */
+#define DEFINE_RUNTIME_RING_BUFFER_MMAP(entry_type_name__, ring_buffer_type_name__, ring_buffer_prefix__...)                                                   \
+static struct ring_buffer_type_name__ *                                                                                                                        \
+ring_buffer_prefix__ ## ring_buffer_mmap(const uint_fast64_t entry_capacity,                                                                                   \
+                                         const uint_fast64_t entry_processor_capacity,                                                                         \
+                                         const unsigned int flags,                                                                                             \
+                                         const int numa_node)                                                                                                  \
+{                                                                                                                                                              \
+        struct ring_buffer_type_name__ *retv;                                                                                                                  \
+                                                                                                                                                               \
+        if (!RUNTIME_CAPACITY_IS_VALID__(entry_type_name__, ring_buffer_type_name__, entry_capacity, entry_processor_capacity))                                \
+                return NULL;                                                                                                                                   \
+        retv = memory_map(RUNTIME_RING_BUFFER_SIZE__(entry_type_name__, ring_buffer_type_name__, entry_capacity, entry_processor_capacity), flags, numa_node); \
+        if (retv)                                                                                                                                              \
+                RUNTIME_RING_BUFFER_SETUP__(entry_type_name__, retv, entry_capacity, entry_processor_capacity);                                                \
+                                                                                                                                                               \
+        return retv;                                                                                                                                           \
+}                                                                                                                                                              \
+                                                                                                                                                               \
+static void                                                                                                                                                    \
+ring_buffer_prefix__ ## ring_buffer_munmap(struct ring_buffer_type_name__ * const ring_buffer,                                                                 \
+                                           const unsigned int flags)                                                                                           \
+{                                                                                                                                                              \
+        memory_unmap(ring_buffer,                                                                                                                              \
+                     RUNTIME_RING_BUFFER_SIZE__(entry_type_name__, ring_buffer_type_name__,                                                                    \
+                                                ring_buffer->reduced_size.count + 1, ring_buffer->entry_processor_capacity.count),                             \
+                     flags);                                                                                                                                   \
+}
+
 /*
  * This function must always be invoked on a ring buffer before it is
  * put into use.
  */
-#define DEFINE_RING_BUFFER_INIT(entry_capacity__, ring_buffer_type_name__, ring_buffer_prefix__...) \
-static void                                                                                         \
-ring_buffer_prefix__ ## ring_buffer_init(struct ring_buffer_type_name__ * const ring_buffer)        \
+#define DEFINE_RING_BUFFER_INIT(entry_capacity__, ring_buffer_type_name__, ring_buffer_prefix__...)                          \
+static void                                                                                                                  \
+ring_buffer_prefix__ ## ring_buffer_init(struct ring_buffer_type_name__ * const ring_buffer)                                 \
+{                                                                                                                            \
+        unsigned int n;                                                                                                      \
+                                                                                                                             \
+        memset((void*)ring_buffer, 0, sizeof(struct ring_buffer_type_name__));                                               \
+        ring_buffer->entry_processor_capacity.count = sizeof(ring_buffer->entry_processor_cursors)/sizeof(struct cursor_t);  \
+        for (n = 0; n < ring_buffer->entry_processor_capacity.count; ++n) {                                                  \
+                ring_buffer->entry_processor_cursors[n].sequence = VACANT__;                                                 \
+                ring_buffer->entry_processor_gating[n] = 1;                                                                  \
+        }                                                                                                                    \
+        wait_strategy_set_spin_budget(&ring_buffer->wait_strategy, &ring_buffer->wait_state, BUILTIN_SPIN_NANOSECONDS__, 0); \
+        __atomic_store_n(&ring_buffer->reduced_size.count, entry_capacity__ - 1, __ATOMIC_SEQ_CST);                          \
+}
+
+/*
+ * Size in bytes of a ring buffer sized at run time. The entries are
+ * rounded up to whole cache lines so that the entry processor cursors
+ * following them are aligned.
+ */
+#define RUNTIME_ENTRIES_SIZE__(entry_type_name__, entry_capacity__)                                                           \
+        ((((entry_capacity__) * sizeof(struct entry_type_name__) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE) * CACHE_LINE_SIZE)
+#define RUNTIME_RING_BUFFER_SIZE__(entry_type_name__, ring_buffer_type_name__, entry_capacity__, entry_processor_capacity__) \
+        (offsetof(struct ring_buffer_type_name__, buffer)                                                                    \
+         + RUNTIME_ENTRIES_SIZE__(entry_type_name__, entry_capacity__)                                                       \
+         + (entry_processor_capacity__) * (sizeof(struct cursor_t) + sizeof(uint8_t)))
+
+/*
+ * Returns non-zero if a ring buffer sized at run time can have the
+ * given capacities, i.e. if entry_capacity__ is a power of two and
+ * the size of the ring buffer does not overflow a size_t.
+ */
+#define RUNTIME_CAPACITY_IS_VALID__(entry_type_name__, ring_buffer_type_name__, entry_capacity__, entry_processor_capacity__)                                            \
+        (((entry_capacity__) >= 2) && !((entry_capacity__) & ((entry_capacity__) - 1)) && (entry_processor_capacity__)                                                   \
+         && ((entry_capacity__) <= (SIZE_MAX - offsetof(struct ring_buffer_type_name__, buffer) - CACHE_LINE_SIZE) / sizeof(struct entry_type_name__))                   \
+         && ((entry_processor_capacity__) <= (SIZE_MAX - offsetof(struct ring_buffer_type_name__, buffer) - RUNTIME_ENTRIES_SIZE__(entry_type_name__, entry_capacity__)) \
+                                             / (sizeof(struct cursor_t) + sizeof(uint8_t))))
+
+/*
+ * Lays out freshly allocated memory as a ring buffer sized at run
+ * time.
+ */
+#define RUNTIME_RING_BUFFER_SETUP__(entry_type_name__, ring_buffer__, entry_capacity__, entry_processor_capacity__)                                                             \
+        do {                                                                                                                                                                    \
+                (ring_buffer__)->reduced_size.count = (entry_capacity__) - 1;                                                                                                   \
+                (ring_buffer__)->entry_processor_capacity.count = (entry_processor_capacity__);                                                                                 \
+                (ring_buffer__)->entry_processor_cursors = (struct cursor_t*)((uint8_t*)(ring_buffer__)->buffer + RUNTIME_ENTRIES_SIZE__(entry_type_name__, entry_capacity__)); \
+                (ring_buffer__)->entry_processor_gating = (uint8_t*)((ring_buffer__)->entry_processor_cursors + (entry_processor_capacity__));                                  \
+        } while (0)
+
+/*
+ * This function returns a properly aligned ring buffer with room for
+ * entry_capacity entries and entry_processor_capacity entry
+ * processors, or NULL. entry_capacity MUST be a power of two and NULL
+ * is returned if it is not, or if the size of the ring buffer would
+ * overflow. The ring buffer is released by free().
+ */
+#define DEFINE_RUNTIME_RING_BUFFER_MALLOC(entry_type_name__, ring_buffer_type_name__, ring_buffer_prefix__...)                                                          \
+static struct ring_buffer_type_name__ *                                                                                                                                 \
+ring_buffer_prefix__ ## ring_buffer_malloc(const uint_fast64_t entry_capacity,                                                                                          \
+                                           const uint_fast64_t entry_processor_capacity)                                                                                \
+{                                                                                                                                                                       \
+        struct ring_buffer_type_name__ *retv = NULL;                                                                                                                    \
+                                                                                                                                                                        \
+        if (!RUNTIME_CAPACITY_IS_VALID__(entry_type_name__, ring_buffer_type_name__, entry_capacity, entry_processor_capacity))                                         \
+                return NULL;                                                                                                                                            \
+        if (posix_memalign((void**)&retv, PAGE_SIZE, RUNTIME_RING_BUFFER_SIZE__(entry_type_name__, ring_buffer_type_name__, entry_capacity, entry_processor_capacity))) \
+                return NULL;                                                                                                                                            \
+        RUNTIME_RING_BUFFER_SETUP__(entry_type_name__, retv, entry_capacity, entry_processor_capacity);                                                                 \
+                                                                                                                                                                        \
+        return retv;                                                                                                                                                    \
+}
+
+/*
+ * This function must always be invoked on a ring buffer from the
+ * function defined by DEFINE_RUNTIME_RING_BUFFER_MALLOC before it is
+ * put into use. The size of the ring buffer is kept.
+ */
+#define DEFINE_RUNTIME_RING_BUFFER_INIT(entry_type_name__, ring_buffer_type_name__, ring_buffer_prefix__...)                                                                        \
+static void                                                                                                                                                                         \
+ring_buffer_prefix__ ## ring_buffer_init(struct ring_buffer_type_name__ * const ring_buffer)                                                                                        \
+{                                                                                                                                                                                   \
+        uint_fast64_t n;                                                                                                                                                            \
+                                                                                                                                                                                    \
+        memset((void*)&ring_buffer->wait_strategy, 0, offsetof(struct ring_buffer_type_name__, entry_processor_cursors) - offsetof(struct ring_buffer_type_name__, wait_strategy)); \
+        memset((void*)ring_buffer->buffer, 0, (ring_buffer->reduced_size.count + 1) * sizeof(struct entry_type_name__));                                                            \
+        for (n = 0; n < ring_buffer->entry_processor_capacity.count; ++n) {                                                                                                         \
+                ring_buffer->entry_processor_cursors[n].sequence = VACANT__;                                                                                                        \
+                ring_buffer->entry_processor_gating[n] = 1;                                                                                                                         \
+        }                                                                                                                                                                           \
+        wait_strategy_set_spin_budget(&ring_buffer->wait_strategy, &ring_buffer->wait_state, BUILTIN_SPIN_NANOSECONDS__, 0);                                                        \
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);                                                                                                                                    \
+}
+
+/*
+ * Sets the wait strategy of a ring buffer. Must be called after
+ * ring_buffer_init() and before the ring buffer is put into use.
+ */
+#define DEFINE_RING_BUFFER_SET_WAIT_STRATEGY_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)   \
+static __attribute__((noinline, unused)) void                                                             \
+ring_buffer_prefix__ ## ring_buffer_set_wait_strategy(struct ring_buffer_type_name__ * const ring_buffer, \
+                                                      const uint_fast32_t wait_strategy)                  \
+{                                                                                                         \
+        __atomic_store_n(&ring_buffer->wait_strategy.signal,                                              \
+                         (ring_buffer->wait_strategy.signal & SIGNAL_EVENTFD__)                           \
+                         | ((WAIT_STRATEGY_BLOCKING == wait_strategy) ? SIGNAL_FUTEX__ : 0),              \
+                         __ATOMIC_RELAXED);                                                               \
+        __atomic_store_n(&ring_buffer->wait_strategy.strategy, wait_strategy, __ATOMIC_SEQ_CST);          \
+}
+
+/*
+ * Makes commits and releases signal event_fd, an eventfd, whenever a
+ * poller is about to sleep on it, so that it can be waited for in
+ * e.g. an epoll event loop. A negative event_fd stops the signalling.
+ * Must be called after ring_buffer_init() and before the ring buffer
+ * is put into use. The eventfd is owned by the caller, who should
+ * create it non-blocking and read(2) it whenever it is readable. If
+ * several pollers sleep on it, it should be created with
+ * EFD_SEMAPHORE, so that each of them reads a wake up of its own.
+ *
+ * Not for ring buffers shared with other processes, as the eventfd is
+ * only valid in the process that set it.
+ */
+#define DEFINE_RING_BUFFER_SET_EVENTFD_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)   \
+static __attribute__((noinline, unused)) void                                                       \
+ring_buffer_prefix__ ## ring_buffer_set_eventfd(struct ring_buffer_type_name__ * const ring_buffer, \
+                                                const int event_fd)                                 \
 {                                                                                                   \
-        unsigned int n;                                                                             \
-                                                                                                    \
-        memset((void*)ring_buffer, 0, sizeof(struct ring_buffer_type_name__));                      \
-        for (n = 0; n < sizeof(ring_buffer->entry_processor_cursors)/sizeof(struct cursor_t); ++n)  \
-                ring_buffer->entry_processor_cursors[n].sequence = VACANT__;                        \
-        __atomic_store_n(&ring_buffer->reduced_size.count, entry_capacity__ - 1, __ATOMIC_SEQ_CST); \
+        __atomic_store_n(&ring_buffer->wait_state.armed, 0, __ATOMIC_RELAXED);                      \
+        __atomic_store_n(&ring_buffer->wait_state.event_fd, event_fd, __ATOMIC_RELAXED);            \
+        __atomic_store_n(&ring_buffer->wait_strategy.signal,                                        \
+                         (ring_buffer->wait_strategy.signal & SIGNAL_FUTEX__)                       \
+                         | ((0 <= event_fd) ? SIGNAL_EVENTFD__ : 0),                                \
+                         __ATOMIC_SEQ_CST);                                                         \
+}
+
+/*
+ * Sets for how long, in nanoseconds, the wait strategies other than
+ * WAIT_STRATEGY_BUSY_SPIN call __builtin_ia32_pause() before
+ * sched_yield(). ring_buffer_init() sets BUILTIN_SPIN_NANOSECONDS__.
+ *
+ * If adaptive is non-zero the spin budget is instead adapted to the
+ * waits seen, up to nanoseconds, so that spinning goes on for only
+ * as long as it tends to pay off. Must be called after
+ * ring_buffer_init() and before the ring buffer is put into use.
+ */
+#define DEFINE_RING_BUFFER_SET_SPIN_BUDGET_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)                \
+static inline void                                                                                                   \
+ring_buffer_prefix__ ## ring_buffer_set_spin_budget(struct ring_buffer_type_name__ * const ring_buffer,              \
+                                                    const uint_fast64_t nanoseconds,                                 \
+                                                    const int adaptive)                                              \
+{                                                                                                                    \
+        wait_strategy_set_spin_budget(&ring_buffer->wait_strategy, &ring_buffer->wait_state, nanoseconds, adaptive); \
 }
 
 /*
@@ -169,16 +1162,85 @@ ring_buffer_prefix__ ## ring_buffer_acquire_entry(struct ring_buffer_type_name__
         return &ring_buffer->buffer[ring_buffer->reduced_size.count & cursor->sequence];                               \
 }
 
+/*
+ * Sets spans and counts to the entries from lo->sequence up to and
+ * including hi->sequence, as contiguous arrays in the ring buffer,
+ * and returns the number of arrays. That is 2 (two) if the entries
+ * wrap around the end of the ring buffer and 1 (one) otherwise.
+ *
+ * This lets an entry processor hand a whole batch to memcpy(),
+ * writev() or a vectorized loop without computing the index of every
+ * entry. The range must be non-empty and hold no more entries than
+ * the capacity of the ring buffer.
+ */
+#define DEFINE_RING_BUFFER_SHOW_SPANS_FUNCTION(entry_type_name__, ring_buffer_type_name__, ring_buffer_prefix__...) \
+static inline unsigned int                                                                                          \
+ring_buffer_prefix__ ## ring_buffer_show_spans(const struct ring_buffer_type_name__ * const ring_buffer,            \
+                                               const struct cursor_t * __restrict__ const lo,                       \
+                                               const struct cursor_t * __restrict__ const hi,                       \
+                                               const struct entry_type_name__ *spans[2],                            \
+                                               uint_fast64_t counts[2])                                             \
+{                                                                                                                   \
+        const uint_fast64_t first = ring_buffer->reduced_size.count & lo->sequence;                                 \
+        const uint_fast64_t tail = ring_buffer->reduced_size.count + 1 - first;                                     \
+        const uint_fast64_t count = hi->sequence - lo->sequence + 1;                                                \
+                                                                                                                    \
+        spans[0] = &ring_buffer->buffer[first];                                                                     \
+        if (LIKELY__(count <= tail)) {                                                                              \
+                counts[0] = count;                                                                                  \
+                return 1;                                                                                           \
+        }                                                                                                           \
+        counts[0] = tail;                                                                                           \
+        spans[1] = ring_buffer->buffer;                                                                             \
+        counts[1] = count - tail;                                                                                   \
+                                                                                                                    \
+        return 2;                                                                                                   \
+}
+
+/*
+ * Like ring_buffer_show_spans() but for entry publishers, with
+ * non-const pointers into the entries they have claimed.
+ */
+#define DEFINE_RING_BUFFER_ACQUIRE_SPANS_FUNCTION(entry_type_name__, ring_buffer_type_name__, ring_buffer_prefix__...) \
+static inline unsigned int                                                                                             \
+ring_buffer_prefix__ ## ring_buffer_acquire_spans(struct ring_buffer_type_name__ * const ring_buffer,                  \
+                                                  const struct cursor_t * __restrict__ const lo,                       \
+                                                  const struct cursor_t * __restrict__ const hi,                       \
+                                                  struct entry_type_name__ *spans[2],                                  \
+                                                  uint_fast64_t counts[2])                                             \
+{                                                                                                                      \
+        const uint_fast64_t first = ring_buffer->reduced_size.count & lo->sequence;                                    \
+        const uint_fast64_t tail = ring_buffer->reduced_size.count + 1 - first;                                        \
+        const uint_fast64_t count = hi->sequence - lo->sequence + 1;                                                   \
+                                                                                                                       \
+        spans[0] = &ring_buffer->buffer[first];                                                                        \
+        if (LIKELY__(count <= tail)) {                                                                                 \
+                counts[0] = count;                                                                                     \
+                return 1;                                                                                              \
+        }                                                                                                              \
+        counts[0] = tail;                                                                                              \
+        spans[1] = ring_buffer->buffer;                                                                                \
+        counts[1] = count - tail;                                                                                      \
+                                                                                                                       \
+        return 2;                                                                                                      \
+}
+
 /*
  * Entry Processors must register before starting to process entries.
  *
  * They must furthermore update their spot, as identified by the
  * number returned when registering, in the entry_processor_cursors
- * array with the sequence number of the entry that they are currently
- * processing.
+ * array with the sequence number of the last entry that they have
+ * processed.
+ *
+ * The spot is seeded with the sequence number of the last entry
+ * released by the slowest entry processor, 0 (zero) on a fresh ring
+ * buffer, and the sequence number of the entry following it is
+ * returned. Entry processors depending on the one registering
+ * therefore never see an entry as done that it has not processed.
  */
 #define DEFINE_ENTRY_PROCESSOR_BARRIER_REGISTER_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)                                 \
-static inline uint_fast64_t                                                                                                                \
+static __attribute__((noinline, unused)) uint_fast64_t                                                                                     \
 ring_buffer_prefix__ ## entry_processor_barrier_register(struct ring_buffer_type_name__ * const ring_buffer,                               \
                                                          struct count_t * const entry_processor_number)                                    \
 {                                                                                                                                          \
@@ -186,7 +1248,7 @@ ring_buffer_prefix__ ## entry_processor_barrier_register(struct ring_buffer_type
         uint_fast64_t vacant = VACANT__;                                                                                                   \
                                                                                                                                            \
         do {                                                                                                                               \
-                for (n = 0; n < sizeof(ring_buffer->entry_processor_cursors)/sizeof(struct cursor_t); ++n) {                               \
+                for (n = 0; n < ring_buffer->entry_processor_capacity.count; ++n) {                                                        \
                         if (__atomic_compare_exchange_n(&ring_buffer->entry_processor_cursors[n].sequence,                                 \
                                                         &vacant,                                                                           \
                                                         __atomic_load_n(&ring_buffer->slowest_entry_processor.sequence, __ATOMIC_CONSUME), \
@@ -200,24 +1262,42 @@ ring_buffer_prefix__ ## entry_processor_barrier_register(struct ring_buffer_type
                 }                                                                                                                          \
         } while (1);                                                                                                                       \
 out:                                                                                                                                       \
-        if (!ring_buffer->entry_processor_cursors[entry_processor_number->count].sequence) {                                               \
-                __atomic_store_n(&ring_buffer->entry_processor_cursors[entry_processor_number->count].sequence, 1, __ATOMIC_RELEASE);      \
-                return 1;                                                                                                                  \
-        }                                                                                                                                  \
-        return ring_buffer->entry_processor_cursors[entry_processor_number->count].sequence;                                               \
+        return 1 + ring_buffer->entry_processor_cursors[entry_processor_number->count].sequence;                                           \
 }
 
 /*
  * Entry Processors must unregister to free up their spot in the entry
  * processor array in the ring buffer, so that other processors can
- * hook on.
+ * hook on. Entry publishers blocked on the entry processor are woken
+ * up.
  */
 #define DEFINE_ENTRY_PROCESSOR_BARRIER_UNREGISTER_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)                         \
-static inline void                                                                                                                   \
+static __attribute__((noinline, unused)) void                                                                                        \
 ring_buffer_prefix__ ## entry_processor_barrier_unregister(struct ring_buffer_type_name__ * const ring_buffer,                       \
                                                            const struct count_t * const entry_processor_number)                      \
 {                                                                                                                                    \
+        __atomic_store_n(&ring_buffer->entry_processor_gating[entry_processor_number->count], 1, __ATOMIC_RELAXED);                  \
         __atomic_store_n(&ring_buffer->entry_processor_cursors[entry_processor_number->count].sequence, VACANT__, __ATOMIC_RELEASE); \
+        SIGNAL__(ring_buffer);                                                                                                       \
+}
+
+/*
+ * Returns how many entries claimed by the entry publishers the entry
+ * processor with number entry_processor_number has not released yet,
+ * or 0 (zero) if it is not registered. Entries claimed but not yet
+ * committed count as well. Meant for monitoring, from any thread.
+ */
+#define DEFINE_ENTRY_PROCESSOR_BARRIER_LAG_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)                                               \
+static __attribute__((noinline, unused)) uint_fast64_t                                                                                              \
+ring_buffer_prefix__ ## entry_processor_barrier_lag(const struct ring_buffer_type_name__ * const ring_buffer,                                       \
+                                                    const struct count_t * const entry_processor_number)                                            \
+{                                                                                                                                                   \
+        const uint_fast64_t seq = __atomic_load_n(&ring_buffer->entry_processor_cursors[entry_processor_number->count].sequence, __ATOMIC_ACQUIRE); \
+        const uint_fast64_t incur = __atomic_load_n(&ring_buffer->write_cursor.sequence, __ATOMIC_RELAXED);                                         \
+                                                                                                                                                    \
+        if (VACANT__ == seq || incur < seq)                                                                                                         \
+                return 0;                                                                                                                           \
+        return incur - seq;                                                                                                                         \
 }
 
 
@@ -226,20 +1306,16 @@ ring_buffer_prefix__ ## entry_processor_barrier_unregister(struct ring_buffer_ty
  * entry_processor_cursors array, by way of the register function, to
  * know with which sequence number to begin.
  */
-#define DEFINE_ENTRY_PROCESSOR_BARRIER_WAITFOR_BLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)          \
-static inline void                                                                                                          \
-ring_buffer_prefix__ ## entry_processor_barrier_wait_for_blocking(const struct ring_buffer_type_name__ * const ring_buffer, \
-                                                                  struct cursor_t * __restrict__ const cursor)              \
-{                                                                                                                           \
-        const struct cursor_t incur = { cursor->sequence, { 0 } };                                                          \
-                                                                                                                            \
-        while (incur.sequence > __atomic_load_n(&ring_buffer->max_read_cursor.sequence, __ATOMIC_RELAXED)) {                \
-                for (int i = 0; i < BUILTIN_WAIT_COUNT__; ++i) {                                                            \
-                        __builtin_ia32_pause();                                                                             \
-                }                                                                                                           \
-                sched_yield();                                                                                              \
-        }                                                                                                                   \
-        cursor->sequence = __atomic_load_n(&ring_buffer->max_read_cursor.sequence, __ATOMIC_ACQUIRE);                       \
+#define DEFINE_ENTRY_PROCESSOR_BARRIER_WAITFOR_BLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)                           \
+static inline void                                                                                                                           \
+ring_buffer_prefix__ ## entry_processor_barrier_wait_for_blocking(const struct ring_buffer_type_name__ * const ring_buffer,                  \
+                                                                  struct cursor_t * __restrict__ const cursor)                               \
+{                                                                                                                                            \
+        const struct cursor_t incur = { cursor->sequence, { 0 } };                                                                           \
+                                                                                                                                             \
+        WAIT_UNTIL__(ring_buffer, incur.sequence <= __atomic_load_n(&ring_buffer->max_read_cursor.sequence, __ATOMIC_RELAXED), empty_waits); \
+        cursor->sequence = __atomic_load_n(&ring_buffer->max_read_cursor.sequence, __ATOMIC_ACQUIRE);                                        \
+        STATS_BATCH__(incur.sequence, cursor->sequence);                                                                                     \
 }
 
 /*
@@ -258,10 +1334,32 @@ ring_buffer_prefix__ ## entry_processor_barrier_wait_for_nonblocking(const struc
                 return 0;                                                                                                      \
                                                                                                                                \
         cursor->sequence = __atomic_load_n(&ring_buffer->max_read_cursor.sequence, __ATOMIC_ACQUIRE);                          \
+        STATS_BATCH__(incur.sequence, cursor->sequence);                                                                       \
                                                                                                                                \
         return 1;                                                                                                              \
 }
 
+/*
+ * Like the blocking version but gives up once the CLOCK_MONOTONIC
+ * clock passes deadline. Returns 1 (one) if at least one entry is
+ * available, 0 (zero) if the deadline passed first.
+ */
+#define DEFINE_ENTRY_PROCESSOR_BARRIER_WAITFOR_TIMED_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)                                                      \
+static inline __attribute__((always_inline)) int                                                                                                                     \
+ring_buffer_prefix__ ## entry_processor_barrier_wait_for_timed(const struct ring_buffer_type_name__ * const ring_buffer,                                             \
+                                                               struct cursor_t * __restrict__ const cursor,                                                          \
+                                                               const struct timespec * __restrict__ const deadline)                                                  \
+{                                                                                                                                                                    \
+        const struct cursor_t incur = { cursor->sequence, { 0 } };                                                                                                   \
+                                                                                                                                                                     \
+        if (!WAIT_UNTIL_DEADLINE__(ring_buffer, incur.sequence <= __atomic_load_n(&ring_buffer->max_read_cursor.sequence, __ATOMIC_RELAXED), deadline, empty_waits)) \
+                return 0;                                                                                                                                            \
+        cursor->sequence = __atomic_load_n(&ring_buffer->max_read_cursor.sequence, __ATOMIC_ACQUIRE);                                                                \
+        STATS_BATCH__(incur.sequence, cursor->sequence);                                                                                                             \
+                                                                                                                                                                     \
+        return 1;                                                                                                                                                    \
+}
+
 /*
  * Entry Processors must tell the ring buffer how far they are done
  * reading the entries.
@@ -272,9 +1370,181 @@ ring_buffer_prefix__ ## entry_processor_barrier_release_entry(struct ring_buffer
                                                               const struct count_t * __restrict__ const entry_processor_number,              \
                                                               const struct cursor_t * __restrict__ const cursor)                             \
 {                                                                                                                                            \
-        __atomic_store_n(&ring_buffer->entry_processor_cursors[entry_processor_number->count].sequence, cursor->sequence, __ATOMIC_RELAXED); \
+        __atomic_store_n(&ring_buffer->entry_processor_cursors[entry_processor_number->count].sequence, cursor->sequence, __ATOMIC_RELEASE); \
+        SIGNAL__(ring_buffer);                                                                                                               \
+}
+
+/*
+ * Entry Processors may depend on other entry processors, upstream,
+ * instead of only on the entry publishers. Such an entry processor
+ * only sees entries that all of its upstream entry processors have
+ * released. This makes it possible to pipeline several stages of
+ * processing through a single ring buffer, e.g. journaling and
+ * replication in parallel followed by the business logic.
+ *
+ * Upstream entry processors are identified by the numbers they got
+ * when registering and must be registered before the entry processors
+ * depending on them. An upstream entry processor that has
+ * unregistered no longer holds back the entry processors depending on
+ * it. With none left they wait for the entry publishers only.
+ *
+ * Upstream entry processors are released before the entry processors
+ * depending on them, so entry publishers need only gate on the last
+ * stage. See entry_processor_barrier_set_gating().
+ *
+ * Only ring buffers that commit in order are supported, i.e. not
+ * those defined by DEFINE_MP_RING_BUFFER_TYPE.
+ */
+
+/*
+ * Returns the highest sequence number released by all of the upstream
+ * entry processors and committed by the entry publishers.
+ */
+#define UPSTREAM_SEQUENCE__(ring_buffer__, upstream__, upstream_count__)                                                                \
+({                                                                                                                                      \
+        unsigned int n__;                                                                                                               \
+        uint_fast64_t seq__;                                                                                                            \
+        uint_fast64_t upstream_seq__ = __atomic_load_n(&(ring_buffer__)->max_read_cursor.sequence, __ATOMIC_ACQUIRE);                   \
+                                                                                                                                        \
+        for (n__ = 0; n__ < (upstream_count__); ++n__) {                                                                                \
+                seq__ = __atomic_load_n(&(ring_buffer__)->entry_processor_cursors[(upstream__)[n__].count].sequence, __ATOMIC_ACQUIRE); \
+                if (seq__ < upstream_seq__)                                                                                             \
+                        upstream_seq__ = seq__;                                                                                         \
+        }                                                                                                                               \
+        upstream_seq__;                                                                                                                 \
+})
+
+/*
+ * Like entry_processor_barrier_wait_for_blocking() but waits for the
+ * upstream_count entry processors in upstream.
+ */
+#define DEFINE_ENTRY_PROCESSOR_BARRIER_WAITFOR_DEPENDENCIES_BLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)          \
+static inline void                                                                                                                       \
+ring_buffer_prefix__ ## entry_processor_barrier_wait_for_dependencies_blocking(const struct ring_buffer_type_name__ * const ring_buffer, \
+                                                                               const struct count_t * __restrict__ const upstream,       \
+                                                                               const unsigned int upstream_count,                        \
+                                                                               struct cursor_t * __restrict__ const cursor)              \
+{                                                                                                                                        \
+        uint_fast64_t seq;                                                                                                               \
+                                                                                                                                         \
+        WAIT_UNTIL__(ring_buffer, cursor->sequence <= (seq = UPSTREAM_SEQUENCE__(ring_buffer, upstream, upstream_count)), empty_waits);  \
+        STATS_BATCH__(cursor->sequence, seq);                                                                                            \
+        cursor->sequence = seq;                                                                                                          \
 }
 
+/*
+ * Like the blocking version. Returns 1 (one) if at least one entry is
+ * available, 0 (zero) otherwise.
+ */
+#define DEFINE_ENTRY_PROCESSOR_BARRIER_WAITFOR_DEPENDENCIES_NONBLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)          \
+static inline int                                                                                                                           \
+ring_buffer_prefix__ ## entry_processor_barrier_wait_for_dependencies_nonblocking(const struct ring_buffer_type_name__ * const ring_buffer, \
+                                                                                  const struct count_t * __restrict__ const upstream,       \
+                                                                                  const unsigned int upstream_count,                        \
+                                                                                  struct cursor_t * __restrict__ const cursor)              \
+{                                                                                                                                           \
+        const uint_fast64_t seq = UPSTREAM_SEQUENCE__(ring_buffer, upstream, upstream_count);                                               \
+                                                                                                                                            \
+        if (cursor->sequence > seq)                                                                                                         \
+                return 0;                                                                                                                   \
+        STATS_BATCH__(cursor->sequence, seq);                                                                                               \
+        cursor->sequence = seq;                                                                                                             \
+                                                                                                                                            \
+        return 1;                                                                                                                           \
+}
+
+/*
+ * Like the blocking version but gives up once the CLOCK_MONOTONIC
+ * clock passes deadline. Returns 1 (one) if at least one entry is
+ * available, 0 (zero) if the deadline passed first.
+ */
+#define DEFINE_ENTRY_PROCESSOR_BARRIER_WAITFOR_DEPENDENCIES_TIMED_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)                                    \
+static inline __attribute__((always_inline)) int                                                                                                                \
+ring_buffer_prefix__ ## entry_processor_barrier_wait_for_dependencies_timed(const struct ring_buffer_type_name__ * const ring_buffer,                           \
+                                                                            const struct count_t * __restrict__ const upstream,                                 \
+                                                                            const unsigned int upstream_count,                                                  \
+                                                                            struct cursor_t * __restrict__ const cursor,                                        \
+                                                                            const struct timespec * __restrict__ const deadline)                                \
+{                                                                                                                                                               \
+        uint_fast64_t seq;                                                                                                                                      \
+                                                                                                                                                                \
+        if (!WAIT_UNTIL_DEADLINE__(ring_buffer, cursor->sequence <= (seq = UPSTREAM_SEQUENCE__(ring_buffer, upstream, upstream_count)), deadline, empty_waits)) \
+                return 0;                                                                                                                                       \
+        STATS_BATCH__(cursor->sequence, seq);                                                                                                                   \
+        cursor->sequence = seq;                                                                                                                                 \
+                                                                                                                                                                \
+        return 1;                                                                                                                                               \
+}
+
+/*
+ * Decides whether the entry publishers wait for the given entry
+ * processor, which by default they do. Upstream entry processors may
+ * be excluded to save entry publishers from scanning them, as long as
+ * an entry processor depending on them remains registered. Entry
+ * processors are gating again once they unregister. Entry publishers
+ * blocked on the entry processor are woken up when it stops gating.
+ */
+#define DEFINE_ENTRY_PROCESSOR_BARRIER_SET_GATING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)                     \
+static inline void                                                                                                               \
+ring_buffer_prefix__ ## entry_processor_barrier_set_gating(struct ring_buffer_type_name__ * const ring_buffer,                   \
+                                                           const struct count_t * const entry_processor_number,                  \
+                                                           const int gating)                                                     \
+{                                                                                                                                \
+        __atomic_store_n(&ring_buffer->entry_processor_gating[entry_processor_number->count], gating ? 1 : 0, __ATOMIC_RELEASE); \
+        if (!gating)                                                                                                             \
+                SIGNAL__(ring_buffer);                                                                                           \
+}
+
+/*
+ * Scans the entry processor cursors and returns the sequence number
+ * of the slowest gating entry processor. If no gating entry processor
+ * is registered then the start of the lap containing hi__ is returned
+ * so that entry publishers never wait.
+ */
+#define SLOWEST_ENTRY_PROCESSOR__(ring_buffer__, hi__)                                                              \
+({                                                                                                                  \
+        unsigned int n__;                                                                                           \
+        uint_fast64_t seq__;                                                                                        \
+        uint_fast64_t slowest__ = VACANT__;                                                                         \
+                                                                                                                    \
+        for (n__ = 0; n__ < (ring_buffer__)->entry_processor_capacity.count; ++n__) {                               \
+                if (!__atomic_load_n(&(ring_buffer__)->entry_processor_gating[n__], __ATOMIC_RELAXED))              \
+                        continue;                                                                                   \
+                seq__ = __atomic_load_n(&(ring_buffer__)->entry_processor_cursors[n__].sequence, __ATOMIC_ACQUIRE); \
+                if (seq__ < slowest__)                                                                              \
+                        slowest__ = seq__;                                                                          \
+        }                                                                                                           \
+        if (VACANT__ == slowest__)                                                                                  \
+                slowest__ = (hi__) - ((ring_buffer__)->reduced_size.count & (hi__));                                \
+        slowest__;                                                                                                  \
+})
+
+/*
+ * Returns 1 (one) if an entry publisher may write up to and including
+ * the entry with sequence number hi__, 0 (zero) otherwise.
+ *
+ * slowest_entry_processor caches the slowest entry processor as last
+ * seen by any entry publisher. The entry processor cursors, which are
+ * all owned by other cores, are only scanned, and the cache only
+ * written, when hi__ would wrap past the cached value. A stale cache
+ * is always behind the entry processors and thereby safe. As entry
+ * processors release the entries they have processed, hi__ may lead
+ * the slowest of them by the whole ring buffer.
+ */
+#define HAS_CAPACITY__(ring_buffer__, hi__)                                                                                                                           \
+({                                                                                                                                                                    \
+        int retv__ = 1;                                                                                                                                               \
+        uint_fast64_t slowest__;                                                                                                                                      \
+                                                                                                                                                                      \
+        if (UNLIKELY__(((hi__) - __atomic_load_n(&(ring_buffer__)->slowest_entry_processor.sequence, __ATOMIC_ACQUIRE)) > (ring_buffer__)->reduced_size.count + 1)) { \
+                slowest__ = SLOWEST_ENTRY_PROCESSOR__(ring_buffer__, hi__);                                                                                           \
+                __atomic_store_n(&(ring_buffer__)->slowest_entry_processor.sequence, slowest__, __ATOMIC_RELEASE);                                                    \
+                retv__ = (((hi__) - slowest__) <= (ring_buffer__)->reduced_size.count + 1);                                                                           \
+        }                                                                                                                                                             \
+        retv__;                                                                                                                                                       \
+})
+
+
 /*
  * Entry Publishers must call this function to get an entry to write
  * into.  I have found that __ATOMIC_ACQUIRE (in the __atomic_load_n)
@@ -289,29 +1559,10 @@ static inline __attribute__((always_inline)) void
 ring_buffer_prefix__ ## publisher_next_entry_blocking(struct ring_buffer_type_name__ * const ring_buffer,                          \
                                                       struct cursor_t * __restrict__ const cursor)                                 \
 {                                                                                                                                  \
-        unsigned int n;                                                                                                            \
-        struct cursor_t seq;                                                                                                       \
-        struct cursor_t slowest_reader;                                                                                            \
         const struct cursor_t incur = { 1 + __atomic_fetch_add(&ring_buffer->write_cursor.sequence, 1, __ATOMIC_RELEASE), { 0 } }; \
                                                                                                                                    \
         cursor->sequence = incur.sequence;                                                                                         \
-        do {                                                                                                                       \
-                slowest_reader.sequence = VACANT__;                                                                                \
-                for (n = 0; n < sizeof(ring_buffer->entry_processor_cursors)/sizeof(struct cursor_t); ++n) {                       \
-                        seq.sequence = __atomic_load_n(&ring_buffer->entry_processor_cursors[n].sequence, __ATOMIC_ACQUIRE);       \
-                        if (seq.sequence < slowest_reader.sequence)                                                                \
-                                slowest_reader.sequence = seq.sequence;                                                            \
-                }                                                                                                                  \
-                if (UNLIKELY__(VACANT__ == slowest_reader.sequence))                                                               \
-                        slowest_reader.sequence = incur.sequence - (ring_buffer->reduced_size.count & incur.sequence);             \
-                __atomic_store_n(&ring_buffer->slowest_entry_processor.sequence, slowest_reader.sequence, __ATOMIC_RELEASE);       \
-                if (LIKELY__((incur.sequence - slowest_reader.sequence) <= ring_buffer->reduced_size.count))                       \
-                        return;                                                                                                    \
-                for (int i = 0; i < BUILTIN_WAIT_COUNT__; ++i) {                                                                   \
-                        __builtin_ia32_pause();                                                                                    \
-                }                                                                                                                  \
-                sched_yield();                                                                                                     \
-        } while (1);                                                                                                               \
+        WAIT_UNTIL__(ring_buffer, HAS_CAPACITY__(ring_buffer, incur.sequence), full_waits);                                        \
 }
 
 
@@ -324,22 +1575,11 @@ static inline int
 ring_buffer_prefix__ ## publisher_next_entry_nonblocking(struct ring_buffer_type_name__ * const ring_buffer,                                                \
                                                          struct cursor_t * __restrict__ const cursor)                                                       \
 {                                                                                                                                                           \
-        unsigned int n;                                                                                                                                     \
         struct cursor_t seq;                                                                                                                                \
-        struct cursor_t slowest_reader;                                                                                                                     \
         const struct cursor_t incur = { 1 + __atomic_load_n(&ring_buffer->write_cursor.sequence, __ATOMIC_RELAXED), { 0 } };                                \
                                                                                                                                                             \
         cursor->sequence = incur.sequence;                                                                                                                  \
-        slowest_reader.sequence = VACANT__;                                                                                                                 \
-        for (n = 0; n < sizeof(ring_buffer->entry_processor_cursors)/sizeof(struct cursor_t); ++n) {                                                        \
-                seq.sequence = __atomic_load_n(&ring_buffer->entry_processor_cursors[n].sequence, __ATOMIC_RELAXED);                                        \
-                if (seq.sequence < slowest_reader.sequence)                                                                                                 \
-                        slowest_reader.sequence = seq.sequence;                                                                                             \
-        }                                                                                                                                                   \
-        if (UNLIKELY__(VACANT__ == slowest_reader.sequence))                                                                                                \
-                slowest_reader.sequence = incur.sequence - (ring_buffer->reduced_size.count & incur.sequence);                                              \
-        __atomic_store_n(&ring_buffer->slowest_entry_processor.sequence, slowest_reader.sequence, __ATOMIC_RELAXED);                                        \
-        if (LIKELY__((incur.sequence - slowest_reader.sequence) <= ring_buffer->reduced_size.count)) {                                                      \
+        if (LIKELY__(HAS_CAPACITY__(ring_buffer, incur.sequence))) {                                                                                        \
                 seq.sequence = incur.sequence - 1;                                                                                                          \
                 if (__atomic_compare_exchange_n(&ring_buffer->write_cursor.sequence, &seq.sequence, incur.sequence, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) \
                         return 1;                                                                                                                           \
@@ -347,25 +1587,63 @@ ring_buffer_prefix__ ## publisher_next_entry_nonblocking(struct ring_buffer_type
         return 0;                                                                                                                                           \
 }
 
+
+/*
+ * Like the blocking version but gives up once the CLOCK_MONOTONIC
+ * clock passes deadline. Returns 1 (one) if a new entry was acquired,
+ * 0 (zero) if the deadline passed first.
+ *
+ * The entry is claimed only once there is room for it, so unlike with
+ * the blocking version nothing is left claimed on a time out. A lost
+ * race against another entry publisher is retried at once.
+ */
+#define DEFINE_ENTRY_PUBLISHER_NEXTENTRY_TIMED_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)                                                           \
+static inline __attribute__((always_inline)) int                                                                                                                    \
+ring_buffer_prefix__ ## publisher_next_entry_timed(struct ring_buffer_type_name__ * const ring_buffer,                                                              \
+                                                   struct cursor_t * __restrict__ const cursor,                                                                     \
+                                                   const struct timespec * __restrict__ const deadline)                                                             \
+{                                                                                                                                                                   \
+        int retv = 1;                                                                                                                                               \
+        struct cursor_t seq;                                                                                                                                        \
+        struct cursor_t incur;                                                                                                                                      \
+        struct waiter_t waiter = { 0, 0, 0, deadline };                                                                                                             \
+                                                                                                                                                                    \
+        do {                                                                                                                                                        \
+                incur.sequence = 1 + __atomic_load_n(&ring_buffer->write_cursor.sequence, __ATOMIC_RELAXED);                                                        \
+                if (LIKELY__(HAS_CAPACITY__(ring_buffer, incur.sequence))) {                                                                                        \
+                        seq.sequence = incur.sequence - 1;                                                                                                          \
+                        if (__atomic_compare_exchange_n(&ring_buffer->write_cursor.sequence, &seq.sequence, incur.sequence, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) \
+                                break;                                                                                                                              \
+                } else {                                                                                                                                            \
+                        STATS_WAIT__(&waiter, full_waits);                                                                                                          \
+                        if (!wait_strategy_wait(&ring_buffer->wait_strategy, &ring_buffer->wait_state, &waiter)) {                                                  \
+                                retv = 0;                                                                                                                           \
+                                break;                                                                                                                              \
+                        }                                                                                                                                           \
+                }                                                                                                                                                   \
+        } while (1);                                                                                                                                                \
+        wait_strategy_done(&ring_buffer->wait_strategy, &ring_buffer->wait_state, &waiter);                                                                         \
+        cursor->sequence = incur.sequence;                                                                                                                          \
+                                                                                                                                                                    \
+        return retv;                                                                                                                                                \
+}
+
+
 /*
  * Entry Publishers must call this function to commit the entry to the
  * entry processors. Blocks until the entry has been committed.
  */
-#define DEFINE_ENTRY_PUBLISHER_COMMITENTRY_BLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)         \
-static inline __attribute__((always_inline)) void                                                                      \
-ring_buffer_prefix__ ## publisher_commit_entry_blocking(struct ring_buffer_type_name__ * const ring_buffer,            \
-                                                        const struct cursor_t * __restrict__ const cursor)             \
-{                                                                                                                      \
-        const uint_fast64_t required_read_sequence = cursor->sequence - 1;                                             \
-                                                                                                                       \
-        while (__atomic_load_n(&ring_buffer->max_read_cursor.sequence, __ATOMIC_RELAXED) != required_read_sequence) {  \
-                for (int i = 0; i < BUILTIN_WAIT_COUNT__; ++i) {                                                       \
-                        __builtin_ia32_pause();                                                                        \
-                }                                                                                                      \
-                sched_yield();                                                                                         \
-        }                                                                                                              \
-                                                                                                                       \
-        __atomic_fetch_add(&ring_buffer->max_read_cursor.sequence, 1, __ATOMIC_RELEASE);                               \
+#define DEFINE_ENTRY_PUBLISHER_COMMITENTRY_BLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)                                        \
+static inline __attribute__((always_inline)) void                                                                                                     \
+ring_buffer_prefix__ ## publisher_commit_entry_blocking(struct ring_buffer_type_name__ * const ring_buffer,                                           \
+                                                        const struct cursor_t * __restrict__ const cursor)                                            \
+{                                                                                                                                                     \
+        const uint_fast64_t required_read_sequence = cursor->sequence - 1;                                                                            \
+                                                                                                                                                      \
+        WAIT_UNTIL__(ring_buffer, __atomic_load_n(&ring_buffer->max_read_cursor.sequence, __ATOMIC_RELAXED) == required_read_sequence, commit_waits); \
+                                                                                                                                                      \
+        __atomic_fetch_add(&ring_buffer->max_read_cursor.sequence, 1, __ATOMIC_RELEASE);                                                              \
+        SIGNAL__(ring_buffer);                                                                                                                        \
 }
 
 /*
@@ -384,8 +1662,432 @@ ring_buffer_prefix__ ## publisher_commit_entry_nonblocking(struct ring_buffer_ty
                 return 0;                                                                                         \
                                                                                                                   \
         __atomic_fetch_add(&ring_buffer->max_read_cursor.sequence, 1, __ATOMIC_RELEASE);                          \
+        SIGNAL__(ring_buffer);                                                                                    \
                                                                                                                   \
         return 1;                                                                                                 \
 }
 
+/*
+ * Entry Publishers may call this function to claim count consecutive
+ * entries, lo->sequence up to and including hi->sequence, with a
+ * single atomic operation on the write cursor.
+ *
+ * count must be at least 1 (one) and less than the capacity of the
+ * ring buffer.
+ */
+#define DEFINE_ENTRY_PUBLISHER_NEXTENTRIES_BLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)                             \
+static inline __attribute__((always_inline)) void                                                                                          \
+ring_buffer_prefix__ ## publisher_next_entries_blocking(struct ring_buffer_type_name__ * const ring_buffer,                                \
+                                                        const uint_fast64_t count,                                                         \
+                                                        struct cursor_t * __restrict__ const lo,                                           \
+                                                        struct cursor_t * __restrict__ const hi)                                           \
+{                                                                                                                                          \
+        const struct cursor_t incur = { count + __atomic_fetch_add(&ring_buffer->write_cursor.sequence, count, __ATOMIC_RELEASE), { 0 } }; \
+                                                                                                                                           \
+        lo->sequence = incur.sequence - count + 1;                                                                                         \
+        hi->sequence = incur.sequence;                                                                                                     \
+        WAIT_UNTIL__(ring_buffer, HAS_CAPACITY__(ring_buffer, incur.sequence), full_waits);                                                \
+}
+
+/*
+ * Like the blocking version. Returns 1 (one) if count new entries
+ * were acquired, 0 (zero) otherwise.
+ */
+#define DEFINE_ENTRY_PUBLISHER_NEXTENTRIES_NONBLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)                                           \
+static inline int                                                                                                                                           \
+ring_buffer_prefix__ ## publisher_next_entries_nonblocking(struct ring_buffer_type_name__ * const ring_buffer,                                              \
+                                                           const uint_fast64_t count,                                                                       \
+                                                           struct cursor_t * __restrict__ const lo,                                                         \
+                                                           struct cursor_t * __restrict__ const hi)                                                         \
+{                                                                                                                                                           \
+        struct cursor_t seq;                                                                                                                                \
+        const struct cursor_t incur = { count + __atomic_load_n(&ring_buffer->write_cursor.sequence, __ATOMIC_RELAXED), { 0 } };                            \
+                                                                                                                                                            \
+        lo->sequence = incur.sequence - count + 1;                                                                                                          \
+        hi->sequence = incur.sequence;                                                                                                                      \
+        if (LIKELY__(HAS_CAPACITY__(ring_buffer, incur.sequence))) {                                                                                        \
+                seq.sequence = incur.sequence - count;                                                                                                      \
+                if (__atomic_compare_exchange_n(&ring_buffer->write_cursor.sequence, &seq.sequence, incur.sequence, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) \
+                        return 1;                                                                                                                           \
+        }                                                                                                                                                   \
+        return 0;                                                                                                                                           \
+}
+
+
+/*
+ * Entry Publishers must call this function to commit a range of
+ * entries, as claimed by one of the next_entries functions, to the
+ * entry processors. Blocks until all entries preceding lo have been
+ * committed and then publishes the whole range with a single store.
+ */
+#define DEFINE_ENTRY_PUBLISHER_COMMITENTRIES_BLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)                                      \
+static inline __attribute__((always_inline)) void                                                                                                     \
+ring_buffer_prefix__ ## publisher_commit_entries_blocking(struct ring_buffer_type_name__ * const ring_buffer,                                         \
+                                                          const struct cursor_t * __restrict__ const lo,                                              \
+                                                          const struct cursor_t * __restrict__ const hi)                                              \
+{                                                                                                                                                     \
+        const uint_fast64_t required_read_sequence = lo->sequence - 1;                                                                                \
+                                                                                                                                                      \
+        WAIT_UNTIL__(ring_buffer, __atomic_load_n(&ring_buffer->max_read_cursor.sequence, __ATOMIC_RELAXED) == required_read_sequence, commit_waits); \
+                                                                                                                                                      \
+        __atomic_store_n(&ring_buffer->max_read_cursor.sequence, hi->sequence, __ATOMIC_RELEASE);                                                     \
+        SIGNAL__(ring_buffer);                                                                                                                        \
+}
+
+/*
+ * Like the blocking version. Returns 1 (one) if the range has been
+ * commited, 0 (zero) otherwise.
+ */
+#define DEFINE_ENTRY_PUBLISHER_COMMITENTRIES_NONBLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...) \
+static inline int                                                                                                   \
+ring_buffer_prefix__ ## publisher_commit_entries_nonblocking(struct ring_buffer_type_name__ * const ring_buffer,    \
+                                                             const struct cursor_t * __restrict__ const lo,         \
+                                                             const struct cursor_t * __restrict__ const hi)         \
+{                                                                                                                   \
+        const uint_fast64_t required_read_sequence = lo->sequence - 1;                                              \
+                                                                                                                    \
+        if (__atomic_load_n(&ring_buffer->max_read_cursor.sequence, __ATOMIC_RELAXED) != required_read_sequence)    \
+                return 0;                                                                                           \
+                                                                                                                    \
+        __atomic_store_n(&ring_buffer->max_read_cursor.sequence, hi->sequence, __ATOMIC_RELEASE);                   \
+        SIGNAL__(ring_buffer);                                                                                      \
+                                                                                                                    \
+        return 1;                                                                                                   \
+}
+
+/*
+ * The out of order multi publisher variants of the wait_for and
+ * commit functions. They are drop-in replacements for the functions
+ * above and must be used with ring buffers defined by
+ * DEFINE_MP_RING_BUFFER_TYPE. The in-order functions remain the
+ * better choice with a single entry publisher.
+ *
+ * The ring buffer is initialized by DEFINE_RING_BUFFER_INIT as the
+ * zeroed available array never matches a sequence number that an
+ * entry processor will wait for.
+ */
+
+/*
+ * Returns non-zero if the entry with the given sequence number has
+ * been committed.
+ */
+#define MP_IS_AVAILABLE__(ring_buffer__, sequence__) \
+        ((sequence__) == __atomic_load_n(&(ring_buffer__)->available[(ring_buffer__)->reduced_size.count & (sequence__)], __ATOMIC_ACQUIRE))
+
+/*
+ * Entry Processors must read their spot in the
+ * entry_processor_cursors array, by way of the register function, to
+ * know with which sequence number to begin.
+ *
+ * Upon return cursor holds the highest sequence number up to which
+ * all entries have been committed.
+ */
+#define DEFINE_MP_ENTRY_PROCESSOR_BARRIER_WAITFOR_BLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)       \
+static inline void                                                                                                          \
+ring_buffer_prefix__ ## entry_processor_barrier_wait_for_blocking(const struct ring_buffer_type_name__ * const ring_buffer, \
+                                                                  struct cursor_t * __restrict__ const cursor)              \
+{                                                                                                                           \
+        uint_fast64_t seq = cursor->sequence;                                                                               \
+                                                                                                                            \
+        WAIT_UNTIL__(ring_buffer, MP_IS_AVAILABLE__(ring_buffer, seq), empty_waits);                                        \
+        while (MP_IS_AVAILABLE__(ring_buffer, seq + 1))                                                                     \
+                ++seq;                                                                                                      \
+        STATS_BATCH__(cursor->sequence, seq);                                                                               \
+        cursor->sequence = seq;                                                                                             \
+}
+
+/*
+ * Like the blocking version. Returns 1 (one) if at least one entry is
+ * available, 0 (zero) otherwise.
+ */
+#define DEFINE_MP_ENTRY_PROCESSOR_BARRIER_WAITFOR_NONBLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)       \
+static inline int                                                                                                              \
+ring_buffer_prefix__ ## entry_processor_barrier_wait_for_nonblocking(const struct ring_buffer_type_name__ * const ring_buffer, \
+                                                                     struct cursor_t * __restrict__ const cursor)              \
+{                                                                                                                              \
+        uint_fast64_t seq = cursor->sequence;                                                                                  \
+                                                                                                                               \
+        if (!MP_IS_AVAILABLE__(ring_buffer, seq))                                                                              \
+                return 0;                                                                                                      \
+        while (MP_IS_AVAILABLE__(ring_buffer, seq + 1))                                                                        \
+                ++seq;                                                                                                         \
+        STATS_BATCH__(cursor->sequence, seq);                                                                                  \
+        cursor->sequence = seq;                                                                                                \
+                                                                                                                               \
+        return 1;                                                                                                              \
+}
+
+/*
+ * Like the blocking version but gives up once the CLOCK_MONOTONIC
+ * clock passes deadline. Returns 1 (one) if at least one entry is
+ * available, 0 (zero) if the deadline passed first.
+ */
+#define DEFINE_MP_ENTRY_PROCESSOR_BARRIER_WAITFOR_TIMED_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)       \
+static inline __attribute__((always_inline)) int                                                                         \
+ring_buffer_prefix__ ## entry_processor_barrier_wait_for_timed(const struct ring_buffer_type_name__ * const ring_buffer, \
+                                                               struct cursor_t * __restrict__ const cursor,              \
+                                                               const struct timespec * __restrict__ const deadline)      \
+{                                                                                                                        \
+        uint_fast64_t seq = cursor->sequence;                                                                            \
+                                                                                                                         \
+        if (!WAIT_UNTIL_DEADLINE__(ring_buffer, MP_IS_AVAILABLE__(ring_buffer, seq), deadline, empty_waits))             \
+                return 0;                                                                                                \
+        while (MP_IS_AVAILABLE__(ring_buffer, seq + 1))                                                                  \
+                ++seq;                                                                                                   \
+        STATS_BATCH__(cursor->sequence, seq);                                                                            \
+        cursor->sequence = seq;                                                                                          \
+                                                                                                                         \
+        return 1;                                                                                                        \
+}
+
+/*
+ * Entry Publishers must call this function to commit the entry to the
+ * entry processors. It never waits for other entry publishers and the
+ * name is only kept so that the two modes are interchangeable.
+ */
+#define DEFINE_MP_ENTRY_PUBLISHER_COMMITENTRY_BLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)                          \
+static inline __attribute__((always_inline)) void                                                                                          \
+ring_buffer_prefix__ ## publisher_commit_entry_blocking(struct ring_buffer_type_name__ * const ring_buffer,                                \
+                                                        const struct cursor_t * __restrict__ const cursor)                                 \
+{                                                                                                                                          \
+        __atomic_store_n(&ring_buffer->available[ring_buffer->reduced_size.count & cursor->sequence], cursor->sequence, __ATOMIC_RELEASE); \
+        SIGNAL__(ring_buffer);                                                                                                             \
+}
+
+/*
+ * Always returns 1 (one).
+ */
+#define DEFINE_MP_ENTRY_PUBLISHER_COMMITENTRY_NONBLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)                       \
+static inline int                                                                                                                          \
+ring_buffer_prefix__ ## publisher_commit_entry_nonblocking(struct ring_buffer_type_name__ * const ring_buffer,                             \
+                                                           const struct cursor_t * __restrict__ const cursor)                              \
+{                                                                                                                                          \
+        __atomic_store_n(&ring_buffer->available[ring_buffer->reduced_size.count & cursor->sequence], cursor->sequence, __ATOMIC_RELEASE); \
+        SIGNAL__(ring_buffer);                                                                                                             \
+                                                                                                                                           \
+        return 1;                                                                                                                          \
+}
+
+/*
+ * Commits a range of entries as claimed by one of the next_entries
+ * functions. Never waits for other entry publishers.
+ */
+#define DEFINE_MP_ENTRY_PUBLISHER_COMMITENTRIES_BLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)      \
+static inline __attribute__((always_inline)) void                                                                        \
+ring_buffer_prefix__ ## publisher_commit_entries_blocking(struct ring_buffer_type_name__ * const ring_buffer,            \
+                                                          const struct cursor_t * __restrict__ const lo,                 \
+                                                          const struct cursor_t * __restrict__ const hi)                 \
+{                                                                                                                        \
+        uint_fast64_t seq;                                                                                               \
+                                                                                                                         \
+        for (seq = lo->sequence; seq <= hi->sequence; ++seq)                                                             \
+                __atomic_store_n(&ring_buffer->available[ring_buffer->reduced_size.count & seq], seq, __ATOMIC_RELEASE); \
+        SIGNAL__(ring_buffer);                                                                                           \
+}
+
+/*
+ * Always returns 1 (one).
+ */
+#define DEFINE_MP_ENTRY_PUBLISHER_COMMITENTRIES_NONBLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)   \
+static inline int                                                                                                        \
+ring_buffer_prefix__ ## publisher_commit_entries_nonblocking(struct ring_buffer_type_name__ * const ring_buffer,         \
+                                                             const struct cursor_t * __restrict__ const lo,              \
+                                                             const struct cursor_t * __restrict__ const hi)              \
+{                                                                                                                        \
+        uint_fast64_t seq;                                                                                               \
+                                                                                                                         \
+        for (seq = lo->sequence; seq <= hi->sequence; ++seq)                                                             \
+                __atomic_store_n(&ring_buffer->available[ring_buffer->reduced_size.count & seq], seq, __ATOMIC_RELEASE); \
+        SIGNAL__(ring_buffer);                                                                                           \
+                                                                                                                         \
+        return 1;                                                                                                        \
+}
+
+/*
+ * The single publisher variants of the entry publisher functions. They
+ * must be used with ring buffers defined by DEFINE_SP_RING_BUFFER_TYPE
+ * and must only ever be called from one thread at a time.
+ *
+ * The entry processors are only scanned when the claimed sequence
+ * number would wrap past the cached slowest entry processor.
+ */
+
+/*
+ * Returns 1 (one) if the publisher may write up to and including the
+ * entry with sequence number hi__, 0 (zero) otherwise. Rescans the
+ * entry processor cursors and updates the cached gating sequence if
+ * needed.
+ */
+#define SP_HAS_CAPACITY__(ring_buffer__, hi__)                                                                                \
+({                                                                                                                            \
+        int retv__ = 1;                                                                                                       \
+        uint_fast64_t slowest__;                                                                                              \
+                                                                                                                              \
+        if (UNLIKELY__(((hi__) - (ring_buffer__)->write_cursor.gating_sequence) > (ring_buffer__)->reduced_size.count + 1)) { \
+                slowest__ = SLOWEST_ENTRY_PROCESSOR__(ring_buffer__, hi__);                                                   \
+                (ring_buffer__)->write_cursor.gating_sequence = slowest__;                                                    \
+                __atomic_store_n(&(ring_buffer__)->slowest_entry_processor.sequence, slowest__, __ATOMIC_RELEASE);            \
+                retv__ = (((hi__) - slowest__) <= (ring_buffer__)->reduced_size.count + 1);                                   \
+        }                                                                                                                     \
+        retv__;                                                                                                               \
+})
+
+
+/*
+ * Entry Publishers must call this function to get an entry to write
+ * into.
+ */
+#define DEFINE_SP_ENTRY_PUBLISHER_NEXTENTRY_BLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...) \
+static inline __attribute__((always_inline)) void                                                               \
+ring_buffer_prefix__ ## publisher_next_entry_blocking(struct ring_buffer_type_name__ * const ring_buffer,       \
+                                                      struct cursor_t * __restrict__ const cursor)              \
+{                                                                                                               \
+        const uint_fast64_t incur = ring_buffer->write_cursor.sequence + 1;                                     \
+                                                                                                                \
+        WAIT_UNTIL__(ring_buffer, SP_HAS_CAPACITY__(ring_buffer, incur), full_waits);                           \
+        __atomic_store_n(&ring_buffer->write_cursor.sequence, incur, __ATOMIC_RELAXED);                         \
+        cursor->sequence = incur;                                                                               \
+}
+
+/*
+ * Like the blocking version. Returns 1 (one) if a new entry was
+ * acquired, 0 (zero) otherwise.
+ */
+#define DEFINE_SP_ENTRY_PUBLISHER_NEXTENTRY_NONBLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...) \
+static inline int                                                                                                  \
+ring_buffer_prefix__ ## publisher_next_entry_nonblocking(struct ring_buffer_type_name__ * const ring_buffer,       \
+                                                         struct cursor_t * __restrict__ const cursor)              \
+{                                                                                                                  \
+        const uint_fast64_t incur = ring_buffer->write_cursor.sequence + 1;                                        \
+                                                                                                                   \
+        if (!SP_HAS_CAPACITY__(ring_buffer, incur))                                                                \
+                return 0;                                                                                          \
+        __atomic_store_n(&ring_buffer->write_cursor.sequence, incur, __ATOMIC_RELAXED);                            \
+        cursor->sequence = incur;                                                                                  \
+                                                                                                                   \
+        return 1;                                                                                                  \
+}
+
+/*
+ * Like the blocking version but gives up once the CLOCK_MONOTONIC
+ * clock passes deadline. Returns 1 (one) if a new entry was acquired,
+ * 0 (zero) if the deadline passed first.
+ */
+#define DEFINE_SP_ENTRY_PUBLISHER_NEXTENTRY_TIMED_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)  \
+static inline __attribute__((always_inline)) int                                                              \
+ring_buffer_prefix__ ## publisher_next_entry_timed(struct ring_buffer_type_name__ * const ring_buffer,        \
+                                                   struct cursor_t * __restrict__ const cursor,               \
+                                                   const struct timespec * __restrict__ const deadline)       \
+{                                                                                                             \
+        const uint_fast64_t incur = ring_buffer->write_cursor.sequence + 1;                                   \
+                                                                                                              \
+        if (!WAIT_UNTIL_DEADLINE__(ring_buffer, SP_HAS_CAPACITY__(ring_buffer, incur), deadline, full_waits)) \
+                return 0;                                                                                     \
+        __atomic_store_n(&ring_buffer->write_cursor.sequence, incur, __ATOMIC_RELAXED);                       \
+        cursor->sequence = incur;                                                                             \
+                                                                                                              \
+        return 1;                                                                                             \
+}
+
+/*
+ * Claims count consecutive entries, lo->sequence up to and including
+ * hi->sequence.
+ *
+ * count must be at least 1 (one) and less than the capacity of the
+ * ring buffer.
+ */
+#define DEFINE_SP_ENTRY_PUBLISHER_NEXTENTRIES_BLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...) \
+static inline __attribute__((always_inline)) void                                                                 \
+ring_buffer_prefix__ ## publisher_next_entries_blocking(struct ring_buffer_type_name__ * const ring_buffer,       \
+                                                        const uint_fast64_t count,                                \
+                                                        struct cursor_t * __restrict__ const lo,                  \
+                                                        struct cursor_t * __restrict__ const hi)                  \
+{                                                                                                                 \
+        const uint_fast64_t incur = ring_buffer->write_cursor.sequence + count;                                   \
+                                                                                                                  \
+        WAIT_UNTIL__(ring_buffer, SP_HAS_CAPACITY__(ring_buffer, incur), full_waits);                             \
+        __atomic_store_n(&ring_buffer->write_cursor.sequence, incur, __ATOMIC_RELAXED);                           \
+        lo->sequence = incur - count + 1;                                                                         \
+        hi->sequence = incur;                                                                                     \
+}
+
+/*
+ * Like the blocking version. Returns 1 (one) if count new entries
+ * were acquired, 0 (zero) otherwise.
+ */
+#define DEFINE_SP_ENTRY_PUBLISHER_NEXTENTRIES_NONBLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...) \
+static inline int                                                                                                    \
+ring_buffer_prefix__ ## publisher_next_entries_nonblocking(struct ring_buffer_type_name__ * const ring_buffer,       \
+                                                           const uint_fast64_t count,                                \
+                                                           struct cursor_t * __restrict__ const lo,                  \
+                                                           struct cursor_t * __restrict__ const hi)                  \
+{                                                                                                                    \
+        const uint_fast64_t incur = ring_buffer->write_cursor.sequence + count;                                      \
+                                                                                                                     \
+        if (!SP_HAS_CAPACITY__(ring_buffer, incur))                                                                  \
+                return 0;                                                                                            \
+        __atomic_store_n(&ring_buffer->write_cursor.sequence, incur, __ATOMIC_RELAXED);                              \
+        lo->sequence = incur - count + 1;                                                                            \
+        hi->sequence = incur;                                                                                        \
+                                                                                                                     \
+        return 1;                                                                                                    \
+}
+
+/*
+ * Entry Publishers must call this function to commit the entry to the
+ * entry processors. Never blocks as there is no other publisher to
+ * wait for.
+ */
+#define DEFINE_SP_ENTRY_PUBLISHER_COMMITENTRY_BLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...) \
+static inline __attribute__((always_inline)) void                                                                 \
+ring_buffer_prefix__ ## publisher_commit_entry_blocking(struct ring_buffer_type_name__ * const ring_buffer,       \
+                                                        const struct cursor_t * __restrict__ const cursor)        \
+{                                                                                                                 \
+        __atomic_store_n(&ring_buffer->max_read_cursor.sequence, cursor->sequence, __ATOMIC_RELEASE);             \
+        SIGNAL__(ring_buffer);                                                                                    \
+}
+
+/*
+ * Always returns 1 (one).
+ */
+#define DEFINE_SP_ENTRY_PUBLISHER_COMMITENTRY_NONBLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...) \
+static inline int                                                                                                    \
+ring_buffer_prefix__ ## publisher_commit_entry_nonblocking(struct ring_buffer_type_name__ * const ring_buffer,       \
+                                                           const struct cursor_t * __restrict__ const cursor)        \
+{                                                                                                                    \
+        __atomic_store_n(&ring_buffer->max_read_cursor.sequence, cursor->sequence, __ATOMIC_RELEASE);                \
+        SIGNAL__(ring_buffer);                                                                                       \
+                                                                                                                     \
+        return 1;                                                                                                    \
+}
+
+/*
+ * Commits a range of entries as claimed by one of the next_entries
+ * functions.
+ */
+#define DEFINE_SP_ENTRY_PUBLISHER_COMMITENTRIES_BLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...) \
+static inline __attribute__((always_inline)) void                                                                   \
+ring_buffer_prefix__ ## publisher_commit_entries_blocking(struct ring_buffer_type_name__ * const ring_buffer,       \
+                                                          const struct cursor_t * __restrict__ const lo,            \
+                                                          const struct cursor_t * __restrict__ const hi)            \
+{                                                                                                                   \
+        __atomic_store_n(&ring_buffer->max_read_cursor.sequence, hi->sequence, __ATOMIC_RELEASE);                   \
+        SIGNAL__(ring_buffer);                                                                                      \
+}
+
+/*
+ * Always returns 1 (one).
+ */
+#define DEFINE_SP_ENTRY_PUBLISHER_COMMITENTRIES_NONBLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...) \
+static inline int                                                                                                      \
+ring_buffer_prefix__ ## publisher_commit_entries_nonblocking(struct ring_buffer_type_name__ * const ring_buffer,       \
+                                                             const struct cursor_t * __restrict__ const lo,            \
+                                                             const struct cursor_t * __restrict__ const hi)            \
+{                                                                                                                      \
+        __atomic_store_n(&ring_buffer->max_read_cursor.sequence, hi->sequence, __ATOMIC_RELEASE);                      \
+        SIGNAL__(ring_buffer);                                                                                         \
+                                                                                                                       \
+        return 1;                                                                                                      \
+}
+
 #endif //  DISRUPTORC_H
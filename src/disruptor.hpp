@@ -0,0 +1,539 @@
+/*
+ *    Copyright (C) 2012-2025, Jules Colding <jcolding@gmail.com>.
+ *
+ *    All Rights Reserved.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     (1) Redistributions of source code must retain the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer.
+ *
+ *     (2) Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *     (3) Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef DISRUPTORC_HPP
+#define DISRUPTORC_HPP
+
+#include <type_traits>
+
+#include "disruptor.h"
+
+/*
+ * C++17 front-end.
+ *
+ * RingBuffer<T, Capacity, MaxProcessors, ProducerPolicy, WaitPolicy>
+ * is a ring buffer of Capacity entries of type T, with room for
+ * MaxProcessors entry processors, along with all of its functions. It
+ * takes the place of the DEFINE_*_RING_BUFFER_TYPE macro and of the
+ * function macros that must otherwise be instantiated one by one with
+ * matching arguments.
+ *
+ * The ring buffer is laid out and synchronized exactly like its C
+ * counterpart and shares the wait strategies of disruptor.h. The
+ * capacities are however known at compile time, so the index mask
+ * and the number of entry processor cursors to scan are constants,
+ * and the producer and wait policies select their code paths at
+ * compile time instead of by a load and a branch at run time.
+ *
+ * ProducerPolicy is one of:
+ *
+ *   SingleProducer: Exactly one entry publisher, as with
+ *   DEFINE_SP_RING_BUFFER_TYPE.
+ *
+ *   MultiProducer: Any number of entry publishers committing in
+ *   order, as with DEFINE_RING_BUFFER_TYPE. This is the default.
+ *
+ *   UnorderedMultiProducer: Any number of entry publishers committing
+ *   out of order, as with DEFINE_MP_RING_BUFFER_TYPE.
+ *
+ * WaitPolicy is one of YieldWait, BusySpinWait, BlockingWait and
+ * TimedWait, see WAIT_STRATEGY_YIELD and friends. Only BlockingWait
+ * makes commits and releases wake up sleeping threads. Eventfds are
+ * not supported.
+ *
+ * The ring buffer is aligned to a page. Allocate it by new, statically
+ * or on the stack, but never copy or move it.
+ *
+ * Sequence numbers are those of the C functions, i.e. the first entry
+ * has sequence number 1 (one). The entries are stored as T, so declare
+ * T with alignas(CACHE_LINE_SIZE) to pad entries to a cache line each
+ * as DEFINE_ENTRY_TYPE does.
+ */
+namespace disruptor {
+
+struct SingleProducer {};
+struct MultiProducer {};
+struct UnorderedMultiProducer {};
+
+struct YieldWait {
+        static constexpr uint_fast32_t strategy = WAIT_STRATEGY_YIELD;
+};
+
+struct BusySpinWait {
+        static constexpr uint_fast32_t strategy = WAIT_STRATEGY_BUSY_SPIN;
+};
+
+struct BlockingWait {
+        static constexpr uint_fast32_t strategy = WAIT_STRATEGY_BLOCKING;
+};
+
+struct TimedWait {
+        static constexpr uint_fast32_t strategy = WAIT_STRATEGY_TIMED;
+};
+
+/*
+ * Waits, as per WaitPolicy, until condition__ is true. Busy spinning
+ * needs no wait state and is done in line.
+ */
+#define WAIT_POLICY_UNTIL__(condition__, stall__)                                   \
+        do {                                                                        \
+                if constexpr (WAIT_STRATEGY_BUSY_SPIN == WaitPolicy::strategy) {    \
+                        while (!(condition__))                                      \
+                                __builtin_ia32_pause();                             \
+                } else {                                                            \
+                        WAIT_UNTIL__(this, condition__, stall__);                   \
+                }                                                                   \
+        } while (0)
+
+template <typename T,
+          uint_fast64_t Capacity,
+          unsigned int MaxProcessors,
+          typename ProducerPolicy = MultiProducer,
+          typename WaitPolicy = YieldWait>
+class alignas(PAGE_SIZE) RingBuffer {
+        static_assert(Capacity >= 2 && !(Capacity & (Capacity - 1)), "Capacity must be a power of two");
+        static_assert(MaxProcessors >= 1, "MaxProcessors must be at least 1 (one)");
+        static_assert(std::is_same_v<ProducerPolicy, SingleProducer>
+                      || std::is_same_v<ProducerPolicy, MultiProducer>
+                      || std::is_same_v<ProducerPolicy, UnorderedMultiProducer>,
+                      "unknown ProducerPolicy");
+
+        static constexpr bool single_producer = std::is_same_v<ProducerPolicy, SingleProducer>;
+        static constexpr bool unordered = std::is_same_v<ProducerPolicy, UnorderedMultiProducer>;
+
+public:
+        using entry_type = T;
+        using producer_policy = ProducerPolicy;
+        using wait_policy = WaitPolicy;
+
+        static constexpr uint_fast64_t capacity = Capacity;
+        static constexpr unsigned int max_processors = MaxProcessors;
+
+        /*
+         * An entry processor, registered with the ring buffer for as
+         * long as it lives. It holds the sequence number of the next
+         * entry to read. The usual loop is:
+         *
+         *   RingBuffer<...>::Processor processor(ring);
+         *
+         *   for (;;) {
+         *           const uint_fast64_t hi = processor.wait_for();
+         *
+         *           for (uint_fast64_t n = processor.sequence(); n <= hi; ++n)
+         *                   ... ring[n] ...
+         *           processor.release(hi);
+         *   }
+         */
+        class Processor {
+        public:
+                explicit Processor(RingBuffer &ring)
+                        : ring_(ring),
+                          sequence_(ring.register_processor(number_))
+                {
+                }
+
+                ~Processor()
+                {
+                        ring_.unregister_processor(number_);
+                }
+
+                Processor(const Processor&) = delete;
+                Processor& operator=(const Processor&) = delete;
+
+                /*
+                 * Returns the ring buffer of the entry processor.
+                 */
+                RingBuffer&
+                ring_buffer() const
+                {
+                        return ring_;
+                }
+
+                /*
+                 * Returns the sequence number of the next entry to
+                 * read.
+                 */
+                uint_fast64_t
+                sequence() const
+                {
+                        return sequence_;
+                }
+
+                /*
+                 * Returns the number of the spot of the entry processor
+                 * in the ring buffer.
+                 */
+                unsigned int
+                number() const
+                {
+                        return (unsigned int)number_.count;
+                }
+
+                /*
+                 * Waits until the next entry has been committed and
+                 * returns the highest sequence number up to which all
+                 * entries have been committed.
+                 */
+                inline __attribute__((always_inline)) uint_fast64_t
+                wait_for() const
+                {
+                        return ring_.wait_for(sequence_);
+                }
+
+                /*
+                 * Like wait_for(). Returns false at once if the next
+                 * entry has not been committed yet.
+                 */
+                inline __attribute__((always_inline)) bool
+                try_wait_for(uint_fast64_t &hi) const
+                {
+                        return ring_.try_wait_for(sequence_, hi);
+                }
+
+                /*
+                 * Releases the entries up to and including sequence to
+                 * the entry publishers.
+                 */
+                inline __attribute__((always_inline)) void
+                release(const uint_fast64_t sequence)
+                {
+                        ring_.release(number_, sequence);
+                        sequence_ = sequence + 1;
+                }
+
+        private:
+                RingBuffer &ring_;
+                struct count_t number_;
+                uint_fast64_t sequence_;
+        };
+
+        RingBuffer()
+        {
+                unsigned int n;
+
+                memset((void*)&wait_strategy, 0, sizeof(wait_strategy));
+                memset((void*)&wait_state, 0, sizeof(wait_state));
+                slowest_entry_processor.sequence = 0;
+                max_read_cursor.sequence = 0;
+                memset((void*)&write_cursor, 0, sizeof(write_cursor));
+                for (n = 0; n < MaxProcessors; ++n) {
+                        entry_processor_cursors[n].sequence = VACANT__;
+                        entry_processor_gating[n] = 1;
+                }
+                if constexpr (unordered)
+                        memset((void*)available, 0, sizeof(available));
+                wait_strategy_set_spin_budget(&wait_strategy, &wait_state, BUILTIN_SPIN_NANOSECONDS__, 0);
+                wait_strategy.strategy = WaitPolicy::strategy;
+                wait_strategy.signal = (WAIT_STRATEGY_BLOCKING == WaitPolicy::strategy) ? SIGNAL_FUTEX__ : 0;
+                __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        }
+
+        RingBuffer(const RingBuffer&) = delete;
+        RingBuffer& operator=(const RingBuffer&) = delete;
+
+        /*
+         * See ring_buffer_set_spin_budget(). Must be called before the
+         * ring buffer is put into use.
+         */
+        void
+        set_spin_budget(const uint_fast64_t nanoseconds,
+                        const bool adaptive)
+        {
+                wait_strategy_set_spin_budget(&wait_strategy, &wait_state, nanoseconds, adaptive ? 1 : 0);
+        }
+
+        inline __attribute__((always_inline)) T&
+        operator[](const uint_fast64_t sequence)
+        {
+                return buffer[reduced_size.count & sequence];
+        }
+
+        inline __attribute__((always_inline)) const T&
+        operator[](const uint_fast64_t sequence) const
+        {
+                return buffer[reduced_size.count & sequence];
+        }
+
+        /*
+         * Claims the next entry and returns its sequence number. Waits
+         * for room if the ring buffer is full.
+         */
+        inline __attribute__((always_inline)) uint_fast64_t
+        next()
+        {
+                uint_fast64_t incur;
+
+                if constexpr (single_producer) {
+                        incur = write_cursor.sequence + 1;
+                        WAIT_POLICY_UNTIL__(SP_HAS_CAPACITY__(this, incur), full_waits);
+                        __atomic_store_n(&write_cursor.sequence, incur, __ATOMIC_RELAXED);
+                } else {
+                        incur = 1 + __atomic_fetch_add(&write_cursor.sequence, 1, __ATOMIC_RELEASE);
+                        WAIT_POLICY_UNTIL__(HAS_CAPACITY__(this, incur), full_waits);
+                }
+
+                return incur;
+        }
+
+        /*
+         * Like next(), but claims count consecutive entries and
+         * returns the sequence number of the last one. The first one
+         * is that minus count plus 1 (one).
+         *
+         * count must be at least 1 (one) and less than Capacity.
+         */
+        inline __attribute__((always_inline)) uint_fast64_t
+        next(const uint_fast64_t count)
+        {
+                uint_fast64_t incur;
+
+                if constexpr (single_producer) {
+                        incur = write_cursor.sequence + count;
+                        WAIT_POLICY_UNTIL__(SP_HAS_CAPACITY__(this, incur), full_waits);
+                        __atomic_store_n(&write_cursor.sequence, incur, __ATOMIC_RELAXED);
+                } else {
+                        incur = count + __atomic_fetch_add(&write_cursor.sequence, count, __ATOMIC_RELEASE);
+                        WAIT_POLICY_UNTIL__(HAS_CAPACITY__(this, incur), full_waits);
+                }
+
+                return incur;
+        }
+
+        /*
+         * Like next(). Returns false at once, having claimed nothing,
+         * if the ring buffer is full or another entry publisher got in
+         * first.
+         */
+        inline __attribute__((always_inline)) bool
+        try_next(uint_fast64_t &sequence)
+        {
+                uint_fast64_t incur;
+                uint_fast64_t seq;
+
+                if constexpr (single_producer) {
+                        incur = write_cursor.sequence + 1;
+                        if (!SP_HAS_CAPACITY__(this, incur))
+                                return false;
+                        __atomic_store_n(&write_cursor.sequence, incur, __ATOMIC_RELAXED);
+                } else {
+                        incur = 1 + __atomic_load_n(&write_cursor.sequence, __ATOMIC_RELAXED);
+                        if (!HAS_CAPACITY__(this, incur))
+                                return false;
+                        seq = incur - 1;
+                        if (!__atomic_compare_exchange_n(&write_cursor.sequence, &seq, incur, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                                return false;
+                }
+                sequence = incur;
+
+                return true;
+        }
+
+        /*
+         * Commits the entry with the given sequence number to the
+         * entry processors. With MultiProducer it waits for the
+         * preceding entries to be committed first.
+         */
+        inline __attribute__((always_inline)) void
+        commit(const uint_fast64_t sequence)
+        {
+                if constexpr (single_producer) {
+                        __atomic_store_n(&max_read_cursor.sequence, sequence, __ATOMIC_RELEASE);
+                } else if constexpr (unordered) {
+                        __atomic_store_n(&available[reduced_size.count & sequence], sequence, __ATOMIC_RELEASE);
+                } else {
+                        WAIT_POLICY_UNTIL__(__atomic_load_n(&max_read_cursor.sequence, __ATOMIC_RELAXED) == sequence - 1, commit_waits);
+                        __atomic_fetch_add(&max_read_cursor.sequence, 1, __ATOMIC_RELEASE);
+                }
+                signal();
+        }
+
+        /*
+         * Commits the entries lo up to and including hi, as claimed by
+         * next(count).
+         */
+        inline __attribute__((always_inline)) void
+        commit(const uint_fast64_t lo,
+               const uint_fast64_t hi)
+        {
+                uint_fast64_t seq;
+
+                if constexpr (single_producer) {
+                        __atomic_store_n(&max_read_cursor.sequence, hi, __ATOMIC_RELEASE);
+                } else if constexpr (unordered) {
+                        for (seq = lo; seq <= hi; ++seq)
+                                __atomic_store_n(&available[reduced_size.count & seq], seq, __ATOMIC_RELEASE);
+                } else {
+                        WAIT_POLICY_UNTIL__(__atomic_load_n(&max_read_cursor.sequence, __ATOMIC_RELAXED) == lo - 1, commit_waits);
+                        __atomic_store_n(&max_read_cursor.sequence, hi, __ATOMIC_RELEASE);
+                }
+                signal();
+        }
+
+        /*
+         * Claims the next entry, passes it to fill and commits it.
+         * Returns the sequence number of the entry.
+         */
+        template <typename Fill>
+        inline __attribute__((always_inline)) uint_fast64_t
+        publish(Fill &&fill)
+        {
+                const uint_fast64_t sequence = next();
+
+                fill((*this)[sequence]);
+                commit(sequence);
+
+                return sequence;
+        }
+
+private:
+        /*
+         * Same as entry_processor_barrier_register(). Returns the
+         * sequence number of the first entry to read.
+         */
+        __attribute__((noinline)) uint_fast64_t
+        register_processor(struct count_t &number)
+        {
+                unsigned int n;
+                uint_fast64_t vacant;
+
+                for (;;) {
+                        for (n = 0; n < MaxProcessors; ++n) {
+                                vacant = VACANT__;
+                                if (__atomic_compare_exchange_n(&entry_processor_cursors[n].sequence,
+                                                                &vacant,
+                                                                __atomic_load_n(&slowest_entry_processor.sequence, __ATOMIC_CONSUME),
+                                                                1,
+                                                                __ATOMIC_RELEASE,
+                                                                __ATOMIC_RELAXED)) {
+                                        number.count = n;
+                                        return 1 + entry_processor_cursors[n].sequence;
+                                }
+                        }
+                }
+        }
+
+        __attribute__((noinline)) void
+        unregister_processor(const struct count_t &number)
+        {
+                __atomic_store_n(&entry_processor_gating[number.count], 1, __ATOMIC_RELAXED);
+                __atomic_store_n(&entry_processor_cursors[number.count].sequence, VACANT__, __ATOMIC_RELEASE);
+                signal();
+        }
+
+        inline __attribute__((always_inline)) uint_fast64_t
+        wait_for(const uint_fast64_t sequence) const
+        {
+                uint_fast64_t seq = sequence;
+
+                if constexpr (unordered) {
+                        WAIT_POLICY_UNTIL__(MP_IS_AVAILABLE__(this, seq), empty_waits);
+                        while (MP_IS_AVAILABLE__(this, seq + 1))
+                                ++seq;
+                } else {
+                        WAIT_POLICY_UNTIL__(sequence <= __atomic_load_n(&max_read_cursor.sequence, __ATOMIC_RELAXED), empty_waits);
+                        seq = __atomic_load_n(&max_read_cursor.sequence, __ATOMIC_ACQUIRE);
+                }
+                STATS_BATCH__(sequence, seq);
+
+                return seq;
+        }
+
+        inline __attribute__((always_inline)) bool
+        try_wait_for(const uint_fast64_t sequence,
+                     uint_fast64_t &hi) const
+        {
+                uint_fast64_t seq = sequence;
+
+                if constexpr (unordered) {
+                        if (!MP_IS_AVAILABLE__(this, seq))
+                                return false;
+                        while (MP_IS_AVAILABLE__(this, seq + 1))
+                                ++seq;
+                } else {
+                        if (sequence > __atomic_load_n(&max_read_cursor.sequence, __ATOMIC_RELAXED))
+                                return false;
+                        seq = __atomic_load_n(&max_read_cursor.sequence, __ATOMIC_ACQUIRE);
+                }
+                STATS_BATCH__(sequence, seq);
+                hi = seq;
+
+                return true;
+        }
+
+        inline __attribute__((always_inline)) void
+        release(const struct count_t &number,
+                const uint_fast64_t sequence)
+        {
+                __atomic_store_n(&entry_processor_cursors[number.count].sequence, sequence, __ATOMIC_RELEASE);
+                signal();
+        }
+
+        /*
+         * Wakes up sleeping threads. Only threads waiting as per
+         * BlockingWait ever sleep, so nothing is done otherwise.
+         */
+        inline __attribute__((always_inline)) void
+        signal()
+        {
+                if constexpr (WAIT_STRATEGY_BLOCKING == WaitPolicy::strategy)
+                        wait_strategy_wake(&wait_state);
+        }
+
+        /*
+         * The names of the C ring buffer fields, so that the macros of
+         * disruptor.h apply as they are. reduced_size and
+         * entry_processor_capacity are constants.
+         */
+        static constexpr struct count_t reduced_size = { Capacity - 1, { 0 } };
+        static constexpr struct count_t entry_processor_capacity = { MaxProcessors, { 0 } };
+
+        struct wait_strategy_t wait_strategy;
+        struct wait_state_t wait_state;
+        struct cursor_t slowest_entry_processor;
+        struct cursor_t max_read_cursor;
+        std::conditional_t<single_producer, struct publisher_cursor_t, struct cursor_t> write_cursor;
+        struct cursor_t entry_processor_cursors[MaxProcessors];
+        alignas(CACHE_LINE_SIZE) uint8_t entry_processor_gating[MaxProcessors];
+        alignas(CACHE_LINE_SIZE) uint_fast64_t available[unordered ? Capacity : 1];
+        alignas(CACHE_LINE_SIZE) T buffer[Capacity];
+};
+
+} // namespace disruptor
+
+#endif //  DISRUPTORC_HPP
@@ -0,0 +1,335 @@
+/*
+ *    Copyright (C) 2012-2025, Jules Colding <jcolding@gmail.com>.
+ *
+ *    All Rights Reserved.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     (1) Redistributions of source code must retain the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer.
+ *
+ *     (2) Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *     (3) Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef DISRUPTORC_IO_H
+#define DISRUPTORC_IO_H
+
+#include "disruptor.h"
+
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+/*
+ * I/O adapters.
+ *
+ * The functions defined in this file move bytes between file
+ * descriptors and the entries of a ring buffer without copying them
+ * through a buffer of their own:
+ *
+ *   - io_recvmmsg() and io_readv() claim a batch of entries and read
+ *     straight into them with a single system call.
+ *
+ *   - io_sendmmsg() and io_writev() write a range of entries, e.g. as
+ *     handed to an entry processor, with as few system calls as the
+ *     file descriptor allows.
+ *
+ * The content of the entries must be defined by
+ * DEFINE_IO_CONTENT_TYPE, i.e. a length and up to max_length__ bytes
+ * of data.
+ *
+ * Entries claimed by the reading functions but left empty are given
+ * back if no other entry publisher has claimed entries since, and
+ * otherwise committed with a length of 0 (zero), which the writing
+ * functions skip. Reading blocks all other entry publishers from
+ * committing until it returns, so file descriptors should be
+ * non-blocking or at least readable when read.
+ *
+ * recvmmsg(2) and sendmmsg(2) are Linux specific and need _GNU_SOURCE
+ * to be defined before any system header is included.
+ */
+
+/*
+ * Most entries read or written with a single system call.
+ */
+#define IO_MAX_BATCH (64)
+
+/*
+ * Defines the content of entries for I/O, holding up to max_length__
+ * bytes.
+ */
+#define DEFINE_IO_CONTENT_TYPE(max_length__, io_content_type_name__) \
+    typedef struct {                                                 \
+            uint32_t length;                                         \
+            uint8_t data[max_length__];                              \
+    } io_content_type_name__
+
+/*
+ * Commits the first filled__ of the count__ entries from lo__ up to
+ * and including hi__ and gives back the rest, if possible.
+ */
+#define IO_COMMIT__(ring_buffer__, ring_buffer_prefix__, lo__, hi__, count__, filled__, entries__)                                             \
+        do {                                                                                                                                   \
+                uint_fast64_t claimed__ = (hi__).sequence;                                                                                     \
+                unsigned int n__;                                                                                                              \
+                                                                                                                                               \
+                if ((filled__) < (count__)) {                                                                                                  \
+                        if (__atomic_compare_exchange_n(&(ring_buffer__)->write_cursor.sequence, &claimed__, (lo__).sequence + (filled__) - 1, \
+                                                        0, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {                                              \
+                                (hi__).sequence = (lo__).sequence + (filled__) - 1;                                                            \
+                        } else {                                                                                                               \
+                                for (n__ = (filled__); n__ < (count__); ++n__)                                                                 \
+                                        (entries__)[n__]->content.length = 0;                                                                  \
+                        }                                                                                                                      \
+                }                                                                                                                              \
+                if ((lo__).sequence <= (hi__).sequence)                                                                                        \
+                        ring_buffer_prefix__ ## publisher_commit_entries_blocking(ring_buffer__, &(lo__), &(hi__));                            \
+        } while (0)
+
+/*
+ * Claims the next count entries, at most IO_MAX_BATCH, and reads a
+ * datagram into each of them with a single recvmmsg(2) on fd with
+ * flags. Returns the number of entries committed, or -1 and errno
+ * set. Datagrams longer than the entries are truncated.
+ *
+ * Uses the next entries, commit entries and acquire spans functions
+ * of the ring buffer, which must be defined with the same
+ * ring_buffer_prefix__ beforehand.
+ */
+#if defined __linux__
+#define DEFINE_IO_RECVMMSG_FUNCTION(entry_type_name__, ring_buffer_type_name__, ring_buffer_prefix__...)       \
+static __attribute__((noinline, unused)) int                                                                   \
+ring_buffer_prefix__ ## io_recvmmsg(struct ring_buffer_type_name__ * const ring_buffer,                        \
+                                    const int fd,                                                              \
+                                    unsigned int count,                                                        \
+                                    const int flags)                                                           \
+{                                                                                                              \
+        struct entry_type_name__ *entries[IO_MAX_BATCH];                                                       \
+        struct entry_type_name__ *spans[2];                                                                    \
+        uint_fast64_t counts[2];                                                                               \
+        struct mmsghdr msgs[IO_MAX_BATCH];                                                                     \
+        struct iovec iov[IO_MAX_BATCH];                                                                        \
+        struct cursor_t lo;                                                                                    \
+        struct cursor_t hi;                                                                                    \
+        unsigned int filled;                                                                                   \
+        unsigned int spans_count;                                                                              \
+        unsigned int n = 0;                                                                                    \
+        unsigned int k;                                                                                        \
+        int received;                                                                                          \
+        int error;                                                                                             \
+                                                                                                               \
+        if (!count)                                                                                            \
+                return 0;                                                                                      \
+        if (IO_MAX_BATCH < count)                                                                              \
+                count = IO_MAX_BATCH;                                                                          \
+        ring_buffer_prefix__ ## publisher_next_entries_blocking(ring_buffer, count, &lo, &hi);                 \
+        spans_count = ring_buffer_prefix__ ## ring_buffer_acquire_spans(ring_buffer, &lo, &hi, spans, counts); \
+        for (k = 0; k < spans_count; ++k) {                                                                    \
+                while (counts[k]--)                                                                            \
+                        entries[n++] = spans[k]++;                                                             \
+        }                                                                                                      \
+        memset(msgs, 0, count * sizeof(msgs[0]));                                                              \
+        for (n = 0; n < count; ++n) {                                                                          \
+                iov[n].iov_base = entries[n]->content.data;                                                    \
+                iov[n].iov_len = sizeof(entries[n]->content.data);                                             \
+                msgs[n].msg_hdr.msg_iov = &iov[n];                                                             \
+                msgs[n].msg_hdr.msg_iovlen = 1;                                                                \
+        }                                                                                                      \
+                                                                                                               \
+        received = recvmmsg(fd, msgs, count, flags, NULL);                                                     \
+        error = errno;                                                                                         \
+        filled = (0 < received) ? (unsigned int)received : 0;                                                  \
+        for (n = 0; n < filled; ++n)                                                                           \
+                entries[n]->content.length = msgs[n].msg_len;                                                  \
+        IO_COMMIT__(ring_buffer, ring_buffer_prefix__, lo, hi, count, filled, entries);                        \
+        errno = error;                                                                                         \
+                                                                                                               \
+        return (0 > received) ? -1 : (int)filled;                                                              \
+}
+
+/*
+ * Sends each entry from lo up to and including hi as a datagram on
+ * fd with flags, with as few sendmmsg(2) as possible. Skips empty
+ * entries. Returns 0 (zero) on success, -1 and errno set otherwise,
+ * to EIO if a sendmmsg(2) sent nothing.
+ */
+#define DEFINE_IO_SENDMMSG_FUNCTION(entry_type_name__, ring_buffer_type_name__, ring_buffer_prefix__...) \
+static __attribute__((noinline, unused)) int                                                             \
+ring_buffer_prefix__ ## io_sendmmsg(const struct ring_buffer_type_name__ * const ring_buffer,            \
+                                    const int fd,                                                        \
+                                    const struct cursor_t * __restrict__ const lo,                       \
+                                    const struct cursor_t * __restrict__ const hi,                       \
+                                    const int flags)                                                     \
+{                                                                                                        \
+        const struct entry_type_name__ *entry;                                                           \
+        struct mmsghdr msgs[IO_MAX_BATCH];                                                               \
+        struct iovec iov[IO_MAX_BATCH];                                                                  \
+        struct cursor_t n;                                                                               \
+        unsigned int count;                                                                              \
+        unsigned int sent;                                                                               \
+        int retv;                                                                                        \
+                                                                                                         \
+        for (n.sequence = lo->sequence; n.sequence <= hi->sequence; ) {                                  \
+                for (count = 0; (count < IO_MAX_BATCH) && (n.sequence <= hi->sequence); ++n.sequence) {  \
+                        entry = ring_buffer_prefix__ ## ring_buffer_show_entry(ring_buffer, &n);         \
+                        if (!entry->content.length)                                                      \
+                                continue;                                                                \
+                        iov[count].iov_base = (void*)entry->content.data;                                \
+                        iov[count].iov_len = entry->content.length;                                      \
+                        memset(&msgs[count], 0, sizeof(msgs[count]));                                    \
+                        msgs[count].msg_hdr.msg_iov = &iov[count];                                       \
+                        msgs[count].msg_hdr.msg_iovlen = 1;                                              \
+                        ++count;                                                                         \
+                }                                                                                        \
+                for (sent = 0; sent < count; sent += (unsigned int)retv) {                               \
+                        retv = sendmmsg(fd, &msgs[sent], count - sent, flags);                           \
+                        if (0 > retv) {                                                                  \
+                                if (EINTR == errno) {                                                    \
+                                        retv = 0;                                                        \
+                                        continue;                                                        \
+                                }                                                                        \
+                                return -1;                                                               \
+                        }                                                                                \
+                        if (!retv) {                                                                     \
+                                errno = EIO;                                                             \
+                                return -1;                                                               \
+                        }                                                                                \
+                }                                                                                        \
+        }                                                                                                \
+                                                                                                         \
+        return 0;                                                                                        \
+}
+#endif
+
+/*
+ * Claims the next count entries, at most IO_MAX_BATCH, and fills them
+ * one after the other with a single readv(2) on fd. Returns the
+ * number of entries committed, 0 (zero) at end of file, or -1 and
+ * errno set.
+ *
+ * Uses the next entries, commit entries and acquire spans functions
+ * of the ring buffer, which must be defined with the same
+ * ring_buffer_prefix__ beforehand.
+ */
+#define DEFINE_IO_READV_FUNCTION(entry_type_name__, ring_buffer_type_name__, ring_buffer_prefix__...)          \
+static __attribute__((noinline, unused)) int                                                                   \
+ring_buffer_prefix__ ## io_readv(struct ring_buffer_type_name__ * const ring_buffer,                           \
+                                 const int fd,                                                                 \
+                                 unsigned int count)                                                           \
+{                                                                                                              \
+        const size_t size = sizeof(((struct entry_type_name__*)0)->content.data);                              \
+        struct entry_type_name__ *entries[IO_MAX_BATCH];                                                       \
+        struct entry_type_name__ *spans[2];                                                                    \
+        uint_fast64_t counts[2];                                                                               \
+        struct iovec iov[IO_MAX_BATCH];                                                                        \
+        struct cursor_t lo;                                                                                    \
+        struct cursor_t hi;                                                                                    \
+        unsigned int filled;                                                                                   \
+        unsigned int spans_count;                                                                              \
+        unsigned int n = 0;                                                                                    \
+        unsigned int k;                                                                                        \
+        ssize_t length;                                                                                        \
+        int error;                                                                                             \
+                                                                                                               \
+        if (!count)                                                                                            \
+                return 0;                                                                                      \
+        if (IO_MAX_BATCH < count)                                                                              \
+                count = IO_MAX_BATCH;                                                                          \
+        ring_buffer_prefix__ ## publisher_next_entries_blocking(ring_buffer, count, &lo, &hi);                 \
+        spans_count = ring_buffer_prefix__ ## ring_buffer_acquire_spans(ring_buffer, &lo, &hi, spans, counts); \
+        for (k = 0; k < spans_count; ++k) {                                                                    \
+                while (counts[k]--)                                                                            \
+                        entries[n++] = spans[k]++;                                                             \
+        }                                                                                                      \
+        for (n = 0; n < count; ++n) {                                                                          \
+                iov[n].iov_base = entries[n]->content.data;                                                    \
+                iov[n].iov_len = size;                                                                         \
+        }                                                                                                      \
+                                                                                                               \
+        length = readv(fd, iov, (int)count);                                                                   \
+        error = errno;                                                                                         \
+        filled = (0 < length) ? (unsigned int)(((size_t)length + size - 1) / size) : 0;                        \
+        for (n = 0; n < filled; ++n)                                                                           \
+                entries[n]->content.length = (uint32_t)size;                                                   \
+        if (filled && ((size_t)length % size))                                                                 \
+                entries[filled - 1]->content.length = (uint32_t)((size_t)length % size);                       \
+        IO_COMMIT__(ring_buffer, ring_buffer_prefix__, lo, hi, count, filled, entries);                        \
+        errno = error;                                                                                         \
+                                                                                                               \
+        return (0 > length) ? -1 : (int)filled;                                                                \
+}
+
+/*
+ * Writes the entries from lo up to and including hi to fd, with as
+ * few writev(2) as possible. Skips empty entries. Returns 0 (zero) on
+ * success, -1 and errno set otherwise.
+ */
+#define DEFINE_IO_WRITEV_FUNCTION(entry_type_name__, ring_buffer_type_name__, ring_buffer_prefix__...)  \
+static __attribute__((noinline, unused)) int                                                            \
+ring_buffer_prefix__ ## io_writev(const struct ring_buffer_type_name__ * const ring_buffer,             \
+                                  const int fd,                                                         \
+                                  const struct cursor_t * __restrict__ const lo,                        \
+                                  const struct cursor_t * __restrict__ const hi)                        \
+{                                                                                                       \
+        const struct entry_type_name__ *entry;                                                          \
+        struct iovec iov[IO_MAX_BATCH];                                                                 \
+        struct iovec *next;                                                                             \
+        struct cursor_t n;                                                                              \
+        unsigned int count;                                                                             \
+        ssize_t length;                                                                                 \
+                                                                                                        \
+        for (n.sequence = lo->sequence; n.sequence <= hi->sequence; ) {                                 \
+                for (count = 0; (count < IO_MAX_BATCH) && (n.sequence <= hi->sequence); ++n.sequence) { \
+                        entry = ring_buffer_prefix__ ## ring_buffer_show_entry(ring_buffer, &n);        \
+                        if (!entry->content.length)                                                     \
+                                continue;                                                               \
+                        iov[count].iov_base = (void*)entry->content.data;                               \
+                        iov[count].iov_len = entry->content.length;                                     \
+                        ++count;                                                                        \
+                }                                                                                       \
+                for (next = iov; count; ) {                                                             \
+                        length = writev(fd, next, (int)count);                                          \
+                        if (0 > length) {                                                               \
+                                if (EINTR == errno)                                                     \
+                                        continue;                                                       \
+                                return -1;                                                              \
+                        }                                                                               \
+                        for (; count && ((size_t)length >= next->iov_len); --count)                     \
+                                length -= (ssize_t)(next++)->iov_len;                                   \
+                        if (count) {                                                                    \
+                                next->iov_base = (uint8_t*)next->iov_base + length;                     \
+                                next->iov_len -= (size_t)length;                                        \
+                        }                                                                               \
+                }                                                                                       \
+        }                                                                                               \
+                                                                                                        \
+        return 0;                                                                                       \
+}
+
+#endif //  DISRUPTORC_IO_H
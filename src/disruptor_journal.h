@@ -0,0 +1,414 @@
+/*
+ *    Copyright (C) 2012-2025, Jules Colding <jcolding@gmail.com>.
+ *
+ *    All Rights Reserved.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     (1) Redistributions of source code must retain the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer.
+ *
+ *     (2) Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *     (3) Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef DISRUPTORC_JOURNAL_H
+#define DISRUPTORC_JOURNAL_H
+
+#include "disruptor.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+/*
+ * Journals.
+ *
+ * A journal is an append-only file holding the entries of a ring
+ * buffer, so that they survive a crash and can be replayed into a
+ * fresh ring buffer at start up. It is written by an entry processor
+ * placed upstream of those that must only see durable entries,
+ * typically a batch processor with journal_on_entry() as its handler
+ * and the journal as its context.
+ *
+ * Entries are written batch by batch, as made available to the entry
+ * processor, with a single pwritev(2) straight from the ring buffer
+ * and a single fdatasync(2) per batch. The batch processor releases
+ * the batch only after journal_on_entry() has returned for its last
+ * entry, so entry processors depending on the journaling one only
+ * see entries that are on disk.
+ *
+ * Each batch is preceded by a header holding the sequence number of
+ * its first entry, the number of entries and a checksum. Opening a
+ * journal checks the batches already in it and appends after the last
+ * intact one, thereby dropping a batch torn by a crash.
+ *
+ * The file is preallocated to its full size when opened, so that
+ * appending never changes its size. Appending to a full journal fails
+ * with ENOSPC.
+ */
+
+/*
+ * "journalC" in ASCII.
+ */
+#define JOURNAL_MAGIC (0x436c616e72756f6aULL)
+
+/*
+ * Number of pieces of memory a batch may be written from. A batch of
+ * a ring buffer is at most two pieces, as it may wrap around.
+ */
+#define JOURNAL_IOVECS (4)
+
+/*
+ * Size of the buffer used to check the batches in a journal when it
+ * is opened.
+ */
+#define JOURNAL_SCAN_BUFFER_SIZE (64 * 1024)
+
+/*
+ * Precedes every batch in a journal. The checksum covers sequence,
+ * count and the entries.
+ */
+struct journal_batch_t {
+        uint64_t magic;
+        uint64_t sequence;
+        uint64_t count;
+        uint64_t checksum;
+};
+
+/*
+ * An open journal. entries is the number of entries in it and offset
+ * where the next batch is to be written. The rest is private.
+ */
+struct journal_t {
+        int fd;
+        uint64_t entry_size;
+        uint64_t entries;
+        off_t offset;
+        off_t size;
+        struct journal_batch_t batch;
+        struct iovec iov[JOURNAL_IOVECS];
+        int iovcnt;
+};
+
+/*
+ * FNV-1a over 64 bit words, with any trailing bytes as a final word.
+ */
+static __attribute__((noinline, unused)) uint64_t
+journal_checksum(uint64_t checksum,
+                 const void * const data,
+                 const size_t length)
+{
+        const uint8_t *p = (const uint8_t*)data;
+        const uint8_t * const end = p + length;
+        uint64_t word;
+
+        for (; p + sizeof(word) <= end; p += sizeof(word)) {
+                memcpy(&word, p, sizeof(word));
+                checksum = (checksum ^ word) * 0x100000001b3ULL;
+        }
+        if (p < end) {
+                word = 0;
+                memcpy(&word, p, (size_t)(end - p));
+                checksum = (checksum ^ word) * 0x100000001b3ULL;
+        }
+
+        return checksum;
+}
+
+/*
+ * Returns the checksum of a batch holding the entries in iov[1] up to
+ * iov[iovcnt - 1].
+ */
+static __attribute__((noinline, unused)) uint64_t
+journal_batch_checksum(const struct journal_batch_t * const batch,
+                       const struct iovec * const iov,
+                       const int iovcnt)
+{
+        uint64_t checksum = journal_checksum(0xcbf29ce484222325ULL, &batch->sequence, 2 * sizeof(uint64_t));
+        int n;
+
+        for (n = 1; n < iovcnt; ++n)
+                checksum = journal_checksum(checksum, iov[n].iov_base, iov[n].iov_len);
+
+        return checksum;
+}
+
+/*
+ * Checks the batches in the journal, from the start, and sets offset
+ * and entries to the end of the last intact one.
+ */
+static __attribute__((noinline, unused)) int
+journal_scan(struct journal_t * const journal)
+{
+        struct journal_batch_t batch;
+        struct iovec iov[2];
+        uint8_t *buffer;
+        uint64_t checksum;
+        uint64_t left;
+        size_t length;
+        off_t offset = 0;
+
+        journal->entries = 0;
+        buffer = (uint8_t*)malloc(JOURNAL_SCAN_BUFFER_SIZE);
+        if (!buffer)
+                return -1;
+
+        while (sizeof(batch) == pread(journal->fd, &batch, sizeof(batch), offset)) {
+                if ((JOURNAL_MAGIC != batch.magic)
+                    || !batch.count
+                    || (batch.count > (uint64_t)(journal->size - offset - (off_t)sizeof(batch)) / journal->entry_size))
+                        break;
+                iov[0].iov_base = &batch;
+                iov[0].iov_len = sizeof(batch);
+                checksum = journal_batch_checksum(&batch, iov, 1);
+                for (left = batch.count * journal->entry_size; left; left -= length) {
+                        length = (left < JOURNAL_SCAN_BUFFER_SIZE) ? (size_t)left : JOURNAL_SCAN_BUFFER_SIZE;
+                        if ((ssize_t)length != pread(journal->fd, buffer, length, offset + (off_t)sizeof(batch) + (off_t)(batch.count * journal->entry_size - left)))
+                                goto out;
+                        checksum = journal_checksum(checksum, buffer, length);
+                }
+                if (checksum != batch.checksum)
+                        break;
+                offset += (off_t)(sizeof(batch) + batch.count * journal->entry_size);
+                journal->entries += batch.count;
+        }
+out:
+        free(buffer);
+        journal->offset = offset;
+
+        return 0;
+}
+
+/*
+ * Opens the journal at path, creating it if need be, for entries of
+ * entry_size bytes and preallocates it to size bytes. Returns 0
+ * (zero) on success, -1 and errno set otherwise.
+ *
+ * Use the function defined by DEFINE_JOURNAL_OPEN_FUNCTION instead,
+ * which passes the entry size.
+ */
+static __attribute__((noinline, unused)) int
+journal_open_file(struct journal_t * const journal,
+                  const char * const path,
+                  const size_t entry_size,
+                  const off_t size)
+{
+        struct stat st;
+        int error;
+
+        memset((void*)journal, 0, sizeof(struct journal_t));
+        journal->entry_size = entry_size;
+        journal->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR);
+        if (-1 == journal->fd)
+                return -1;
+        if (fstat(journal->fd, &st))
+                goto err;
+        journal->size = (st.st_size < size) ? size : st.st_size;
+        if (st.st_size < size) {
+                error = posix_fallocate(journal->fd, 0, size);
+                if (error) {
+                        errno = error;
+                        goto err;
+                }
+        }
+        if (journal_scan(journal))
+                goto err;
+
+        return 0;
+err:
+        error = errno;
+        close(journal->fd);
+        errno = error;
+
+        return -1;
+}
+
+/*
+ * Closes the journal.
+ */
+static __attribute__((noinline, unused)) void
+journal_close(struct journal_t * const journal)
+{
+        close(journal->fd);
+        journal->fd = -1;
+}
+
+/*
+ * Writes the pending batch and, if sync is non-zero, waits for it to
+ * be durable. Returns 0 (zero) on success, an errno value otherwise.
+ * The batch is dropped either way, so a failed batch is overwritten
+ * by the next one.
+ */
+static __attribute__((noinline, unused)) int
+journal_commit(struct journal_t * const journal,
+               const int sync)
+{
+        const ssize_t length = (ssize_t)(sizeof(struct journal_batch_t) + journal->batch.count * journal->entry_size);
+        const int iovcnt = journal->iovcnt;
+        ssize_t written;
+
+        journal->iovcnt = 0;
+        if (!iovcnt)
+                return 0;
+        if (journal->size - journal->offset < length)
+                return ENOSPC;
+
+        journal->batch.magic = JOURNAL_MAGIC;
+        journal->batch.checksum = journal_batch_checksum(&journal->batch, journal->iov, iovcnt);
+        written = pwritev(journal->fd, journal->iov, iovcnt, journal->offset);
+        if (written != length)
+                return (-1 == written) ? errno : EIO;
+        if (sync && fdatasync(journal->fd))
+                return errno;
+        journal->offset += length;
+        journal->entries += journal->batch.count;
+
+        return 0;
+}
+
+/*
+ * Defines journal_open(journal, path, size) for entries of
+ * entry_type_name__. See journal_open_file().
+ */
+#define DEFINE_JOURNAL_OPEN_FUNCTION(entry_type_name__, ring_buffer_prefix__...)                       \
+static inline int                                                                                      \
+ring_buffer_prefix__ ## journal_open(struct journal_t * const journal,                                 \
+                                     const char * const path,                                          \
+                                     const off_t size)                                                 \
+{                                                                                                      \
+        return journal_open_file(journal, path, sizeof(struct entry_type_name__), size);               \
+}
+
+/*
+ * Appends an entry to the journal given as context, and commits the
+ * batch if end_of_batch is non-zero. Returns 0 (zero) on success, an
+ * errno value otherwise. Has the signature of the handler of a batch
+ * processor, see disruptor_processor.h.
+ *
+ * Consecutive entries that are adjacent in the ring buffer are
+ * written from a single piece of memory. They must not be changed
+ * before the batch is committed.
+ */
+#define DEFINE_JOURNAL_ON_ENTRY_FUNCTION(entry_type_name__, ring_buffer_prefix__...)                      \
+static __attribute__((unused)) int                                                                        \
+ring_buffer_prefix__ ## journal_on_entry(const struct entry_type_name__ *entry,                           \
+                                         uint_fast64_t sequence,                                          \
+                                         int end_of_batch,                                                \
+                                         void *context)                                                   \
+{                                                                                                         \
+        struct journal_t * const journal = (struct journal_t*)context;                                    \
+        struct iovec *iov = &journal->iov[journal->iovcnt ? journal->iovcnt - 1 : 0];                     \
+        int error;                                                                                        \
+                                                                                                          \
+        if (journal->iovcnt && ((const uint8_t*)iov->iov_base + iov->iov_len == (const uint8_t*)entry)) { \
+                iov->iov_len += sizeof(struct entry_type_name__);                                         \
+        } else {                                                                                          \
+                if (JOURNAL_IOVECS == journal->iovcnt) {                                                  \
+                        error = journal_commit(journal, 0);                                               \
+                        if (error)                                                                        \
+                                return error;                                                             \
+                }                                                                                         \
+                if (!journal->iovcnt) {                                                                   \
+                        journal->batch.sequence = sequence;                                               \
+                        journal->batch.count = 0;                                                         \
+                        journal->iov[0].iov_base = &journal->batch;                                       \
+                        journal->iov[0].iov_len = sizeof(journal->batch);                                 \
+                        journal->iovcnt = 1;                                                              \
+                }                                                                                         \
+                iov = &journal->iov[journal->iovcnt++];                                                   \
+                iov->iov_base = (void*)entry;                                                             \
+                iov->iov_len = sizeof(struct entry_type_name__);                                          \
+        }                                                                                                 \
+        ++journal->batch.count;                                                                           \
+                                                                                                          \
+        return end_of_batch ? journal_commit(journal, 1) : 0;                                             \
+}
+
+/*
+ * Publishes the entries of the journal into ring_buffer, in order,
+ * reading them straight into the claimed entries. Returns 0 (zero) on
+ * success, an errno value otherwise. Sets count to the number of
+ * entries published either way. On failure the entries claimed last
+ * are still published, and counted, with whatever was read into them.
+ *
+ * Blocks while the ring buffer is full, so entry processors must be
+ * registered beforehand. Uses the next entries, commit entries and
+ * acquire spans functions of the ring buffer, which must be defined
+ * with the same ring_buffer_prefix__ beforehand.
+ */
+#define DEFINE_JOURNAL_REPLAY_FUNCTION(entry_type_name__, ring_buffer_type_name__, ring_buffer_prefix__...)               \
+static __attribute__((noinline, unused)) int                                                                              \
+ring_buffer_prefix__ ## journal_replay(struct journal_t * const journal,                                                  \
+                                       struct ring_buffer_type_name__ * const ring_buffer,                                \
+                                       uint_fast64_t * const count)                                                       \
+{                                                                                                                         \
+        const uint_fast64_t capacity = __atomic_load_n(&ring_buffer->reduced_size.count, __ATOMIC_RELAXED);               \
+        struct journal_batch_t batch;                                                                                     \
+        struct entry_type_name__ *spans[2];                                                                               \
+        uint_fast64_t counts[2];                                                                                          \
+        struct iovec iov[2];                                                                                              \
+        struct cursor_t lo;                                                                                               \
+        struct cursor_t hi;                                                                                               \
+        uint_fast64_t left;                                                                                               \
+        uint_fast64_t chunk;                                                                                              \
+        ssize_t length;                                                                                                   \
+        off_t offset = 0;                                                                                                 \
+        unsigned int n;                                                                                                   \
+        unsigned int iovcnt;                                                                                              \
+        int error;                                                                                                        \
+                                                                                                                          \
+        *count = 0;                                                                                                       \
+        while (offset < journal->offset) {                                                                                \
+                if (sizeof(batch) != pread(journal->fd, &batch, sizeof(batch), offset))                                   \
+                        return EIO;                                                                                       \
+                offset += (off_t)sizeof(batch);                                                                           \
+                for (left = batch.count; left; left -= chunk) {                                                           \
+                        chunk = (left < capacity) ? left : capacity;                                                      \
+                        ring_buffer_prefix__ ## publisher_next_entries_blocking(ring_buffer, chunk, &lo, &hi);            \
+                        iovcnt = ring_buffer_prefix__ ## ring_buffer_acquire_spans(ring_buffer, &lo, &hi, spans, counts); \
+                        for (n = 0; n < iovcnt; ++n) {                                                                    \
+                                iov[n].iov_base = spans[n];                                                               \
+                                iov[n].iov_len = (size_t)counts[n] * sizeof(struct entry_type_name__);                    \
+                        }                                                                                                 \
+                        length = preadv(journal->fd, iov, (int)iovcnt, offset);                                           \
+                        error = (length == (ssize_t)(chunk * sizeof(struct entry_type_name__))) ? 0                       \
+                                : (-1 == length) ? errno : EIO;                                                           \
+                        ring_buffer_prefix__ ## publisher_commit_entries_blocking(ring_buffer, &lo, &hi);                 \
+                        *count += chunk;                                                                                  \
+                        if (error)                                                                                        \
+                                return error;                                                                             \
+                        offset += length;                                                                                 \
+                }                                                                                                         \
+        }                                                                                                                 \
+                                                                                                                          \
+        return 0;                                                                                                         \
+}
+
+#endif //  DISRUPTORC_JOURNAL_H
@@ -0,0 +1,586 @@
+/*
+ *    Copyright (C) 2012-2025, Jules Colding <jcolding@gmail.com>.
+ *
+ *    All Rights Reserved.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     (1) Redistributions of source code must retain the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer.
+ *
+ *     (2) Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *     (3) Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef DISRUPTORC_PROCESSOR_H
+#define DISRUPTORC_PROCESSOR_H
+
+#include "disruptor.h"
+
+#include <pthread.h>
+
+/*
+ * Batch processors.
+ *
+ * A batch processor is an entry processor run in a thread of its own,
+ * which calls a handler for every entry it is given. The handler is
+ * told whether the entry is the last one of the batch made available
+ * by the entry publishers, so that it can e.g. flush I/O once per
+ * batch instead of once per entry. Entries are released once per
+ * batch.
+ *
+ * A batch processor is halted by batch_processor_halt(), without the
+ * need for a sentinel entry. It then stops after the batch at hand.
+ * Any entries published later are left unprocessed.
+ *
+ * If the handler returns non-zero the on_error hook, if any, is
+ * called with the entry and the value returned. The batch processor
+ * goes on with the next entry if the hook returns 0 (zero) and halts
+ * otherwise, as it also does without a hook. batch_processor_join()
+ * returns the value of the handler that halted it, if any.
+ *
+ * The on_start and on_shutdown hooks, if any, are called in the
+ * thread of the batch processor before the first and after the last
+ * entry. If cpu is not BATCH_PROCESSOR_NO_CPU the thread is pinned to
+ * that CPU. This needs _GNU_SOURCE and cpu is ignored without it.
+ *
+ * A batch processor may depend on upstream entry processors, as with
+ * entry_processor_barrier_wait_for_dependencies_blocking(), by
+ * pointing upstream to the upstream_count numbers of those. The
+ * number of a batch processor is entry_processor_number once it has
+ * been started.
+ *
+ * Only ring buffers that commit in order are supported, i.e. not
+ * those defined by DEFINE_MP_RING_BUFFER_TYPE.
+ */
+
+#define BATCH_PROCESSOR_NO_CPU (-1)
+
+/*
+ * Defines the batch processor type. Fields up to and including cpu
+ * are set by batch_processor_init() and may then be changed before
+ * the batch processor is started. The rest is private.
+ */
+#define DEFINE_BATCH_PROCESSOR_TYPE(entry_type_name__, ring_buffer_type_name__, batch_processor_type_name__)                           \
+    struct batch_processor_type_name__ {                                                                                               \
+            struct ring_buffer_type_name__ *ring_buffer;                                                                               \
+            int (*on_entry)(const struct entry_type_name__ *entry, uint_fast64_t sequence, int end_of_batch, void *context);           \
+            int (*on_error)(const struct entry_type_name__ *entry, uint_fast64_t sequence, int error, void *context);                  \
+            void (*on_start)(void *context);                                                                                           \
+            void (*on_shutdown)(void *context);                                                                                        \
+            void *context;                                                                                                             \
+            const struct count_t *upstream;                                                                                            \
+            unsigned int upstream_count;                                                                                               \
+            int cpu;                                                                                                                   \
+            struct count_t entry_processor_number;                                                                                     \
+            struct cursor_t cursor;                                                                                                    \
+            pthread_t thread;                                                                                                          \
+            int error;                                                                                                                 \
+            int halted;                                                                                                                \
+    }
+
+/*
+ * Pins the calling thread to cpu__, unless it is
+ * BATCH_PROCESSOR_NO_CPU.
+ */
+#ifdef CPU_SET
+#define BATCH_PROCESSOR_PIN__(cpu__)                                                     \
+        do {                                                                             \
+                cpu_set_t cpus__;                                                        \
+                                                                                         \
+                if (BATCH_PROCESSOR_NO_CPU != (cpu__)) {                                 \
+                        CPU_ZERO(&cpus__);                                               \
+                        CPU_SET((cpu__), &cpus__);                                       \
+                        pthread_setaffinity_np(pthread_self(), sizeof(cpus__), &cpus__); \
+                }                                                                        \
+        } while (0)
+#else
+#define BATCH_PROCESSOR_PIN__(cpu__) do { } while (0)
+#endif
+
+/*
+ * Sets up a batch processor of ring_buffer calling on_entry with
+ * context for every entry, without any of the hooks, upstream entry
+ * processors or CPU.
+ */
+#define DEFINE_BATCH_PROCESSOR_INIT_FUNCTION(entry_type_name__, ring_buffer_type_name__, batch_processor_type_name__, ring_buffer_prefix__...) \
+static inline void                                                                                                                             \
+ring_buffer_prefix__ ## batch_processor_init(struct batch_processor_type_name__ * const batch_processor,                                       \
+                                             struct ring_buffer_type_name__ * const ring_buffer,                                               \
+                                             int (*on_entry)(const struct entry_type_name__*, uint_fast64_t, int, void*),                      \
+                                             void * const context)                                                                             \
+{                                                                                                                                              \
+        memset((void*)batch_processor, 0, sizeof(struct batch_processor_type_name__));                                                         \
+        batch_processor->ring_buffer = ring_buffer;                                                                                            \
+        batch_processor->on_entry = on_entry;                                                                                                  \
+        batch_processor->context = context;                                                                                                    \
+        batch_processor->cpu = BATCH_PROCESSOR_NO_CPU;                                                                                         \
+}
+
+/*
+ * Registers the batch processor, in the calling thread so that no
+ * entry published after is missed, and starts its thread. Returns 1
+ * (one) on success, 0 (zero) otherwise.
+ *
+ * Uses the register, unregister, release entry and show entry
+ * functions of the ring buffer, which must be defined with the same
+ * ring_buffer_prefix__ beforehand.
+ */
+#define DEFINE_BATCH_PROCESSOR_START_FUNCTION(entry_type_name__, ring_buffer_type_name__, batch_processor_type_name__, ring_buffer_prefix__...)                              \
+static void*                                                                                                                                                                 \
+ring_buffer_prefix__ ## batch_processor_run(void *arg)                                                                                                                       \
+{                                                                                                                                                                            \
+        struct batch_processor_type_name__ * const batch_processor = (struct batch_processor_type_name__*)arg;                                                               \
+        struct ring_buffer_type_name__ * const ring_buffer = batch_processor->ring_buffer;                                                                                   \
+        struct cursor_t cursor = batch_processor->cursor;                                                                                                                    \
+        struct cursor_t upto;                                                                                                                                                \
+        struct cursor_t n;                                                                                                                                                   \
+        const struct entry_type_name__ *entry;                                                                                                                               \
+        int error;                                                                                                                                                           \
+                                                                                                                                                                             \
+        BATCH_PROCESSOR_PIN__(batch_processor->cpu);                                                                                                                         \
+        if (batch_processor->on_start)                                                                                                                                       \
+                batch_processor->on_start(batch_processor->context);                                                                                                         \
+                                                                                                                                                                             \
+        do {                                                                                                                                                                 \
+                WAIT_UNTIL__(ring_buffer,                                                                                                                                    \
+                             (upto.sequence = UPSTREAM_SEQUENCE__(ring_buffer, batch_processor->upstream, batch_processor->upstream_count)) >= cursor.sequence               \
+                             || __atomic_load_n(&batch_processor->halted, __ATOMIC_ACQUIRE),                                                                                 \
+                             empty_waits);                                                                                                                                   \
+                if (upto.sequence < cursor.sequence)                                                                                                                         \
+                        break;                                                                                                                                               \
+                STATS_BATCH__(cursor.sequence, upto.sequence);                                                                                                               \
+                for (n.sequence = cursor.sequence; n.sequence <= upto.sequence; ++n.sequence) {                                                                              \
+                        entry = ring_buffer_prefix__ ## ring_buffer_show_entry(ring_buffer, &n);                                                                             \
+                        error = batch_processor->on_entry(entry, n.sequence, n.sequence == upto.sequence, batch_processor->context);                                         \
+                        if (UNLIKELY__(error)                                                                                                                                \
+                            && (!batch_processor->on_error || batch_processor->on_error(entry, n.sequence, error, batch_processor->context))) {                              \
+                                batch_processor->error = error;                                                                                                              \
+                                goto out;                                                                                                                                    \
+                        }                                                                                                                                                    \
+                }                                                                                                                                                            \
+                ring_buffer_prefix__ ## entry_processor_barrier_release_entry(ring_buffer, &batch_processor->entry_processor_number, &upto);                                 \
+                cursor.sequence = upto.sequence + 1;                                                                                                                         \
+        } while (!__atomic_load_n(&batch_processor->halted, __ATOMIC_ACQUIRE));                                                                                              \
+out:                                                                                                                                                                         \
+        if (batch_processor->on_shutdown)                                                                                                                                    \
+                batch_processor->on_shutdown(batch_processor->context);                                                                                                      \
+        ring_buffer_prefix__ ## entry_processor_barrier_unregister(ring_buffer, &batch_processor->entry_processor_number);                                                   \
+                                                                                                                                                                             \
+        return NULL;                                                                                                                                                         \
+}                                                                                                                                                                            \
+                                                                                                                                                                             \
+static __attribute__((noinline, unused)) int                                                                                                                                 \
+ring_buffer_prefix__ ## batch_processor_start(struct batch_processor_type_name__ * const batch_processor)                                                                    \
+{                                                                                                                                                                            \
+        batch_processor->error = 0;                                                                                                                                          \
+        batch_processor->halted = 0;                                                                                                                                         \
+        batch_processor->cursor.sequence = ring_buffer_prefix__ ## entry_processor_barrier_register(batch_processor->ring_buffer, &batch_processor->entry_processor_number); \
+        if (pthread_create(&batch_processor->thread, NULL, ring_buffer_prefix__ ## batch_processor_run, batch_processor)) {                                                  \
+                ring_buffer_prefix__ ## entry_processor_barrier_unregister(batch_processor->ring_buffer, &batch_processor->entry_processor_number);                          \
+                return 0;                                                                                                                                                    \
+        }                                                                                                                                                                    \
+                                                                                                                                                                             \
+        return 1;                                                                                                                                                            \
+}
+
+/*
+ * Makes the batch processor stop after the batch at hand. May be
+ * called from any thread, the handler included.
+ */
+#define DEFINE_BATCH_PROCESSOR_HALT_FUNCTION(batch_processor_type_name__, ring_buffer_prefix__...)       \
+static inline void                                                                                       \
+ring_buffer_prefix__ ## batch_processor_halt(struct batch_processor_type_name__ * const batch_processor) \
+{                                                                                                        \
+        __atomic_store_n(&batch_processor->halted, 1, __ATOMIC_RELEASE);                                 \
+        wait_strategy_wake(&batch_processor->ring_buffer->wait_state);                                   \
+}
+
+/*
+ * Waits for the batch processor to halt. Returns the value of the
+ * handler that halted it, 0 (zero) if it was halted by
+ * batch_processor_halt().
+ */
+#define DEFINE_BATCH_PROCESSOR_JOIN_FUNCTION(batch_processor_type_name__, ring_buffer_prefix__...)       \
+static __attribute__((noinline, unused)) int                                                             \
+ring_buffer_prefix__ ## batch_processor_join(struct batch_processor_type_name__ * const batch_processor) \
+{                                                                                                        \
+        pthread_join(batch_processor->thread, NULL);                                                     \
+                                                                                                         \
+        return batch_processor->error;                                                                   \
+}
+
+/*
+ * Worker pools.
+ *
+ * A worker pool is a set of entry processors, each run in a thread of
+ * its own, that share the entries between them: every entry is
+ * handled by exactly one of the workers. This spreads a CPU-heavy
+ * handler over several cores while keeping a single ring buffer.
+ *
+ * The workers claim entries from a shared work sequence, chunk
+ * entries at a time, to limit the contention on it. Each worker has
+ * its own slot among the entry processors of the ring buffer, so the
+ * entry publishers gate on the slowest worker as on any entry
+ * processor. Once a worker has claimed entries it releases those
+ * before them, so no claimed entry is ever overwritten and its slot
+ * never keeps the entries it waits for from being published.
+ *
+ * Entries are handled out of order across the workers, but in order
+ * by each worker. The handler is given the index of the worker, from
+ * 0 (zero) to worker_count - 1, which stays the same for the lifetime
+ * of its thread.
+ *
+ * A worker pool is halted by worker_pool_halt(). Each worker then
+ * stops after the entries it has claimed and which are published.
+ * If the handler returns non-zero the whole worker pool halts and
+ * worker_pool_join() returns the first such value.
+ *
+ * As for batch processors, upstream entry processors may be given
+ * and only ring buffers that commit in order are supported.
+ */
+
+#define WORKER_POOL_DEFAULT_CHUNK (8)
+
+/*
+ * Defines the worker pool type for up to max_workers__ workers.
+ * Fields from ring_buffer up to and including chunk are set by
+ * worker_pool_init() and may then be changed before the worker pool
+ * is started. The rest is private.
+ */
+#define DEFINE_WORKER_POOL_TYPE(entry_type_name__, ring_buffer_type_name__, worker_pool_type_name__, max_workers__)             \
+    struct worker_pool_type_name__ {                                                                                            \
+            struct cursor_t work_sequence __attribute__((aligned(CACHE_LINE_SIZE)));                                            \
+            struct ring_buffer_type_name__ *ring_buffer __attribute__((aligned(CACHE_LINE_SIZE)));                              \
+            int (*on_entry)(const struct entry_type_name__ *entry, uint_fast64_t sequence, unsigned int worker, void *context); \
+            void *context;                                                                                                      \
+            const struct count_t *upstream;                                                                                     \
+            unsigned int upstream_count;                                                                                        \
+            unsigned int worker_count;                                                                                          \
+            uint_fast64_t chunk;                                                                                                \
+            unsigned int started;                                                                                               \
+            int error;                                                                                                          \
+            int halted;                                                                                                         \
+            struct count_t entry_processor_numbers[max_workers__];                                                              \
+            pthread_t threads[max_workers__];                                                                                   \
+    }
+
+/*
+ * Sets up a worker pool of worker_count workers on ring_buffer,
+ * calling on_entry with context for every entry. The work is claimed
+ * WORKER_POOL_DEFAULT_CHUNK entries at a time.
+ */
+#define DEFINE_WORKER_POOL_INIT_FUNCTION(entry_type_name__, ring_buffer_type_name__, worker_pool_type_name__, ring_buffer_prefix__...) \
+static inline void                                                                                                                     \
+ring_buffer_prefix__ ## worker_pool_init(struct worker_pool_type_name__ * const worker_pool,                                           \
+                                         struct ring_buffer_type_name__ * const ring_buffer,                                           \
+                                         const unsigned int worker_count,                                                              \
+                                         int (*on_entry)(const struct entry_type_name__*, uint_fast64_t, unsigned int, void*),         \
+                                         void * const context)                                                                         \
+{                                                                                                                                      \
+        memset((void*)worker_pool, 0, sizeof(struct worker_pool_type_name__));                                                         \
+        worker_pool->ring_buffer = ring_buffer;                                                                                        \
+        worker_pool->on_entry = on_entry;                                                                                              \
+        worker_pool->context = context;                                                                                                \
+        worker_pool->worker_count = worker_count;                                                                                      \
+        worker_pool->chunk = WORKER_POOL_DEFAULT_CHUNK;                                                                                \
+}
+
+/*
+ * Registers the workers, in the calling thread so that no entry
+ * published after is missed, and starts their threads. Returns 1
+ * (one) on success, 0 (zero) otherwise, e.g. if worker_count is 0
+ * (zero) or more than the worker pool type allows.
+ *
+ * Uses the register, unregister, release entry and show entry
+ * functions of the ring buffer, which must be defined with the same
+ * ring_buffer_prefix__ beforehand.
+ */
+#define DEFINE_WORKER_POOL_START_FUNCTION(entry_type_name__, ring_buffer_type_name__, worker_pool_type_name__, ring_buffer_prefix__...)                              \
+static void*                                                                                                                                                         \
+ring_buffer_prefix__ ## worker_pool_run(void *arg)                                                                                                                   \
+{                                                                                                                                                                    \
+        struct worker_pool_type_name__ * const worker_pool = (struct worker_pool_type_name__*)arg;                                                                   \
+        struct ring_buffer_type_name__ * const ring_buffer = worker_pool->ring_buffer;                                                                               \
+        const unsigned int worker = __atomic_fetch_add(&worker_pool->started, 1, __ATOMIC_RELAXED);                                                                  \
+        const struct count_t * const entry_processor_number = &worker_pool->entry_processor_numbers[worker];                                                         \
+        struct cursor_t released;                                                                                                                                    \
+        struct cursor_t n;                                                                                                                                           \
+        uint_fast64_t lo;                                                                                                                                            \
+        uint_fast64_t hi;                                                                                                                                            \
+        uint_fast64_t upto = 0;                                                                                                                                      \
+        int none = 0;                                                                                                                                                \
+        int error;                                                                                                                                                   \
+                                                                                                                                                                     \
+        while (!__atomic_load_n(&worker_pool->halted, __ATOMIC_ACQUIRE)) {                                                                                           \
+                lo = __atomic_fetch_add(&worker_pool->work_sequence.sequence, worker_pool->chunk, __ATOMIC_ACQ_REL);                                                 \
+                /* up to the claim, a slot lagging behind it could stall the entry publishers */                                                                     \
+                released.sequence = lo - 1;                                                                                                                          \
+                ring_buffer_prefix__ ## entry_processor_barrier_release_entry(ring_buffer, entry_processor_number, &released);                                       \
+                hi = lo + worker_pool->chunk - 1;                                                                                                                    \
+                for (n.sequence = lo; n.sequence <= hi; ++n.sequence) {                                                                                              \
+                        if (upto < n.sequence) {                                                                                                                     \
+                                WAIT_UNTIL__(ring_buffer,                                                                                                            \
+                                             (upto = UPSTREAM_SEQUENCE__(ring_buffer, worker_pool->upstream, worker_pool->upstream_count)) >= n.sequence             \
+                                             || __atomic_load_n(&worker_pool->halted, __ATOMIC_ACQUIRE),                                                             \
+                                             empty_waits);                                                                                                           \
+                                if (upto < n.sequence)                                                                                                               \
+                                        goto out;                                                                                                                    \
+                        }                                                                                                                                            \
+                        error = worker_pool->on_entry(ring_buffer_prefix__ ## ring_buffer_show_entry(ring_buffer, &n), n.sequence, worker, worker_pool->context);    \
+                        if (UNLIKELY__(error)) {                                                                                                                     \
+                                __atomic_compare_exchange_n(&worker_pool->error, &none, error, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED);                               \
+                                __atomic_store_n(&worker_pool->halted, 1, __ATOMIC_RELEASE);                                                                         \
+                                wait_strategy_wake(&ring_buffer->wait_state);                                                                                        \
+                                goto out;                                                                                                                            \
+                        }                                                                                                                                            \
+                }                                                                                                                                                    \
+                STATS_BATCH__(lo, hi);                                                                                                                               \
+        }                                                                                                                                                            \
+out:                                                                                                                                                                 \
+        ring_buffer_prefix__ ## entry_processor_barrier_unregister(ring_buffer, entry_processor_number);                                                             \
+                                                                                                                                                                     \
+        return NULL;                                                                                                                                                 \
+}                                                                                                                                                                    \
+                                                                                                                                                                     \
+static __attribute__((noinline, unused)) int                                                                                                                         \
+ring_buffer_prefix__ ## worker_pool_start(struct worker_pool_type_name__ * const worker_pool)                                                                        \
+{                                                                                                                                                                    \
+        const unsigned int max_workers = sizeof(worker_pool->threads) / sizeof(worker_pool->threads[0]);                                                             \
+        uint_fast64_t first = 0;                                                                                                                                     \
+        uint_fast64_t seq;                                                                                                                                           \
+        unsigned int n;                                                                                                                                              \
+        unsigned int k;                                                                                                                                              \
+                                                                                                                                                                     \
+        if (!worker_pool->worker_count || (max_workers < worker_pool->worker_count) || !worker_pool->chunk)                                                          \
+                return 0;                                                                                                                                            \
+                                                                                                                                                                     \
+        worker_pool->error = 0;                                                                                                                                      \
+        worker_pool->halted = 0;                                                                                                                                     \
+        worker_pool->started = 0;                                                                                                                                    \
+        for (n = 0; n < worker_pool->worker_count; ++n) {                                                                                                            \
+                ring_buffer_prefix__ ## entry_processor_barrier_register(worker_pool->ring_buffer, &worker_pool->entry_processor_numbers[n]);                        \
+                seq = __atomic_load_n(&worker_pool->ring_buffer->entry_processor_cursors[worker_pool->entry_processor_numbers[n].count].sequence, __ATOMIC_RELAXED); \
+                if (first <= seq)                                                                                                                                    \
+                        first = seq + 1;                                                                                                                             \
+        }                                                                                                                                                            \
+        /* never claim below a slot, releases must not move backwards */                                                                                             \
+        worker_pool->work_sequence.sequence = first;                                                                                                                 \
+                                                                                                                                                                     \
+        for (n = 0; n < worker_pool->worker_count; ++n) {                                                                                                            \
+                if (pthread_create(&worker_pool->threads[n], NULL, ring_buffer_prefix__ ## worker_pool_run, worker_pool)) {                                          \
+                        __atomic_store_n(&worker_pool->halted, 1, __ATOMIC_RELEASE);                                                                                 \
+                        wait_strategy_wake(&worker_pool->ring_buffer->wait_state);                                                                                   \
+                        for (k = 0; k < n; ++k)                                                                                                                      \
+                                pthread_join(worker_pool->threads[k], NULL);                                                                                         \
+                        for (k = n; k < worker_pool->worker_count; ++k)                                                                                              \
+                                ring_buffer_prefix__ ## entry_processor_barrier_unregister(worker_pool->ring_buffer, &worker_pool->entry_processor_numbers[k]);      \
+                        return 0;                                                                                                                                    \
+                }                                                                                                                                                    \
+        }                                                                                                                                                            \
+                                                                                                                                                                     \
+        return 1;                                                                                                                                                    \
+}
+
+/*
+ * Makes the workers stop after the entries at hand. May be called
+ * from any thread, the handler included.
+ */
+#define DEFINE_WORKER_POOL_HALT_FUNCTION(worker_pool_type_name__, ring_buffer_prefix__...)   \
+static inline void                                                                           \
+ring_buffer_prefix__ ## worker_pool_halt(struct worker_pool_type_name__ * const worker_pool) \
+{                                                                                            \
+        __atomic_store_n(&worker_pool->halted, 1, __ATOMIC_RELEASE);                         \
+        wait_strategy_wake(&worker_pool->ring_buffer->wait_state);                           \
+}
+
+/*
+ * Waits for all of the workers to halt. Returns the value of the
+ * handler that halted the worker pool, 0 (zero) if it was halted by
+ * worker_pool_halt().
+ */
+#define DEFINE_WORKER_POOL_JOIN_FUNCTION(worker_pool_type_name__, ring_buffer_prefix__...)   \
+static __attribute__((noinline, unused)) int                                                 \
+ring_buffer_prefix__ ## worker_pool_join(struct worker_pool_type_name__ * const worker_pool) \
+{                                                                                            \
+        unsigned int n;                                                                      \
+                                                                                             \
+        for (n = 0; n < worker_pool->worker_count; ++n)                                      \
+                pthread_join(worker_pool->threads[n], NULL);                                 \
+                                                                                             \
+        return worker_pool->error;                                                           \
+}
+
+/*
+ * Pollers.
+ *
+ * A poller is an entry processor driven by the caller, e.g. from an
+ * epoll event loop, instead of by a thread of its own. Each call to
+ * poller_poll() hands the entries available at that moment to the
+ * handler and returns without waiting. It returns one of:
+ *
+ *   POLLER_PROCESSING: entries were handled.
+ *   POLLER_GATING:     entries are claimed, but not yet committed or
+ *                      released by the upstream entry processors.
+ *   POLLER_IDLE:       no entries are claimed.
+ *
+ * If max_batch is non-zero at most that many entries are handled per
+ * call, so that the event loop stays responsive. If the handler
+ * returns non-zero the call ends after that entry and the rest is
+ * left for the next call.
+ *
+ * A poller may sleep on an eventfd set by ring_buffer_set_eventfd().
+ * poller_arm() announces that the poller is about to sleep and
+ * returns 1 (one) if it may, or 0 (zero) if entries became available
+ * meanwhile and it should poll again. Commits and releases signal the
+ * eventfd only while a poller is armed, so the entry publishers pay
+ * no system call while the pollers keep up. The armed pollers are
+ * counted and the eventfd is signalled by their number, so several
+ * pollers may share a ring buffer and an eventfd created with
+ * EFD_SEMAPHORE.
+ *
+ * As for batch processors, upstream entry processors may be given
+ * and only ring buffers that commit in order are supported.
+ */
+
+#define POLLER_IDLE (0)
+#define POLLER_GATING (1)
+#define POLLER_PROCESSING (2)
+
+/*
+ * Defines the poller type. Fields up to and including max_batch are
+ * set by poller_init() and may then be changed before the poller is
+ * registered. The rest is private.
+ */
+#define DEFINE_POLLER_TYPE(entry_type_name__, ring_buffer_type_name__, poller_type_name__)                                   \
+    struct poller_type_name__ {                                                                                              \
+            struct ring_buffer_type_name__ *ring_buffer;                                                                     \
+            int (*on_entry)(const struct entry_type_name__ *entry, uint_fast64_t sequence, int end_of_batch, void *context); \
+            void *context;                                                                                                   \
+            const struct count_t *upstream;                                                                                  \
+            unsigned int upstream_count;                                                                                     \
+            uint_fast64_t max_batch;                                                                                         \
+            struct count_t entry_processor_number;                                                                           \
+            struct cursor_t cursor;                                                                                          \
+    }
+
+/*
+ * Sets up a poller of ring_buffer calling on_entry with context for
+ * every entry, without upstream entry processors or a limit on the
+ * entries per call.
+ */
+#define DEFINE_POLLER_INIT_FUNCTION(entry_type_name__, ring_buffer_type_name__, poller_type_name__, ring_buffer_prefix__...) \
+static inline void                                                                                                           \
+ring_buffer_prefix__ ## poller_init(struct poller_type_name__ * const poller,                                                \
+                                    struct ring_buffer_type_name__ * const ring_buffer,                                      \
+                                    int (*on_entry)(const struct entry_type_name__*, uint_fast64_t, int, void*),             \
+                                    void * const context)                                                                    \
+{                                                                                                                            \
+        memset((void*)poller, 0, sizeof(struct poller_type_name__));                                                         \
+        poller->ring_buffer = ring_buffer;                                                                                   \
+        poller->on_entry = on_entry;                                                                                         \
+        poller->context = context;                                                                                           \
+}
+
+/*
+ * Registers the poller as an entry processor of its ring buffer. It
+ * sees every entry published from then on.
+ */
+#define DEFINE_POLLER_REGISTER_FUNCTION(poller_type_name__, ring_buffer_prefix__...)                                                              \
+static __attribute__((noinline, unused)) void                                                                                                     \
+ring_buffer_prefix__ ## poller_register(struct poller_type_name__ * const poller)                                                                 \
+{                                                                                                                                                 \
+        poller->cursor.sequence = ring_buffer_prefix__ ## entry_processor_barrier_register(poller->ring_buffer, &poller->entry_processor_number); \
+}
+
+/*
+ * Unregisters the poller, so that the entry publishers no longer gate
+ * on it.
+ */
+#define DEFINE_POLLER_UNREGISTER_FUNCTION(poller_type_name__, ring_buffer_prefix__...)                                    \
+static __attribute__((noinline, unused)) void                                                                             \
+ring_buffer_prefix__ ## poller_unregister(struct poller_type_name__ * const poller)                                       \
+{                                                                                                                         \
+        ring_buffer_prefix__ ## entry_processor_barrier_unregister(poller->ring_buffer, &poller->entry_processor_number); \
+}
+
+/*
+ * Hands the available entries to the handler and releases them.
+ * Returns POLLER_PROCESSING, POLLER_GATING or POLLER_IDLE and sets
+ * count to the number of entries handled.
+ */
+#define DEFINE_POLLER_POLL_FUNCTION(entry_type_name__, poller_type_name__, ring_buffer_prefix__...)                                     \
+static __attribute__((noinline, unused)) unsigned int                                                                                   \
+ring_buffer_prefix__ ## poller_poll(struct poller_type_name__ * const poller,                                                           \
+                                    uint_fast64_t * const count)                                                                        \
+{                                                                                                                                       \
+        const struct entry_type_name__ *entry;                                                                                          \
+        struct cursor_t upto;                                                                                                           \
+        struct cursor_t n;                                                                                                              \
+                                                                                                                                        \
+        upto.sequence = UPSTREAM_SEQUENCE__(poller->ring_buffer, poller->upstream, poller->upstream_count);                             \
+        if (upto.sequence < poller->cursor.sequence) {                                                                                  \
+                *count = 0;                                                                                                             \
+                if (poller->cursor.sequence <= __atomic_load_n(&poller->ring_buffer->write_cursor.sequence, __ATOMIC_RELAXED))          \
+                        return POLLER_GATING;                                                                                           \
+                return POLLER_IDLE;                                                                                                     \
+        }                                                                                                                               \
+        if (poller->max_batch && (poller->max_batch <= upto.sequence - poller->cursor.sequence))                                        \
+                upto.sequence = poller->cursor.sequence + poller->max_batch - 1;                                                        \
+                                                                                                                                        \
+        for (n.sequence = poller->cursor.sequence; ; ++n.sequence) {                                                                    \
+                entry = ring_buffer_prefix__ ## ring_buffer_show_entry(poller->ring_buffer, &n);                                        \
+                if (poller->on_entry(entry, n.sequence, n.sequence == upto.sequence, poller->context) || (n.sequence == upto.sequence)) \
+                        break;                                                                                                          \
+        }                                                                                                                               \
+        upto.sequence = n.sequence;                                                                                                     \
+        STATS_BATCH__(poller->cursor.sequence, upto.sequence);                                                                          \
+        ring_buffer_prefix__ ## entry_processor_barrier_release_entry(poller->ring_buffer, &poller->entry_processor_number, &upto);     \
+        *count = upto.sequence - poller->cursor.sequence + 1;                                                                           \
+        poller->cursor.sequence = upto.sequence + 1;                                                                                    \
+                                                                                                                                        \
+        return POLLER_PROCESSING;                                                                                                       \
+}
+
+/*
+ * Announces that the poller is about to sleep on the eventfd of its
+ * ring buffer. Returns 1 (one) if it may sleep, 0 (zero) if it should
+ * poll again. The eventfd is signalled at most once per arming,
+ * even if the poller does not sleep after all.
+ */
+#define DEFINE_POLLER_ARM_FUNCTION(poller_type_name__, ring_buffer_prefix__...)                                              \
+static __attribute__((noinline, unused)) int                                                                                 \
+ring_buffer_prefix__ ## poller_arm(struct poller_type_name__ * const poller)                                                 \
+{                                                                                                                            \
+        __atomic_fetch_add(&poller->ring_buffer->wait_state.armed, 1, __ATOMIC_SEQ_CST);                                     \
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);                                                                             \
+                                                                                                                             \
+        return UPSTREAM_SEQUENCE__(poller->ring_buffer, poller->upstream, poller->upstream_count) < poller->cursor.sequence; \
+}
+
+#endif //  DISRUPTORC_PROCESSOR_H
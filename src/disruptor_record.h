@@ -0,0 +1,238 @@
+/*
+ *    Copyright (C) 2012-2025, Jules Colding <jcolding@gmail.com>.
+ *
+ *    All Rights Reserved.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     (1) Redistributions of source code must retain the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer.
+ *
+ *     (2) Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *     (3) Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef DISRUPTORC_RECORD_H
+#define DISRUPTORC_RECORD_H
+
+#include "disruptor.h"
+
+/*
+ * Ring buffers of variable length records.
+ *
+ * A record ring buffer is an ordinary ring buffer, as defined by
+ * DEFINE_RING_BUFFER_TYPE or DEFINE_RUNTIME_RING_BUFFER_TYPE, of
+ * RECORD_ALIGNMENT byte record slots. A record is a struct
+ * record_header_t followed by length bytes of payload, padded to
+ * whole slots. Entry publishers claim the slots of a record with a
+ * single atomic operation on the write cursor and commit them by
+ * publisher_commit_entries_blocking(). A record never wraps around
+ * the end of the ring buffer. Where it would, the entry publisher
+ * claims the slots up to the end as well and fills them with a
+ * padding record, which entry processors skip.
+ *
+ * Entry processors use the ordinary register, wait_for, release and
+ * unregister functions and read the records up to where they may read
+ * in place by ring_buffer_next_record().
+ *
+ * A record may take up at most half of the slots of the ring buffer,
+ * so that it fits however much padding it needs. That is a length of
+ * at most RECORD_MAX_LENGTH(slots) bytes.
+ *
+ * Only ring buffers that commit in order are supported, i.e. not
+ * those defined by DEFINE_MP_RING_BUFFER_TYPE or
+ * DEFINE_SP_RING_BUFFER_TYPE.
+ */
+
+/*
+ * The size of a record slot. Records and their payloads begin on a
+ * slot.
+ */
+#define RECORD_ALIGNMENT (8)
+
+/*
+ * The type of padding records. Other types are up to the entry
+ * publishers.
+ */
+#define RECORD_TYPE_PADDING (UINT32_MAX)
+
+struct record_header_t {
+        uint32_t length;
+        uint32_t type;
+};
+
+struct record_slot_t {
+        struct record_header_t header;
+} __attribute__((aligned(RECORD_ALIGNMENT)));
+
+/*
+ * The number of slots of a record with length bytes of payload.
+ */
+#define RECORD_SLOTS(length__) (1 + ((uint_fast64_t)(length__) + RECORD_ALIGNMENT - 1) / RECORD_ALIGNMENT)
+
+/*
+ * The longest payload of a record in a ring buffer of slots__ slots.
+ */
+#define RECORD_MAX_LENGTH(slots__) (((slots__) / 2 - 1) * RECORD_ALIGNMENT)
+
+/*
+ * The payload of a record.
+ */
+#define RECORD_PAYLOAD(record__) ((const void*)((const struct record_slot_t*)(record__) + 1))
+
+/*
+ * Defines a ring buffer of slots__ record slots. slots__ MUST be a
+ * power of two. The ring buffer is initialized by the function
+ * defined by DEFINE_RING_BUFFER_INIT(slots__, ...).
+ */
+#define DEFINE_RECORD_RING_BUFFER_TYPE(entry_processor_capacity__, slots__, ring_buffer_type_name__) \
+        DEFINE_RING_BUFFER_TYPE(entry_processor_capacity__, slots__, record_slot_t, ring_buffer_type_name__)
+
+/*
+ * Like DEFINE_RECORD_RING_BUFFER_TYPE, but the number of slots is
+ * chosen at run time. See DEFINE_RUNTIME_RING_BUFFER_TYPE.
+ */
+#define DEFINE_RUNTIME_RECORD_RING_BUFFER_TYPE(ring_buffer_type_name__) \
+        DEFINE_RUNTIME_RING_BUFFER_TYPE(record_slot_t, ring_buffer_type_name__)
+
+/*
+ * The number of padding slots needed before a record of slots__ slots
+ * claimed after the write cursor at write_sequence__, to keep it from
+ * wrapping around the end of the ring buffer.
+ */
+#define RECORD_PADDING__(ring_buffer__, write_sequence__, slots__)                                    \
+({                                                                                                    \
+        const uint_fast64_t index__ = ((write_sequence__) + 1) & (ring_buffer__)->reduced_size.count; \
+                                                                                                      \
+        (index__ + (slots__) > (ring_buffer__)->reduced_size.count + 1)                               \
+                ? (ring_buffer__)->reduced_size.count + 1 - index__ : 0;                              \
+})
+
+/*
+ * Writes the padding record, if any, and the header of a record
+ * claimed from lo__. Evaluates to the payload of the record.
+ */
+#define RECORD_WRITE_HEADERS__(ring_buffer__, lo__, padding__, length__, type__)                                  \
+({                                                                                                                \
+        struct record_header_t *header__;                                                                         \
+                                                                                                                  \
+        if (UNLIKELY__(padding__)) {                                                                              \
+                header__ = &(ring_buffer__)->buffer[(lo__) & (ring_buffer__)->reduced_size.count].header;         \
+                header__->length = (uint32_t)(((padding__) - 1) * RECORD_ALIGNMENT);                              \
+                header__->type = RECORD_TYPE_PADDING;                                                             \
+        }                                                                                                         \
+        header__ = &(ring_buffer__)->buffer[((lo__) + (padding__)) & (ring_buffer__)->reduced_size.count].header; \
+        header__->length = (length__);                                                                            \
+        header__->type = (type__);                                                                                \
+        (void*)((struct record_slot_t*)header__ + 1);                                                             \
+})
+
+/*
+ * Entry Publishers call this function to claim a record with length
+ * bytes of payload, and padding before it if need be, as the slots
+ * lo->sequence up to and including hi->sequence. Returns the payload
+ * of the record, to be written in place before the slots are
+ * committed by publisher_commit_entries_blocking(lo, hi).
+ *
+ * length must be at most RECORD_MAX_LENGTH of the ring buffer and
+ * type must not be RECORD_TYPE_PADDING.
+ */
+#define DEFINE_ENTRY_PUBLISHER_NEXTRECORD_BLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)                                            \
+static inline __attribute__((always_inline)) void*                                                                                                       \
+ring_buffer_prefix__ ## publisher_next_record_blocking(struct ring_buffer_type_name__ * const ring_buffer,                                               \
+                                                       const uint32_t length,                                                                            \
+                                                       const uint32_t type,                                                                              \
+                                                       struct cursor_t * __restrict__ const lo,                                                          \
+                                                       struct cursor_t * __restrict__ const hi)                                                          \
+{                                                                                                                                                        \
+        const uint_fast64_t slots = RECORD_SLOTS(length);                                                                                                \
+        uint_fast64_t seq = __atomic_load_n(&ring_buffer->write_cursor.sequence, __ATOMIC_RELAXED);                                                      \
+        uint_fast64_t padding;                                                                                                                           \
+                                                                                                                                                         \
+        do {                                                                                                                                             \
+                padding = RECORD_PADDING__(ring_buffer, seq, slots);                                                                                     \
+        } while (!__atomic_compare_exchange_n(&ring_buffer->write_cursor.sequence, &seq, seq + padding + slots, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED)); \
+        lo->sequence = seq + 1;                                                                                                                          \
+        hi->sequence = seq + padding + slots;                                                                                                            \
+        WAIT_UNTIL__(ring_buffer, HAS_CAPACITY__(ring_buffer, hi->sequence), full_waits);                                                                \
+                                                                                                                                                         \
+        return RECORD_WRITE_HEADERS__(ring_buffer, lo->sequence, padding, length, type);                                                                 \
+}
+
+/*
+ * Like the blocking version. Returns the payload of the record if it
+ * was claimed, NULL otherwise.
+ */
+#define DEFINE_ENTRY_PUBLISHER_NEXTRECORD_NONBLOCKING_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)                          \
+static inline void*                                                                                                                       \
+ring_buffer_prefix__ ## publisher_next_record_nonblocking(struct ring_buffer_type_name__ * const ring_buffer,                             \
+                                                          const uint32_t length,                                                          \
+                                                          const uint32_t type,                                                            \
+                                                          struct cursor_t * __restrict__ const lo,                                        \
+                                                          struct cursor_t * __restrict__ const hi)                                        \
+{                                                                                                                                         \
+        const uint_fast64_t slots = RECORD_SLOTS(length);                                                                                 \
+        uint_fast64_t seq = __atomic_load_n(&ring_buffer->write_cursor.sequence, __ATOMIC_RELAXED);                                       \
+        const uint_fast64_t padding = RECORD_PADDING__(ring_buffer, seq, slots);                                                          \
+                                                                                                                                          \
+        lo->sequence = seq + 1;                                                                                                           \
+        hi->sequence = seq + padding + slots;                                                                                             \
+        if (!HAS_CAPACITY__(ring_buffer, hi->sequence))                                                                                   \
+                return NULL;                                                                                                              \
+        if (!__atomic_compare_exchange_n(&ring_buffer->write_cursor.sequence, &seq, hi->sequence, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) \
+                return NULL;                                                                                                              \
+                                                                                                                                          \
+        return RECORD_WRITE_HEADERS__(ring_buffer, lo->sequence, padding, length, type);                                                  \
+}
+
+/*
+ * Entry Processors call this function to read the records from
+ * next->sequence up to and including upto->sequence, as given by one
+ * of the wait_for functions. Returns the next record, skipping
+ * padding records, and moves next past it. Returns NULL once there
+ * are no more records up to upto->sequence, when next->sequence is
+ * upto->sequence + 1.
+ */
+#define DEFINE_RING_BUFFER_NEXT_RECORD_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)                  \
+static inline const struct record_header_t*                                                                        \
+ring_buffer_prefix__ ## ring_buffer_next_record(const struct ring_buffer_type_name__ * const ring_buffer,          \
+                                                struct cursor_t * __restrict__ const next,                         \
+                                                const struct cursor_t * __restrict__ const upto)                   \
+{                                                                                                                  \
+        const struct record_header_t *record;                                                                      \
+                                                                                                                   \
+        while (next->sequence <= upto->sequence) {                                                                 \
+                record = &ring_buffer->buffer[next->sequence & ring_buffer->reduced_size.count].header;            \
+                next->sequence += RECORD_SLOTS(record->length);                                                    \
+                if (LIKELY__(RECORD_TYPE_PADDING != record->type))                                                 \
+                        return record;                                                                             \
+        }                                                                                                          \
+        return NULL;                                                                                               \
+}
+
+#endif //  DISRUPTORC_RECORD_H
@@ -0,0 +1,462 @@
+/*
+ *    Copyright (C) 2012-2025, Jules Colding <jcolding@gmail.com>.
+ *
+ *    All Rights Reserved.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     (1) Redistributions of source code must retain the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer.
+ *
+ *     (2) Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *     (3) Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef DISRUPTORC_SHARD_H
+#define DISRUPTORC_SHARD_H
+
+#include "disruptor_processor.h"
+
+#include <poll.h>
+
+/*
+ * Ring sets.
+ *
+ * A ring set is a fixed number of independent ring buffers, the
+ * shards, between which the entry publishers are spread by a key of
+ * their choice. Every shard has a write cursor and a max read cursor
+ * of its own, so entry publishers of different shards never contend
+ * on them and the ring set scales with the number of shards.
+ *
+ * ring_set_route() returns the shard of a key, whose functions are
+ * then used as for any ring buffer. Entries published with the same
+ * key all go to the same shard, so entries of a key are processed in
+ * the order they were published. Entries of different keys are not
+ * ordered with respect to each other.
+ *
+ * The shards may be processed by one batch processor each, as set
+ * up by ring_set_init_processors(), and/or by a merge processor
+ * consuming several shards in a single thread.
+ *
+ * Only ring buffers that commit in order are supported, i.e. not
+ * those defined by DEFINE_MP_RING_BUFFER_TYPE.
+ */
+
+/*
+ * Maps key to one of shard_count__ shards. The key is mixed first, so
+ * that keys differing in their low bits only are still spread evenly.
+ */
+#define RING_SET_SHARD__(key__, shard_count__)                                                \
+({                                                                                            \
+        uint64_t x__ = (uint64_t)(key__);                                                     \
+                                                                                              \
+        x__ ^= x__ >> 30;                                                                     \
+        x__ *= UINT64_C(0xbf58476d1ce4e5b9);                                                  \
+        x__ ^= x__ >> 27;                                                                     \
+        x__ *= UINT64_C(0x94d049bb133111eb);                                                  \
+        x__ ^= x__ >> 31;                                                                     \
+        (unsigned int)(((x__ >> 32) * (uint64_t)(shard_count__)) >> 32);                      \
+})
+
+/*
+ * Defines the ring set type of shard_count__ ring buffers of
+ * ring_buffer_type_name__.
+ */
+#define DEFINE_RING_SET_TYPE(ring_buffer_type_name__, ring_set_type_name__, shard_count__) \
+    struct ring_set_type_name__ {                                                          \
+            struct ring_buffer_type_name__ shards[shard_count__];                          \
+    }
+
+/*
+ * Number of shards of a ring set.
+ */
+#define RING_SET_SHARDS(ring_set__) (sizeof((ring_set__)->shards) / sizeof((ring_set__)->shards[0]))
+
+/*
+ * Initializes every shard of the ring set.
+ *
+ * Uses the init function of the ring buffer, which must be defined
+ * with the same ring_buffer_prefix__ beforehand.
+ */
+#define DEFINE_RING_SET_INIT_FUNCTION(ring_buffer_type_name__, ring_set_type_name__, ring_buffer_prefix__...) \
+static __attribute__((noinline, unused)) void                                                                 \
+ring_buffer_prefix__ ## ring_set_init(struct ring_set_type_name__ * const ring_set)                           \
+{                                                                                                             \
+        unsigned int n;                                                                                       \
+                                                                                                              \
+        for (n = 0; n < RING_SET_SHARDS(ring_set); ++n)                                                       \
+                ring_buffer_prefix__ ## ring_buffer_init(&ring_set->shards[n]);                               \
+}
+
+/*
+ * Returns the index of the shard of key.
+ */
+#define DEFINE_RING_SET_SHARD_FUNCTION(ring_buffer_type_name__, ring_set_type_name__, ring_buffer_prefix__...) \
+static inline __attribute__((always_inline)) unsigned int                                                      \
+ring_buffer_prefix__ ## ring_set_shard(const struct ring_set_type_name__ * const ring_set,                     \
+                                       const uint_fast64_t key)                                                \
+{                                                                                                              \
+        return RING_SET_SHARD__(key, RING_SET_SHARDS(ring_set));                                               \
+}
+
+/*
+ * Returns the shard of key, i.e. the ring buffer to publish entries
+ * of key to.
+ */
+#define DEFINE_RING_SET_ROUTE_FUNCTION(ring_buffer_type_name__, ring_set_type_name__, ring_buffer_prefix__...) \
+static inline __attribute__((always_inline)) struct ring_buffer_type_name__*                                   \
+ring_buffer_prefix__ ## ring_set_route(struct ring_set_type_name__ * const ring_set,                           \
+                                       const uint_fast64_t key)                                                \
+{                                                                                                              \
+        return &ring_set->shards[RING_SET_SHARD__(key, RING_SET_SHARDS(ring_set))];                            \
+}
+
+/*
+ * Sets up one batch processor per shard, processors[n] processing
+ * shard n by calling on_entry with context. The batch processors may
+ * then be changed, e.g. given a context or a CPU each, before they are
+ * started.
+ *
+ * Uses the batch processor init function, which must be defined with
+ * the same ring_buffer_prefix__ beforehand.
+ */
+#define DEFINE_RING_SET_INIT_PROCESSORS_FUNCTION(entry_type_name__, ring_set_type_name__, batch_processor_type_name__, ring_buffer_prefix__...) \
+static __attribute__((noinline, unused)) void                                                                                                   \
+ring_buffer_prefix__ ## ring_set_init_processors(struct ring_set_type_name__ * const ring_set,                                                  \
+                                                 struct batch_processor_type_name__ * const processors,                                         \
+                                                 int (*on_entry)(const struct entry_type_name__*, uint_fast64_t, int, void*),                   \
+                                                 void * const context)                                                                          \
+{                                                                                                                                               \
+        unsigned int n;                                                                                                                         \
+                                                                                                                                                \
+        for (n = 0; n < RING_SET_SHARDS(ring_set); ++n)                                                                                         \
+                ring_buffer_prefix__ ## batch_processor_init(&processors[n], &ring_set->shards[n], on_entry, context);                          \
+}
+
+/*
+ * Starts the batch processors set up by ring_set_init_processors().
+ * Returns 1 (one) on success, 0 (zero) otherwise, in which case no
+ * batch processor is left running.
+ *
+ * Uses the batch processor functions, which must be defined with the
+ * same ring_buffer_prefix__ beforehand.
+ */
+#define DEFINE_RING_SET_START_PROCESSORS_FUNCTION(ring_set_type_name__, batch_processor_type_name__, ring_buffer_prefix__...) \
+static __attribute__((noinline, unused)) int                                                                                  \
+ring_buffer_prefix__ ## ring_set_start_processors(struct ring_set_type_name__ * const ring_set,                               \
+                                                  struct batch_processor_type_name__ * const processors)                      \
+{                                                                                                                             \
+        unsigned int n;                                                                                                       \
+                                                                                                                              \
+        for (n = 0; n < RING_SET_SHARDS(ring_set); ++n) {                                                                     \
+                if (!ring_buffer_prefix__ ## batch_processor_start(&processors[n]))                                           \
+                        break;                                                                                                \
+        }                                                                                                                     \
+        if (n == RING_SET_SHARDS(ring_set))                                                                                   \
+                return 1;                                                                                                     \
+        while (n--) {                                                                                                         \
+                ring_buffer_prefix__ ## batch_processor_halt(&processors[n]);                                                 \
+                ring_buffer_prefix__ ## batch_processor_join(&processors[n]);                                                 \
+        }                                                                                                                     \
+                                                                                                                              \
+        return 0;                                                                                                             \
+}
+
+/*
+ * Waits until the batch processors started by
+ * ring_set_start_processors() have processed every entry claimed so
+ * far, then halts them and waits for them to stop. Must only be
+ * called once all entries have been committed. Returns the value of
+ * the first handler that halted a batch processor, if any.
+ */
+#define DEFINE_RING_SET_STOP_PROCESSORS_FUNCTION(ring_set_type_name__, batch_processor_type_name__, ring_buffer_prefix__...)                                      \
+static __attribute__((noinline, unused)) int                                                                                                                      \
+ring_buffer_prefix__ ## ring_set_stop_processors(struct ring_set_type_name__ * const ring_set,                                                                    \
+                                                 struct batch_processor_type_name__ * const processors)                                                           \
+{                                                                                                                                                                 \
+        unsigned int n;                                                                                                                                           \
+        int error;                                                                                                                                                \
+        int retv = 0;                                                                                                                                             \
+                                                                                                                                                                  \
+        for (n = 0; n < RING_SET_SHARDS(ring_set); ++n) {                                                                                                         \
+                WAIT_UNTIL__(&ring_set->shards[n],                                                                                                                \
+                             __atomic_load_n(&ring_set->shards[n].entry_processor_cursors[processors[n].entry_processor_number.count].sequence, __ATOMIC_ACQUIRE) \
+                             >= __atomic_load_n(&ring_set->shards[n].write_cursor.sequence, __ATOMIC_RELAXED)                                                     \
+                             || __atomic_load_n(&processors[n].error, __ATOMIC_RELAXED),                                                                          \
+                             empty_waits);                                                                                                                        \
+                ring_buffer_prefix__ ## batch_processor_halt(&processors[n]);                                                                                     \
+        }                                                                                                                                                         \
+        for (n = 0; n < RING_SET_SHARDS(ring_set); ++n) {                                                                                                         \
+                error = ring_buffer_prefix__ ## batch_processor_join(&processors[n]);                                                                             \
+                if (!retv)                                                                                                                                        \
+                        retv = error;                                                                                                                             \
+        }                                                                                                                                                         \
+                                                                                                                                                                  \
+        return retv;                                                                                                                                              \
+}
+
+/*
+ * Merge processors.
+ *
+ * A merge processor is an entry processor run in a thread of its own,
+ * which consumes several ring buffers, e.g. the shards of a ring set,
+ * by taking turns between them. It calls a handler for every entry,
+ * which is told the index of the ring buffer the entry is from. The
+ * entries of each ring buffer are handled in order and at most
+ * max_batch of them at a time, so that a busy ring buffer cannot
+ * starve the others.
+ *
+ * When all ring buffers are empty the merge processor waits on one
+ * of them in turn, as per its wait strategy. Commits to the others
+ * do not wake it up, so it waits for at most wait_nanoseconds before
+ * looking at all of them again.
+ *
+ * Unless event_fd is negative, the merge processor sleeps on it
+ * instead. event_fd must be an eventfd set by ring_buffer_set_eventfd()
+ * on every ring buffer, so that a commit to any of them wakes it up.
+ * It then arms each ring buffer as a poller would and waits for at
+ * most wait_nanoseconds as well. The eventfd must not be shared with
+ * pollers, as the merge processor reads all wake ups off it.
+ *
+ * A merge processor is halted by merge_processor_halt(). It then
+ * handles all entries committed before the call and stops. If the
+ * handler returns non-zero the merge processor stops at once and
+ * merge_processor_join() returns the value.
+ */
+
+#define MERGE_PROCESSOR_DEFAULT_BATCH (64)
+#define MERGE_PROCESSOR_DEFAULT_WAIT_NANOSECONDS (1000 * 1000)
+
+/*
+ * Defines the merge processor type for up to max_ring_buffers__ ring
+ * buffers. Fields from on_entry up to and including event_fd are set
+ * by merge_processor_init() and may then be changed before the merge
+ * processor is started. The rest is private.
+ */
+#define DEFINE_MERGE_PROCESSOR_TYPE(entry_type_name__, ring_buffer_type_name__, merge_processor_type_name__, max_ring_buffers__)     \
+    struct merge_processor_type_name__ {                                                                                             \
+            int (*on_entry)(const struct entry_type_name__ *entry, unsigned int ring_buffer, uint_fast64_t sequence, void *context); \
+            void *context;                                                                                                           \
+            uint_fast64_t max_batch;                                                                                                 \
+            uint_fast64_t wait_nanoseconds;                                                                                          \
+            int event_fd;                                                                                                            \
+            unsigned int ring_buffer_count;                                                                                          \
+            struct ring_buffer_type_name__ *ring_buffers[max_ring_buffers__];                                                        \
+            struct count_t entry_processor_numbers[max_ring_buffers__];                                                              \
+            struct cursor_t cursors[max_ring_buffers__];                                                                             \
+            pthread_t thread;                                                                                                        \
+            int error;                                                                                                               \
+            int halted;                                                                                                              \
+    }
+
+/*
+ * Sets up a merge processor of the count ring buffers starting at
+ * ring_buffers, e.g. the shards of a ring set, calling on_entry with
+ * context for every entry and waiting without an eventfd. Returns 1
+ * (one) on success, 0 (zero) if count is 0 (zero) or more than the
+ * merge processor type allows.
+ */
+#define DEFINE_MERGE_PROCESSOR_INIT_FUNCTION(entry_type_name__, ring_buffer_type_name__, merge_processor_type_name__, ring_buffer_prefix__...) \
+static __attribute__((noinline, unused)) int                                                                                                   \
+ring_buffer_prefix__ ## merge_processor_init(struct merge_processor_type_name__ * const merge_processor,                                       \
+                                             struct ring_buffer_type_name__ * const ring_buffers,                                              \
+                                             const unsigned int count,                                                                         \
+                                             int (*on_entry)(const struct entry_type_name__*, unsigned int, uint_fast64_t, void*),             \
+                                             void * const context)                                                                             \
+{                                                                                                                                              \
+        const unsigned int max_ring_buffers = sizeof(merge_processor->ring_buffers) / sizeof(merge_processor->ring_buffers[0]);                \
+        unsigned int n;                                                                                                                        \
+                                                                                                                                               \
+        if (!count || (max_ring_buffers < count))                                                                                              \
+                return 0;                                                                                                                      \
+                                                                                                                                               \
+        memset((void*)merge_processor, 0, sizeof(struct merge_processor_type_name__));                                                         \
+        merge_processor->on_entry = on_entry;                                                                                                  \
+        merge_processor->context = context;                                                                                                    \
+        merge_processor->max_batch = MERGE_PROCESSOR_DEFAULT_BATCH;                                                                            \
+        merge_processor->wait_nanoseconds = MERGE_PROCESSOR_DEFAULT_WAIT_NANOSECONDS;                                                          \
+        merge_processor->event_fd = -1;                                                                                                        \
+        merge_processor->ring_buffer_count = count;                                                                                            \
+        for (n = 0; n < count; ++n)                                                                                                            \
+                merge_processor->ring_buffers[n] = &ring_buffers[n];                                                                           \
+                                                                                                                                               \
+        return 1;                                                                                                                              \
+}
+
+/*
+ * Evaluates to non-zero if any of the ring buffers of the merge
+ * processor holds entries it has not yet handled.
+ */
+#define MERGE_PROCESSOR_AVAILABLE__(merge_processor__)                                                                             \
+({                                                                                                                                 \
+        unsigned int k__;                                                                                                          \
+        int available__ = 0;                                                                                                       \
+                                                                                                                                   \
+        for (k__ = 0; !available__ && (k__ < (merge_processor__)->ring_buffer_count); ++k__)                                       \
+                available__ = __atomic_load_n(&(merge_processor__)->ring_buffers[k__]->max_read_cursor.sequence, __ATOMIC_RELAXED) \
+                        >= (merge_processor__)->cursors[k__].sequence;                                                             \
+        available__;                                                                                                               \
+})
+
+/*
+ * Registers the merge processor with every ring buffer, in the
+ * calling thread so that no entry published after is missed, and
+ * starts its thread. Returns 1 (one) on success, 0 (zero) otherwise,
+ * e.g. if event_fd is not the eventfd of every ring buffer.
+ *
+ * Uses the register, unregister, release entry and show entry
+ * functions of the ring buffer, which must be defined with the same
+ * ring_buffer_prefix__ beforehand.
+ */
+#define DEFINE_MERGE_PROCESSOR_START_FUNCTION(entry_type_name__, ring_buffer_type_name__, merge_processor_type_name__, ring_buffer_prefix__...)                     \
+static void*                                                                                                                                                        \
+ring_buffer_prefix__ ## merge_processor_run(void *arg)                                                                                                              \
+{                                                                                                                                                                   \
+        struct merge_processor_type_name__ * const merge_processor = (struct merge_processor_type_name__*)arg;                                                      \
+        struct ring_buffer_type_name__ *ring_buffer;                                                                                                                \
+        const struct entry_type_name__ *entry;                                                                                                                      \
+        struct timespec deadline;                                                                                                                                   \
+        struct pollfd pollfd = { merge_processor->event_fd, POLLIN, 0 };                                                                                            \
+        const int timeout = (int)((merge_processor->wait_nanoseconds + 999999) / 1000000);                                                                          \
+        uint64_t value;                                                                                                                                             \
+        ssize_t drained __attribute__((unused));                                                                                                                    \
+        struct cursor_t upto;                                                                                                                                       \
+        struct cursor_t n;                                                                                                                                          \
+        unsigned int turn = 0;                                                                                                                                      \
+        unsigned int k;                                                                                                                                             \
+        int handled;                                                                                                                                                \
+        int halted;                                                                                                                                                 \
+        int error;                                                                                                                                                  \
+                                                                                                                                                                    \
+        for (;;) {                                                                                                                                                  \
+                halted = __atomic_load_n(&merge_processor->halted, __ATOMIC_ACQUIRE);                                                                               \
+                handled = 0;                                                                                                                                        \
+                for (k = 0; k < merge_processor->ring_buffer_count; ++k) {                                                                                          \
+                        ring_buffer = merge_processor->ring_buffers[k];                                                                                             \
+                        upto.sequence = __atomic_load_n(&ring_buffer->max_read_cursor.sequence, __ATOMIC_ACQUIRE);                                                  \
+                        if (upto.sequence < merge_processor->cursors[k].sequence)                                                                                   \
+                                continue;                                                                                                                           \
+                        if (upto.sequence - merge_processor->cursors[k].sequence >= merge_processor->max_batch)                                                     \
+                                upto.sequence = merge_processor->cursors[k].sequence + merge_processor->max_batch - 1;                                              \
+                        STATS_BATCH__(merge_processor->cursors[k].sequence, upto.sequence);                                                                         \
+                        for (n.sequence = merge_processor->cursors[k].sequence; n.sequence <= upto.sequence; ++n.sequence) {                                        \
+                                entry = ring_buffer_prefix__ ## ring_buffer_show_entry(ring_buffer, &n);                                                            \
+                                error = merge_processor->on_entry(entry, k, n.sequence, merge_processor->context);                                                  \
+                                if (UNLIKELY__(error)) {                                                                                                            \
+                                        merge_processor->error = error;                                                                                             \
+                                        goto out;                                                                                                                   \
+                                }                                                                                                                                   \
+                        }                                                                                                                                           \
+                        ring_buffer_prefix__ ## entry_processor_barrier_release_entry(ring_buffer, &merge_processor->entry_processor_numbers[k], &upto);            \
+                        merge_processor->cursors[k].sequence = upto.sequence + 1;                                                                                   \
+                        handled = 1;                                                                                                                                \
+                }                                                                                                                                                   \
+                if (handled)                                                                                                                                        \
+                        continue;                                                                                                                                   \
+                if (halted)                                                                                                                                         \
+                        break;                                                                                                                                      \
+                                                                                                                                                                    \
+                if (0 <= merge_processor->event_fd) {                                                                                                               \
+                        for (k = 0; k < merge_processor->ring_buffer_count; ++k)                                                                                    \
+                                __atomic_fetch_add(&merge_processor->ring_buffers[k]->wait_state.armed, 1, __ATOMIC_SEQ_CST);                                       \
+                        __atomic_thread_fence(__ATOMIC_SEQ_CST);                                                                                                    \
+                        if (!MERGE_PROCESSOR_AVAILABLE__(merge_processor) && !__atomic_load_n(&merge_processor->halted, __ATOMIC_ACQUIRE)) {                        \
+                                STATS_ADD__(sleeps, 1);                                                                                                             \
+                                if (1 == poll(&pollfd, 1, timeout))                                                                                                 \
+                                        drained = read(merge_processor->event_fd, &value, sizeof(value));                                                           \
+                        }                                                                                                                                           \
+                        continue;                                                                                                                                   \
+                }                                                                                                                                                   \
+                turn = (turn + 1) % merge_processor->ring_buffer_count;                                                                                             \
+                deadline_after(&deadline, merge_processor->wait_nanoseconds);                                                                                       \
+                (void)WAIT_UNTIL_DEADLINE__(merge_processor->ring_buffers[turn],                                                                                    \
+                                            MERGE_PROCESSOR_AVAILABLE__(merge_processor) || __atomic_load_n(&merge_processor->halted, __ATOMIC_ACQUIRE),            \
+                                            &deadline,                                                                                                              \
+                                            empty_waits);                                                                                                           \
+        }                                                                                                                                                           \
+out:                                                                                                                                                                \
+        for (k = 0; k < merge_processor->ring_buffer_count; ++k)                                                                                                    \
+                ring_buffer_prefix__ ## entry_processor_barrier_unregister(merge_processor->ring_buffers[k], &merge_processor->entry_processor_numbers[k]);         \
+                                                                                                                                                                    \
+        return NULL;                                                                                                                                                \
+}                                                                                                                                                                   \
+                                                                                                                                                                    \
+static __attribute__((noinline, unused)) int                                                                                                                        \
+ring_buffer_prefix__ ## merge_processor_start(struct merge_processor_type_name__ * const merge_processor)                                                           \
+{                                                                                                                                                                   \
+        unsigned int k;                                                                                                                                             \
+                                                                                                                                                                    \
+        for (k = 0; (0 <= merge_processor->event_fd) && (k < merge_processor->ring_buffer_count); ++k) {                                                            \
+                if (merge_processor->event_fd != __atomic_load_n(&merge_processor->ring_buffers[k]->wait_state.event_fd, __ATOMIC_RELAXED))                         \
+                        return 0;                                                                                                                                   \
+        }                                                                                                                                                           \
+        merge_processor->error = 0;                                                                                                                                 \
+        merge_processor->halted = 0;                                                                                                                                \
+        for (k = 0; k < merge_processor->ring_buffer_count; ++k)                                                                                                    \
+                merge_processor->cursors[k].sequence = ring_buffer_prefix__ ## entry_processor_barrier_register(merge_processor->ring_buffers[k],                   \
+                                                                                                                &merge_processor->entry_processor_numbers[k]);      \
+        if (pthread_create(&merge_processor->thread, NULL, ring_buffer_prefix__ ## merge_processor_run, merge_processor)) {                                         \
+                for (k = 0; k < merge_processor->ring_buffer_count; ++k)                                                                                            \
+                        ring_buffer_prefix__ ## entry_processor_barrier_unregister(merge_processor->ring_buffers[k], &merge_processor->entry_processor_numbers[k]); \
+                return 0;                                                                                                                                           \
+        }                                                                                                                                                           \
+                                                                                                                                                                    \
+        return 1;                                                                                                                                                   \
+}
+
+/*
+ * Makes the merge processor stop once it has handled all entries
+ * committed before the call. May be called from any thread, the
+ * handler included.
+ */
+#define DEFINE_MERGE_PROCESSOR_HALT_FUNCTION(merge_processor_type_name__, ring_buffer_prefix__...)       \
+static __attribute__((noinline, unused)) void                                                            \
+ring_buffer_prefix__ ## merge_processor_halt(struct merge_processor_type_name__ * const merge_processor) \
+{                                                                                                        \
+        unsigned int k;                                                                                  \
+                                                                                                         \
+        __atomic_store_n(&merge_processor->halted, 1, __ATOMIC_RELEASE);                                 \
+        for (k = 0; k < merge_processor->ring_buffer_count; ++k)                                         \
+                wait_strategy_wake(&merge_processor->ring_buffers[k]->wait_state);                       \
+}
+
+/*
+ * Waits for the merge processor to stop. Returns the value of the
+ * handler that stopped it, 0 (zero) if it was halted by
+ * merge_processor_halt().
+ */
+#define DEFINE_MERGE_PROCESSOR_JOIN_FUNCTION(merge_processor_type_name__, ring_buffer_prefix__...)       \
+static __attribute__((noinline, unused)) int                                                             \
+ring_buffer_prefix__ ## merge_processor_join(struct merge_processor_type_name__ * const merge_processor) \
+{                                                                                                        \
+        pthread_join(merge_processor->thread, NULL);                                                     \
+                                                                                                         \
+        return merge_processor->error;                                                                   \
+}
+
+#endif //  DISRUPTORC_SHARD_H
@@ -0,0 +1,386 @@
+/*
+ *    Copyright (C) 2012-2025, Jules Colding <jcolding@gmail.com>.
+ *
+ *    All Rights Reserved.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     (1) Redistributions of source code must retain the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer.
+ *
+ *     (2) Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *     (3) Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef DISRUPTORC_SHM_H
+#define DISRUPTORC_SHM_H
+
+#include "disruptor.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#if defined __linux__
+    #include <linux/memfd.h>
+#endif
+
+/*
+ * Ring buffers shared between processes.
+ *
+ * The ring buffer types are plain structures operated on by __atomic
+ * builtins and futexes, so a ring buffer works across processes as
+ * long as it is placed in memory mapped MAP_SHARED by all of
+ * them. The functions defined in this file place a ring buffer in a
+ * shared memory object (shm_open), an anonymous memory file
+ * (memfd_create) or an ordinary file, preceded by a header which
+ * allows attaching processes to check that they agree with the
+ * creator on the layout of the ring buffer.
+ *
+ * Only ring buffers of a size known at compile time can be shared, as
+ * ring buffers sized at run time hold pointers into themselves.
+ *
+ * Entry processors registered by way of
+ * entry_processor_barrier_shm_register() are recorded as owned by the
+ * registering process. If that process dies without unregistering
+ * then its slots keep gating the entry publishers until some other
+ * process calls ring_buffer_shm_reap(). Please note that:
+ *
+ *   - a process is only dead when it has been waited for, zombies
+ *     still count as alive.
+ *
+ *   - process IDs may be reused, so a slot owned by a dead process may
+ *     be mistaken as owned by a live one. It is then reaped when that
+ *     process dies.
+ *
+ *   - nothing is done about entry publishers dying between claiming
+ *     and committing an entry. Commits are made in order, so such a
+ *     ring buffer is stuck and must be created anew.
+ *
+ *   - all entry processors of a shared ring buffer must register by
+ *     way of entry_processor_barrier_shm_register(), as a slot is
+ *     owned before it is registered.
+ */
+
+/*
+ * "disrptrC" in ASCII. Written as the last field of the header, so
+ * attaching processes know that the ring buffer is ready for use when
+ * they see it.
+ */
+#define SHM_RING_BUFFER_MAGIC (0x4372747072736964ULL)
+
+/*
+ * Must be bumped whenever the layout of the header or of the ring
+ * buffer types, or the meaning of their fields, change.
+ */
+#define SHM_RING_BUFFER_VERSION (5)
+
+/*
+ * Precedes the ring buffer in shared memory.
+ */
+struct shm_ring_buffer_header_t {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t cache_line_size;
+        uint64_t entry_size;
+        uint64_t entry_capacity;
+        uint64_t entry_processor_capacity;
+        uint64_t ring_buffer_size;
+        pid_t creator;
+        pid_t entry_processor_owners[];
+};
+
+/*
+ * The header is padded to whole pages so that the ring buffer
+ * following it is page aligned.
+ */
+#define SHM_HEADER_SIZE__(entry_processor_capacity__) \
+        (((sizeof(struct shm_ring_buffer_header_t) + (entry_processor_capacity__) * sizeof(pid_t) + PAGE_SIZE - 1) / PAGE_SIZE) * PAGE_SIZE)
+
+#define SHM_HEADER__(ring_buffer__) \
+        ((struct shm_ring_buffer_header_t*)((uint8_t*)(ring_buffer__) - SHM_HEADER_SIZE__((ring_buffer__)->entry_processor_capacity.count)))
+
+#define SHM_ENTRY_PROCESSOR_CAPACITY__(ring_buffer_type_name__) \
+        (sizeof(((struct ring_buffer_type_name__*)0)->entry_processor_cursors)/sizeof(struct cursor_t))
+
+#define SHM_ENTRY_CAPACITY__(ring_buffer_type_name__) \
+        (sizeof(((struct ring_buffer_type_name__*)0)->buffer)/sizeof(((struct ring_buffer_type_name__*)0)->buffer[0]))
+
+#define SHM_ENTRY_SIZE__(ring_buffer_type_name__) \
+        (sizeof(((struct ring_buffer_type_name__*)0)->buffer[0]))
+
+#define SHM_LENGTH__(ring_buffer_type_name__) \
+        (SHM_HEADER_SIZE__(SHM_ENTRY_PROCESSOR_CAPACITY__(ring_buffer_type_name__)) + sizeof(struct ring_buffer_type_name__))
+
+/*
+ * Opens the POSIX shared memory object called name, creating it if
+ * create is non-zero. Returns a file descriptor or -1 and errno set.
+ */
+static __attribute__((unused)) int
+shared_memory_open(const char * const name,
+                   const int create)
+{
+        return shm_open(name, O_RDWR | (create ? O_CREAT : 0), S_IRUSR | S_IWUSR);
+}
+
+/*
+ * Opens the file at path, creating it if create is non-zero. Returns a
+ * file descriptor or -1 and errno set.
+ */
+static __attribute__((unused)) int
+shared_memory_open_file(const char * const path,
+                        const int create)
+{
+        return open(path, O_RDWR | (create ? O_CREAT : 0), S_IRUSR | S_IWUSR);
+}
+
+/*
+ * Creates an anonymous memory file. name is only used for debugging
+ * purposes. The file descriptor is inherited by child processes or
+ * may be passed to other processes over a Unix socket. Returns a file
+ * descriptor or -1 and errno set.
+ */
+static __attribute__((unused)) int
+shared_memory_open_anonymous(const char * const name)
+{
+#if defined __linux__ && defined SYS_memfd_create
+        return (int)syscall(SYS_memfd_create, name, MFD_CLOEXEC);
+#else
+        errno = ENOSYS;
+        return -1;
+#endif
+}
+
+/*
+ * Returns non-zero if there is no process with ID pid.
+ */
+static inline int
+shared_memory_owner_is_dead(const pid_t pid)
+{
+        return kill(pid, 0) && (ESRCH == errno);
+}
+
+/*
+ * Sizes the file referred to by fd to hold the header and the ring
+ * buffer, maps it and initializes the ring buffer. The file must not
+ * hold a ring buffer yet, which fails with EEXIST: truncate it first
+ * to create the ring buffer anew once no process uses it anymore.
+ * The file descriptor may be closed afterwards. Returns NULL and
+ * errno set on failure.
+ *
+ * The ring buffer must be detached by the function defined by
+ * DEFINE_SHM_RING_BUFFER_DETACH.
+ */
+#define DEFINE_SHM_RING_BUFFER_CREATE(ring_buffer_type_name__, ring_buffer_prefix__...)                           \
+static struct ring_buffer_type_name__ *                                                                           \
+ring_buffer_prefix__ ## ring_buffer_shm_create(const int fd)                                                      \
+{                                                                                                                 \
+        const size_t header_size = SHM_HEADER_SIZE__(SHM_ENTRY_PROCESSOR_CAPACITY__(ring_buffer_type_name__));    \
+        struct shm_ring_buffer_header_t *header;                                                                  \
+        struct ring_buffer_type_name__ *retv;                                                                     \
+        uint64_t magic;                                                                                           \
+                                                                                                                  \
+        if ((sizeof(magic) == pread(fd, &magic, sizeof(magic), offsetof(struct shm_ring_buffer_header_t, magic))) \
+            && (SHM_RING_BUFFER_MAGIC == magic)) {                                                                \
+                errno = EEXIST;                                                                                   \
+                return NULL;                                                                                      \
+        }                                                                                                         \
+        if (ftruncate(fd, 0) || ftruncate(fd, (off_t)SHM_LENGTH__(ring_buffer_type_name__)))                      \
+                return NULL;                                                                                      \
+        header = mmap(NULL, SHM_LENGTH__(ring_buffer_type_name__), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);    \
+        if (MAP_FAILED == header)                                                                                 \
+                return NULL;                                                                                      \
+        header->version = SHM_RING_BUFFER_VERSION;                                                                \
+        header->cache_line_size = CACHE_LINE_SIZE;                                                                \
+        header->entry_size = SHM_ENTRY_SIZE__(ring_buffer_type_name__);                                           \
+        header->entry_capacity = SHM_ENTRY_CAPACITY__(ring_buffer_type_name__);                                   \
+        header->entry_processor_capacity = SHM_ENTRY_PROCESSOR_CAPACITY__(ring_buffer_type_name__);               \
+        header->ring_buffer_size = sizeof(struct ring_buffer_type_name__);                                        \
+        header->creator = getpid();                                                                               \
+        retv = (struct ring_buffer_type_name__*)((uint8_t*)header + header_size);                                 \
+        ring_buffer_prefix__ ## ring_buffer_init(retv);                                                           \
+        __atomic_store_n(&header->magic, SHM_RING_BUFFER_MAGIC, __ATOMIC_RELEASE);                                \
+                                                                                                                  \
+        return retv;                                                                                              \
+}
+
+/*
+ * Maps the ring buffer created in the file referred to by fd. The file
+ * descriptor may be closed afterwards. Returns NULL on failure with
+ * errno set to EAGAIN if the ring buffer has not been created yet, or
+ * to EINVAL if it was created with another layout.
+ *
+ * The ring buffer must be detached by the function defined by
+ * DEFINE_SHM_RING_BUFFER_DETACH.
+ */
+#define DEFINE_SHM_RING_BUFFER_ATTACH(ring_buffer_type_name__, ring_buffer_prefix__...)                        \
+static struct ring_buffer_type_name__ *                                                                        \
+ring_buffer_prefix__ ## ring_buffer_shm_attach(const int fd)                                                   \
+{                                                                                                              \
+        const size_t header_size = SHM_HEADER_SIZE__(SHM_ENTRY_PROCESSOR_CAPACITY__(ring_buffer_type_name__)); \
+        struct shm_ring_buffer_header_t *header;                                                               \
+        struct stat st;                                                                                        \
+        int err = EINVAL;                                                                                      \
+                                                                                                               \
+        if (fstat(fd, &st))                                                                                    \
+                return NULL;                                                                                   \
+        if ((size_t)st.st_size != SHM_LENGTH__(ring_buffer_type_name__)) {                                     \
+                errno = st.st_size ? EINVAL : EAGAIN;                                                          \
+                return NULL;                                                                                   \
+        }                                                                                                      \
+        header = mmap(NULL, SHM_LENGTH__(ring_buffer_type_name__), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0); \
+        if (MAP_FAILED == header)                                                                              \
+                return NULL;                                                                                   \
+        switch (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE)) {                                           \
+        case SHM_RING_BUFFER_MAGIC:                                                                            \
+                break;                                                                                         \
+        case 0:                                                                                                \
+                err = EAGAIN;                                                                                  \
+                goto err;                                                                                      \
+        default:                                                                                               \
+                goto err;                                                                                      \
+        }                                                                                                      \
+        if ((SHM_RING_BUFFER_VERSION != header->version)                                                       \
+            || (CACHE_LINE_SIZE != header->cache_line_size)                                                    \
+            || (SHM_ENTRY_SIZE__(ring_buffer_type_name__) != header->entry_size)                               \
+            || (SHM_ENTRY_CAPACITY__(ring_buffer_type_name__) != header->entry_capacity)                       \
+            || (SHM_ENTRY_PROCESSOR_CAPACITY__(ring_buffer_type_name__) != header->entry_processor_capacity)   \
+            || (sizeof(struct ring_buffer_type_name__) != header->ring_buffer_size))                           \
+                goto err;                                                                                      \
+                                                                                                               \
+        return (struct ring_buffer_type_name__*)((uint8_t*)header + header_size);                              \
+err:                                                                                                           \
+        munmap(header, SHM_LENGTH__(ring_buffer_type_name__));                                                 \
+        errno = err;                                                                                           \
+        return NULL;                                                                                           \
+}
+
+/*
+ * Unmaps a ring buffer created or attached by the functions defined by
+ * DEFINE_SHM_RING_BUFFER_CREATE and DEFINE_SHM_RING_BUFFER_ATTACH. The
+ * shared memory object or file is left as is.
+ */
+#define DEFINE_SHM_RING_BUFFER_DETACH(ring_buffer_type_name__, ring_buffer_prefix__...)            \
+static void                                                                                        \
+ring_buffer_prefix__ ## ring_buffer_shm_detach(struct ring_buffer_type_name__ * const ring_buffer) \
+{                                                                                                  \
+        munmap(SHM_HEADER__(ring_buffer), SHM_LENGTH__(ring_buffer_type_name__));                  \
+}
+
+/*
+ * Like the function defined by
+ * DEFINE_ENTRY_PROCESSOR_BARRIER_REGISTER_FUNCTION but records the
+ * calling process as the owner of the entry processor so that
+ * ring_buffer_shm_reap() can free it should this process die. The
+ * owner is recorded before the slot is registered, so there is no
+ * window in which a dying process leaks a slot.
+ */
+#define DEFINE_SHM_ENTRY_PROCESSOR_BARRIER_REGISTER_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)                                     \
+static uint_fast64_t                                                                                                                               \
+ring_buffer_prefix__ ## entry_processor_barrier_shm_register(struct ring_buffer_type_name__ * const ring_buffer,                                   \
+                                                             struct count_t * const entry_processor_number)                                        \
+{                                                                                                                                                  \
+        struct shm_ring_buffer_header_t * const header = SHM_HEADER__(ring_buffer);                                                                \
+        const pid_t self = getpid();                                                                                                               \
+        unsigned int n;                                                                                                                            \
+        pid_t owner;                                                                                                                               \
+        uint_fast64_t vacant;                                                                                                                      \
+        uint_fast64_t seq;                                                                                                                         \
+                                                                                                                                                   \
+        do {                                                                                                                                       \
+                for (n = 0; n < ring_buffer->entry_processor_capacity.count; ++n) {                                                                \
+                        owner = 0;                                                                                                                 \
+                        if (!__atomic_compare_exchange_n(&header->entry_processor_owners[n], &owner, self, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) \
+                                continue;                                                                                                          \
+                        vacant = VACANT__;                                                                                                         \
+                        seq = __atomic_load_n(&ring_buffer->slowest_entry_processor.sequence, __ATOMIC_CONSUME);                                   \
+                        if (__atomic_compare_exchange_n(&ring_buffer->entry_processor_cursors[n].sequence,                                         \
+                                                        &vacant,                                                                                   \
+                                                        seq,                                                                                       \
+                                                        0,                                                                                         \
+                                                        __ATOMIC_RELEASE,                                                                          \
+                                                        __ATOMIC_RELAXED)) {                                                                       \
+                                entry_processor_number->count = n;                                                                                 \
+                                return 1 + seq;                                                                                                    \
+                        }                                                                                                                          \
+                        __atomic_store_n(&header->entry_processor_owners[n], 0, __ATOMIC_RELEASE);                                                 \
+                }                                                                                                                                  \
+        } while (1);                                                                                                                               \
+}
+
+/*
+ * Like the function defined by
+ * DEFINE_ENTRY_PROCESSOR_BARRIER_UNREGISTER_FUNCTION, which must also
+ * be defined, for entry processors registered by
+ * entry_processor_barrier_shm_register(). The slot is vacated before
+ * the owner is cleared, so that a process dying in between leaves a
+ * slot that ring_buffer_shm_reap() still frees.
+ */
+#define DEFINE_SHM_ENTRY_PROCESSOR_BARRIER_UNREGISTER_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)                  \
+static void                                                                                                                       \
+ring_buffer_prefix__ ## entry_processor_barrier_shm_unregister(struct ring_buffer_type_name__ * const ring_buffer,                \
+                                                               const struct count_t * const entry_processor_number)               \
+{                                                                                                                                 \
+        ring_buffer_prefix__ ## entry_processor_barrier_unregister(ring_buffer, entry_processor_number);                          \
+        __atomic_store_n(&SHM_HEADER__(ring_buffer)->entry_processor_owners[entry_processor_number->count], 0, __ATOMIC_RELEASE); \
+}
+
+/*
+ * Unregisters the entry processors owned by processes that have died
+ * and wakes up the entry publishers they were gating. Returns the
+ * number of entry processors unregistered. Meant to be called
+ * periodically by a supervising process or by entry publishers that
+ * have been waiting for suspiciously long. Requires that the function
+ * defined by DEFINE_ENTRY_PROCESSOR_BARRIER_UNREGISTER_FUNCTION is also
+ * defined.
+ */
+#define DEFINE_SHM_RING_BUFFER_REAP_FUNCTION(ring_buffer_type_name__, ring_buffer_prefix__...)                                                \
+static unsigned int                                                                                                                           \
+ring_buffer_prefix__ ## ring_buffer_shm_reap(struct ring_buffer_type_name__ * const ring_buffer)                                              \
+{                                                                                                                                             \
+        struct shm_ring_buffer_header_t * const header = SHM_HEADER__(ring_buffer);                                                           \
+        struct count_t n;                                                                                                                     \
+        unsigned int retv = 0;                                                                                                                \
+        pid_t owner;                                                                                                                          \
+                                                                                                                                              \
+        for (n.count = 0; n.count < ring_buffer->entry_processor_capacity.count; ++n.count) {                                                 \
+                owner = __atomic_load_n(&header->entry_processor_owners[n.count], __ATOMIC_ACQUIRE);                                          \
+                if (!owner || !shared_memory_owner_is_dead(owner))                                                                            \
+                        continue;                                                                                                             \
+                if (!__atomic_compare_exchange_n(&header->entry_processor_owners[n.count], &owner, 0, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) \
+                        continue;                                                                                                             \
+                ring_buffer_prefix__ ## entry_processor_barrier_unregister(ring_buffer, &n);                                                  \
+                ++retv;                                                                                                                       \
+        }                                                                                                                                     \
+        if (retv)                                                                                                                             \
+                SIGNAL__(ring_buffer);                                                                                                        \
+                                                                                                                                              \
+        return retv;                                                                                                                          \
+}
+
+#endif //  DISRUPTORC_SHM_H
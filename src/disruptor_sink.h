@@ -0,0 +1,467 @@
+/*
+ *    Copyright (C) 2012-2025, Jules Colding <jcolding@gmail.com>.
+ *
+ *    All Rights Reserved.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     (1) Redistributions of source code must retain the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer.
+ *
+ *     (2) Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *
+ *     (3) Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef DISRUPTORC_SINK_H
+#define DISRUPTORC_SINK_H
+
+#include "disruptor_io.h"
+
+#include <pthread.h>
+#include <sys/types.h>
+#ifdef HAVE_LIBURING
+    #include <liburing.h>
+#endif
+
+/*
+ * Sinks.
+ *
+ * A sink is an entry processor run in a thread of its own, which
+ * writes the entries of a ring buffer to a file or a socket. The
+ * content of the entries must be defined by DEFINE_IO_CONTENT_TYPE
+ * and empty entries are skipped.
+ *
+ * Entries are gathered into batches of up to max_batch entries and
+ * each batch is written with a single writev, straight from the ring
+ * buffer. With liburing, i.e. HAVE_LIBURING defined, the batches are
+ * submitted to an io_uring and up to depth batches are in flight at
+ * any time, so the sink keeps gathering entries while the kernel
+ * writes. Without it, each batch is written by pwritev(2) or writev(2)
+ * in the thread of the sink, i.e. a depth of 1 (one).
+ *
+ * Either way entries are released only once the batch holding them
+ * and all batches before it have been written in full, so entry
+ * publishers never overwrite an entry that the kernel may still read
+ * from and downstream entry processors never see an entry that was
+ * not written.
+ *
+ * Files are written from the offset given to sink_init() and on. For
+ * sockets, pipes and files opened with O_APPEND the offset must be
+ * SINK_STREAM, which keeps a single batch in flight so that the
+ * batches are written in order.
+ *
+ * A sink is halted by sink_halt(). It then writes all entries
+ * published before the call and stops. If a write fails, the sink
+ * stops once the batches in flight are done and sink_join() returns
+ * the errno value. Neither the failed batch nor any after it is
+ * released.
+ *
+ * As for batch processors, upstream entry processors may be given
+ * and only ring buffers that commit in order are supported.
+ */
+
+#define SINK_MAX_DEPTH (16)
+#define SINK_DEFAULT_DEPTH (4)
+#define SINK_STREAM ((off_t)-1)
+
+struct sink_batch_t {
+        uint_fast64_t hi; // sequence number of the last entry
+        off_t offset;
+        struct iovec *next; // first iovec not yet written
+        int iovcnt; // iovecs not yet written
+        int done; // written or failed, no longer in flight
+        int failed;
+        struct iovec iov[IO_MAX_BATCH];
+};
+
+/*
+ * The batches of a sink, in the order they were gathered.
+ */
+struct sink_queue_t {
+        unsigned int head;
+        unsigned int count;
+        int error;
+#ifdef HAVE_LIBURING
+        struct io_uring uring;
+#endif
+        struct sink_batch_t batches[SINK_MAX_DEPTH];
+};
+
+/*
+ * Skips the first length bytes of the batch.
+ */
+static __attribute__((noinline, unused)) void
+sink_batch_advance(struct sink_batch_t * const batch,
+                   size_t length)
+{
+        if (SINK_STREAM != batch->offset)
+                batch->offset += (off_t)length;
+        while (batch->iovcnt && (length >= batch->next->iov_len)) {
+                length -= batch->next->iov_len;
+                ++batch->next;
+                --batch->iovcnt;
+        }
+        if (batch->iovcnt) {
+                batch->next->iov_base = (uint8_t*)batch->next->iov_base + length;
+                batch->next->iov_len -= length;
+        }
+        batch->done = !batch->iovcnt;
+}
+
+/*
+ * Sets up the queue for depth batches in flight. Returns 0 (zero) on
+ * success, an errno value otherwise.
+ */
+static __attribute__((noinline, unused)) int
+sink_queue_open(struct sink_queue_t * const queue,
+                const unsigned int depth)
+{
+        queue->head = 0;
+        queue->count = 0;
+        queue->error = 0;
+#ifdef HAVE_LIBURING
+        return -io_uring_queue_init(depth, &queue->uring, 0);
+#else
+        (void)depth;
+        return 0;
+#endif
+}
+
+static __attribute__((noinline, unused)) void
+sink_queue_close(struct sink_queue_t * const queue)
+{
+#ifdef HAVE_LIBURING
+        io_uring_queue_exit(&queue->uring);
+#else
+        (void)queue;
+#endif
+}
+
+/*
+ * Writes the batch to fd, or the rest of it if it was partially
+ * written. With liburing the write is only submitted.
+ */
+static __attribute__((noinline, unused)) void
+sink_queue_submit(struct sink_queue_t * const queue,
+                  struct sink_batch_t * const batch,
+                  const int fd)
+{
+#ifdef HAVE_LIBURING
+        struct io_uring_sqe *sqe;
+        int retv;
+
+        sqe = io_uring_get_sqe(&queue->uring);
+        if (!sqe) {
+                queue->error = EBUSY;
+                batch->failed = 1;
+                batch->done = 1;
+                return;
+        }
+        io_uring_prep_writev(sqe, fd, batch->next, (unsigned int)batch->iovcnt, (uint64_t)batch->offset);
+        io_uring_sqe_set_data(sqe, batch);
+        retv = io_uring_submit(&queue->uring);
+        if (0 > retv) {
+                queue->error = -retv;
+                batch->failed = 1;
+                batch->done = 1;
+        }
+#else
+        ssize_t written;
+
+        while (!batch->done) {
+                if (SINK_STREAM == batch->offset)
+                        written = writev(fd, batch->next, batch->iovcnt);
+                else
+                        written = pwritev(fd, batch->next, batch->iovcnt, batch->offset);
+                if (0 > written) {
+                        if (EINTR == errno)
+                                continue;
+                        queue->error = errno;
+                        batch->failed = 1;
+                        batch->done = 1;
+                } else {
+                        sink_batch_advance(batch, (size_t)written);
+                }
+        }
+#endif
+}
+
+/*
+ * Handles the completed writes, waiting for at least one if wait is
+ * non-zero. Partially written batches are submitted again.
+ */
+static __attribute__((noinline, unused)) void
+sink_queue_reap(struct sink_queue_t * const queue,
+                const int fd,
+                int wait)
+{
+#ifdef HAVE_LIBURING
+        struct io_uring_cqe *cqe;
+        struct sink_batch_t *batch;
+        int res;
+
+        for (;;) {
+                res = wait ? io_uring_wait_cqe(&queue->uring, &cqe) : io_uring_peek_cqe(&queue->uring, &cqe);
+                if (-EINTR == res)
+                        continue;
+                if (res) {
+                        if (-EAGAIN != res)
+                                queue->error = -res;
+                        return;
+                }
+                batch = (struct sink_batch_t*)io_uring_cqe_get_data(cqe);
+                res = cqe->res;
+                io_uring_cqe_seen(&queue->uring, cqe);
+                wait = 0;
+
+                if ((-EINTR == res) || (-EAGAIN == res)) {
+                        sink_queue_submit(queue, batch, fd);
+                } else if (0 > res) {
+                        queue->error = -res;
+                        batch->failed = 1;
+                        batch->done = 1;
+                } else {
+                        sink_batch_advance(batch, (size_t)res);
+                        if (!batch->done)
+                                sink_queue_submit(queue, batch, fd);
+                }
+        }
+#else
+        (void)queue;
+        (void)fd;
+        (void)wait;
+#endif
+}
+
+/*
+ * Returns 1 (one) if no batch of the queue is in flight, 0 (zero)
+ * otherwise.
+ */
+static __attribute__((noinline, unused)) int
+sink_queue_settled(const struct sink_queue_t * const queue)
+{
+        unsigned int n;
+
+        for (n = 0; n < queue->count; ++n) {
+                if (!queue->batches[(queue->head + n) % SINK_MAX_DEPTH].done)
+                        return 0;
+        }
+
+        return 1;
+}
+
+/*
+ * Takes the written batches off the head of the queue, up to the
+ * first one still in flight or failed. Returns the sequence number of
+ * the last entry of the last batch taken, 0 (zero) if none.
+ */
+static __attribute__((noinline, unused)) uint_fast64_t
+sink_queue_retire(struct sink_queue_t * const queue)
+{
+        uint_fast64_t hi = 0;
+
+        while (queue->count && queue->batches[queue->head].done && !queue->batches[queue->head].failed) {
+                hi = queue->batches[queue->head].hi;
+                queue->head = (queue->head + 1) % SINK_MAX_DEPTH;
+                --queue->count;
+        }
+
+        return hi;
+}
+
+/*
+ * Defines the sink type. Fields from ring_buffer up to and including
+ * upstream_count are set by sink_init() and may then be changed
+ * before the sink is started. The rest is private.
+ */
+#define DEFINE_SINK_TYPE(entry_type_name__, ring_buffer_type_name__, sink_type_name__) \
+    struct sink_type_name__ {                                                          \
+            struct ring_buffer_type_name__ *ring_buffer;                               \
+            int fd;                                                                    \
+            off_t offset; /* of the next batch, or SINK_STREAM */                      \
+            unsigned int depth; /* batches in flight, up to SINK_MAX_DEPTH */          \
+            unsigned int max_batch; /* entries per batch, up to IO_MAX_BATCH */        \
+            const struct count_t *upstream;                                            \
+            unsigned int upstream_count;                                               \
+            struct count_t entry_processor_number;                                     \
+            struct cursor_t cursor;                                                    \
+            pthread_t thread;                                                          \
+            int error;                                                                 \
+            int halted;                                                                \
+            struct sink_queue_t queue;                                                 \
+    }
+
+/*
+ * Sets up a sink of ring_buffer writing to fd from offset and on, or
+ * SINK_STREAM, without any upstream entry processors.
+ */
+#define DEFINE_SINK_INIT_FUNCTION(entry_type_name__, ring_buffer_type_name__, sink_type_name__, ring_buffer_prefix__...) \
+static __attribute__((noinline, unused)) void                                                                            \
+ring_buffer_prefix__ ## sink_init(struct sink_type_name__ * const sink,                                                  \
+                                  struct ring_buffer_type_name__ * const ring_buffer,                                    \
+                                  const int fd,                                                                          \
+                                  const off_t offset)                                                                    \
+{                                                                                                                        \
+        memset((void*)sink, 0, sizeof(struct sink_type_name__));                                                         \
+        sink->ring_buffer = ring_buffer;                                                                                 \
+        sink->fd = fd;                                                                                                   \
+        sink->offset = offset;                                                                                           \
+        sink->depth = SINK_DEFAULT_DEPTH;                                                                                \
+        sink->max_batch = IO_MAX_BATCH;                                                                                  \
+}
+
+/*
+ * Registers the sink, in the calling thread so that no entry
+ * published after is missed, and starts its thread. Returns 1 (one)
+ * on success, 0 (zero) otherwise.
+ *
+ * Uses the register, unregister, release entry and show entry
+ * functions of the ring buffer, which must be defined with the same
+ * ring_buffer_prefix__ beforehand.
+ */
+#define DEFINE_SINK_START_FUNCTION(entry_type_name__, ring_buffer_type_name__, sink_type_name__, ring_buffer_prefix__...)                   \
+static void*                                                                                                                                \
+ring_buffer_prefix__ ## sink_run(void *arg)                                                                                                 \
+{                                                                                                                                           \
+        struct sink_type_name__ * const sink = (struct sink_type_name__*)arg;                                                               \
+        struct ring_buffer_type_name__ * const ring_buffer = sink->ring_buffer;                                                             \
+        struct sink_queue_t * const queue = &sink->queue;                                                                                   \
+        const unsigned int max_batch = (sink->max_batch && (IO_MAX_BATCH >= sink->max_batch)) ? sink->max_batch : IO_MAX_BATCH;             \
+        unsigned int depth = (sink->depth && (SINK_MAX_DEPTH >= sink->depth)) ? sink->depth : SINK_MAX_DEPTH;                               \
+        struct cursor_t cursor = sink->cursor;                                                                                              \
+        const struct entry_type_name__ *entry;                                                                                              \
+        struct sink_batch_t *batch;                                                                                                         \
+        struct cursor_t upto;                                                                                                               \
+        struct cursor_t n;                                                                                                                  \
+        int halted = 0;                                                                                                                     \
+        int idle;                                                                                                                           \
+                                                                                                                                            \
+        if (SINK_STREAM == sink->offset)                                                                                                    \
+                depth = 1;                                                                                                                  \
+        sink->error = sink_queue_open(queue, depth);                                                                                        \
+        if (sink->error)                                                                                                                    \
+                goto out;                                                                                                                   \
+                                                                                                                                            \
+        for (;;) {                                                                                                                          \
+                idle = 1;                                                                                                                   \
+                if (!queue->error && (depth > queue->count)) {                                                                              \
+                        if (!queue->count && !halted)                                                                                       \
+                                WAIT_UNTIL__(ring_buffer,                                                                                   \
+                                             UPSTREAM_SEQUENCE__(ring_buffer, sink->upstream, sink->upstream_count) >= cursor.sequence      \
+                                             || __atomic_load_n(&sink->halted, __ATOMIC_ACQUIRE),                                           \
+                                             empty_waits);                                                                                  \
+                        halted = halted || __atomic_load_n(&sink->halted, __ATOMIC_ACQUIRE);                                                \
+                        upto.sequence = UPSTREAM_SEQUENCE__(ring_buffer, sink->upstream, sink->upstream_count);                             \
+                        if (upto.sequence >= cursor.sequence) {                                                                             \
+                                if (upto.sequence - cursor.sequence >= max_batch)                                                           \
+                                        upto.sequence = cursor.sequence + max_batch - 1;                                                    \
+                                STATS_BATCH__(cursor.sequence, upto.sequence);                                                              \
+                                batch = &queue->batches[(queue->head + queue->count++) % SINK_MAX_DEPTH];                                   \
+                                batch->hi = upto.sequence;                                                                                  \
+                                batch->offset = sink->offset;                                                                               \
+                                batch->next = batch->iov;                                                                                   \
+                                batch->iovcnt = 0;                                                                                          \
+                                batch->failed = 0;                                                                                          \
+                                for (n.sequence = cursor.sequence; n.sequence <= upto.sequence; ++n.sequence) {                             \
+                                        entry = ring_buffer_prefix__ ## ring_buffer_show_entry(ring_buffer, &n);                            \
+                                        if (!entry->content.length)                                                                         \
+                                                continue;                                                                                   \
+                                        batch->iov[batch->iovcnt].iov_base = (void*)entry->content.data;                                    \
+                                        batch->iov[batch->iovcnt].iov_len = entry->content.length;                                          \
+                                        if (SINK_STREAM != sink->offset)                                                                    \
+                                                sink->offset += entry->content.length;                                                      \
+                                        ++batch->iovcnt;                                                                                    \
+                                }                                                                                                           \
+                                batch->done = !batch->iovcnt;                                                                               \
+                                if (!batch->done)                                                                                           \
+                                        sink_queue_submit(queue, batch, sink->fd);                                                          \
+                                cursor.sequence = upto.sequence + 1;                                                                        \
+                                idle = 0;                                                                                                   \
+                        }                                                                                                                   \
+                }                                                                                                                           \
+                if (!queue->count) {                                                                                                        \
+                        if (halted || queue->error)                                                                                         \
+                                break;                                                                                                      \
+                        continue;                                                                                                           \
+                }                                                                                                                           \
+                if (queue->error && sink_queue_settled(queue))                                                                              \
+                        break;                                                                                                              \
+                                                                                                                                            \
+                sink_queue_reap(queue, sink->fd, idle || (depth == queue->count));                                                          \
+                upto.sequence = sink_queue_retire(queue);                                                                                   \
+                if (upto.sequence)                                                                                                          \
+                        ring_buffer_prefix__ ## entry_processor_barrier_release_entry(ring_buffer, &sink->entry_processor_number, &upto);   \
+        }                                                                                                                                   \
+        sink->error = queue->error;                                                                                                         \
+        sink_queue_close(queue);                                                                                                            \
+out:                                                                                                                                        \
+        ring_buffer_prefix__ ## entry_processor_barrier_unregister(ring_buffer, &sink->entry_processor_number);                             \
+                                                                                                                                            \
+        return NULL;                                                                                                                        \
+}                                                                                                                                           \
+                                                                                                                                            \
+static __attribute__((noinline, unused)) int                                                                                                \
+ring_buffer_prefix__ ## sink_start(struct sink_type_name__ * const sink)                                                                    \
+{                                                                                                                                           \
+        sink->error = 0;                                                                                                                    \
+        sink->halted = 0;                                                                                                                   \
+        sink->cursor.sequence = ring_buffer_prefix__ ## entry_processor_barrier_register(sink->ring_buffer, &sink->entry_processor_number); \
+        if (pthread_create(&sink->thread, NULL, ring_buffer_prefix__ ## sink_run, sink)) {                                                  \
+                ring_buffer_prefix__ ## entry_processor_barrier_unregister(sink->ring_buffer, &sink->entry_processor_number);               \
+                return 0;                                                                                                                   \
+        }                                                                                                                                   \
+                                                                                                                                            \
+        return 1;                                                                                                                           \
+}
+
+/*
+ * Makes the sink stop once all entries published before the call are
+ * written. May be called from any thread.
+ */
+#define DEFINE_SINK_HALT_FUNCTION(sink_type_name__, ring_buffer_prefix__...) \
+static __attribute__((noinline, unused)) void                                \
+ring_buffer_prefix__ ## sink_halt(struct sink_type_name__ * const sink)      \
+{                                                                            \
+        __atomic_store_n(&sink->halted, 1, __ATOMIC_RELEASE);                \
+        wait_strategy_wake(&sink->ring_buffer->wait_state);                  \
+}
+
+/*
+ * Waits for the sink to stop. Returns 0 (zero) if all entries were
+ * written, the errno value of the failed write otherwise.
+ */
+#define DEFINE_SINK_JOIN_FUNCTION(sink_type_name__, ring_buffer_prefix__...) \
+static __attribute__((noinline, unused)) int                                 \
+ring_buffer_prefix__ ## sink_join(struct sink_type_name__ * const sink)      \
+{                                                                            \
+        pthread_join(sink->thread, NULL);                                    \
+                                                                             \
+        return sink->error;                                                  \
+}
+
+#endif //  DISRUPTORC_SINK_H
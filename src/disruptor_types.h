@@ -63,4 +63,70 @@ struct cursor_t {
         uint8_t padding[(CACHE_LINE_SIZE > sizeof(uint_fast64_t)) ? (CACHE_LINE_SIZE - sizeof(uint_fast64_t)) : (sizeof(uint_fast64_t) % CACHE_LINE_SIZE)];
 } __attribute__((aligned(CACHE_LINE_SIZE)));
 
+/*
+ * Cacheline padded wait strategy of a ring buffer. It is set before
+ * the ring buffer is put into use and only read thereafter.
+ * spin_count is the calibrated spin budget in pauses and
+ * yield_spin_count the pauses in between two sched_yield() once the
+ * spin budget is spent. signal tells commits and releases to wake up
+ * sleeping threads.
+ */
+struct wait_strategy_t {
+        uint_fast32_t strategy;
+        uint_fast32_t adaptive;
+        uint_fast32_t signal;
+        uint_fast64_t spin_count;
+        uint_fast64_t yield_spin_count;
+        uint8_t padding[(CACHE_LINE_SIZE > 3 * sizeof(uint_fast32_t) + 2 * sizeof(uint_fast64_t)) ? (CACHE_LINE_SIZE - 3 * sizeof(uint_fast32_t) - 2 * sizeof(uint_fast64_t)) : (sizeof(uint_fast64_t) % CACHE_LINE_SIZE)];
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+/*
+ * Cacheline padded state shared by the threads sleeping in the
+ * blocking wait strategy. futex is bumped on every wake up and
+ * waiters counts the sleeping threads. armed counts the pollers about
+ * to sleep on event_fd. spin_count is the adaptive spin budget in
+ * pauses. It is written at the end of waits, so it has a cache line
+ * of its own, apart from the fields read by every commit and release.
+ */
+struct wait_state_t {
+        uint32_t futex;
+        uint32_t waiters;
+        uint32_t armed;
+        int32_t event_fd;
+        uint_fast64_t spin_count __attribute__((aligned(CACHE_LINE_SIZE)));
+        uint8_t padding[(CACHE_LINE_SIZE > sizeof(uint_fast64_t)) ? (CACHE_LINE_SIZE - sizeof(uint_fast64_t)) : (sizeof(uint_fast64_t) % CACHE_LINE_SIZE)];
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+/*
+ * Cacheline padded write cursor of a ring buffer with a single entry
+ * publisher. Both fields are only ever written by that publisher.
+ * gating_sequence caches the slowest entry processor as last seen.
+ */
+struct publisher_cursor_t {
+        uint_fast64_t sequence;
+        uint_fast64_t gating_sequence;
+        uint8_t padding[(CACHE_LINE_SIZE > 2 * sizeof(uint_fast64_t)) ? (CACHE_LINE_SIZE - 2 * sizeof(uint_fast64_t)) : (sizeof(uint_fast64_t) % CACHE_LINE_SIZE)];
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+/*
+ * Statistics of one thread, see DISRUPTOR_STATS in disruptor.h. Only
+ * ever written by that thread. Cacheline aligned so that threads do
+ * not share the cache lines they count in.
+ *
+ * batches[n] counts the waits of entry processors which made 2^n up
+ * to 2^(n+1) - 1 entries available.
+ */
+#define DISRUPTOR_STATS_BATCH_BUCKETS (64)
+
+struct disruptor_stats_t {
+        uint_fast64_t full_waits;
+        uint_fast64_t commit_waits;
+        uint_fast64_t empty_waits;
+        uint_fast64_t spins;
+        uint_fast64_t yields;
+        uint_fast64_t sleeps;
+        uint_fast64_t timeouts;
+        uint_fast64_t batches[DISRUPTOR_STATS_BATCH_BUCKETS];
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
 #endif //  DISRUPTORC_TYPES_H
@@ -0,0 +1,668 @@
+/*
+ *  Copyright (C) 2012-2025 Jules Colding <jcolding@gmail.com>
+ *
+ *  All Rights Reserved.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *  You can use, modify and redistribute it in any way you want.
+ */
+
+/*
+ * Benchmark driver running every combination of the topologies, ring
+ * sizes, payload sizes, publishing modes and wait strategies given on
+ * the command line. Run with --help for the options.
+ *
+ * Topologies:
+ *
+ *   1p1c     - one entry publisher, one entry processor
+ *   1pnc     - one entry publisher, n entry processors seeing every entry
+ *   np1c     - n entry publishers, one entry processor
+ *   npnc     - n entry publishers, n entry processors seeing every entry
+ *   pipeline - one entry publisher, three entry processors in sequence
+ *   diamond  - one entry publisher, two entry processors in parallel
+ *              followed by one depending on both
+ *
+ * Results are written as text, CSV or JSON lines, one line per
+ * combination, for tracking regressions between releases.
+ */
+
+#ifdef HAVE_CONFIG_H
+    #include "ac_config.h"
+#endif
+
+#include <errno.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+
+#include "src/disruptor.h"
+#include "test/payload.h"
+
+#define STOP UINT_FAST64_MAX
+#define MAX_THREADS (64)
+#define MAX_LIST (16)
+
+enum topology_kind_t {
+        TOPOLOGY_1P1C,
+        TOPOLOGY_1PNC,
+        TOPOLOGY_NP1C,
+        TOPOLOGY_NPNC,
+        TOPOLOGY_PIPELINE,
+        TOPOLOGY_DIAMOND
+};
+
+struct topology_t {
+        const char *name;
+        enum topology_kind_t kind;
+};
+
+static const struct topology_t topologies[] = {
+        { "1p1c", TOPOLOGY_1P1C },
+        { "1pnc", TOPOLOGY_1PNC },
+        { "np1c", TOPOLOGY_NP1C },
+        { "npnc", TOPOLOGY_NPNC },
+        { "pipeline", TOPOLOGY_PIPELINE },
+        { "diamond", TOPOLOGY_DIAMOND },
+};
+
+static const char * const wait_strategy_names[] = { "busy-spin", "yield", "blocking", "timed" };
+static const uint_fast32_t wait_strategies[] = { WAIT_STRATEGY_BUSY_SPIN, WAIT_STRATEGY_YIELD, WAIT_STRATEGY_BLOCKING, WAIT_STRATEGY_TIMED };
+
+enum format_t {
+        FORMAT_TEXT,
+        FORMAT_CSV,
+        FORMAT_JSON
+};
+
+/*
+ * One combination of the command line options.
+ */
+struct run_t {
+        const struct topology_t *topology;
+        unsigned int publishers;
+        unsigned int processors;
+        uint_fast64_t ring_size;
+        unsigned int payload_size;
+        int nonblocking;
+        unsigned int wait_strategy;
+        int pin;
+        uint_fast64_t entries;
+        double seconds;
+};
+
+/*
+ * Argument of entry publisher and entry processor threads.
+ */
+struct thread_arg_t {
+        struct run_t *run;
+        void *ring_buffer;
+        unsigned int cpu;
+        uint_fast64_t entries;
+        uint_fast64_t first_sequence;
+        struct count_t reg_number;
+        struct count_t upstream[2];
+        unsigned int upstream_count;
+};
+
+uint_fast64_t payload_sum;
+volatile int go;
+
+static uint_fast64_t
+now(void)
+{
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+
+        return (uint_fast64_t)ts.tv_sec * 1000000000 + (uint_fast64_t)ts.tv_nsec;
+}
+
+/*
+ * Pins the calling thread to cpu modulo the number of online CPUs.
+ */
+static void
+pin_thread(const unsigned int cpu)
+{
+#if defined __linux__
+        cpu_set_t set;
+        const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+        CPU_ZERO(&set);
+        CPU_SET(cpu % (unsigned int)((cpus > 0) ? cpus : 1), &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+        (void)cpu;
+#endif
+}
+
+static int
+create_thread(pthread_t * const thread_id,
+              void *thread_arg,
+              void *(*thread_func)(void *))
+{
+        int retv = 0;
+        pthread_attr_t thread_attr;
+
+        if (pthread_attr_init(&thread_attr))
+                return 0;
+
+        if (pthread_attr_setdetachstate(&thread_attr, PTHREAD_CREATE_JOINABLE))
+                goto err;
+
+        if (pthread_create(thread_id, &thread_attr, thread_func, thread_arg))
+                goto err;
+
+        retv = 1;
+err:
+        pthread_attr_destroy(&thread_attr);
+
+        return retv;
+}
+
+/*
+ * Defines a ring buffer sized at run time with payloads of
+ * payload_size__ bytes, the entry publisher and entry processor
+ * threads using it and a function running a benchmark on it. The
+ * function returns 0 (zero) on success, EINVAL if the ring size is
+ * not a power of two or ENOMEM if the ring buffer could not be
+ * allocated.
+ */
+#define DEFINE_PAYLOAD_BENCHMARK(payload_size__)                                                                                         \
+DEFINE_ENTRY_TYPE(payload ## payload_size__ ## _t, entry ## payload_size__ ## _t);                                                       \
+DEFINE_RUNTIME_RING_BUFFER_TYPE(entry ## payload_size__ ## _t, ring_buffer ## payload_size__ ## _t);                                     \
+DEFINE_RUNTIME_RING_BUFFER_MALLOC(entry ## payload_size__ ## _t, ring_buffer ## payload_size__ ## _t, p ## payload_size__ ## _);         \
+DEFINE_RUNTIME_RING_BUFFER_INIT(entry ## payload_size__ ## _t, ring_buffer ## payload_size__ ## _t, p ## payload_size__ ## _);           \
+DEFINE_RING_BUFFER_SET_WAIT_STRATEGY_FUNCTION(ring_buffer ## payload_size__ ## _t, p ## payload_size__ ## _);                            \
+DEFINE_RING_BUFFER_SHOW_ENTRY_FUNCTION(entry ## payload_size__ ## _t, ring_buffer ## payload_size__ ## _t, p ## payload_size__ ## _);    \
+DEFINE_RING_BUFFER_ACQUIRE_ENTRY_FUNCTION(entry ## payload_size__ ## _t, ring_buffer ## payload_size__ ## _t, p ## payload_size__ ## _); \
+DEFINE_ENTRY_PROCESSOR_BARRIER_REGISTER_FUNCTION(ring_buffer ## payload_size__ ## _t, p ## payload_size__ ## _);                         \
+DEFINE_ENTRY_PROCESSOR_BARRIER_UNREGISTER_FUNCTION(ring_buffer ## payload_size__ ## _t, p ## payload_size__ ## _);                       \
+DEFINE_ENTRY_PROCESSOR_BARRIER_WAITFOR_BLOCKING_FUNCTION(ring_buffer ## payload_size__ ## _t, p ## payload_size__ ## _);                 \
+DEFINE_ENTRY_PROCESSOR_BARRIER_WAITFOR_DEPENDENCIES_BLOCKING_FUNCTION(ring_buffer ## payload_size__ ## _t, p ## payload_size__ ## _);    \
+DEFINE_ENTRY_PROCESSOR_BARRIER_SET_GATING_FUNCTION(ring_buffer ## payload_size__ ## _t, p ## payload_size__ ## _);                       \
+DEFINE_ENTRY_PROCESSOR_BARRIER_RELEASEENTRY_FUNCTION(ring_buffer ## payload_size__ ## _t, p ## payload_size__ ## _);                     \
+DEFINE_ENTRY_PUBLISHER_NEXTENTRY_BLOCKING_FUNCTION(ring_buffer ## payload_size__ ## _t, p ## payload_size__ ## _);                       \
+DEFINE_ENTRY_PUBLISHER_NEXTENTRY_NONBLOCKING_FUNCTION(ring_buffer ## payload_size__ ## _t, p ## payload_size__ ## _);                    \
+DEFINE_ENTRY_PUBLISHER_COMMITENTRY_BLOCKING_FUNCTION(ring_buffer ## payload_size__ ## _t, p ## payload_size__ ## _);                     \
+                                                                                                                                         \
+static void*                                                                                                                             \
+p ## payload_size__ ## _publisher_thread(void *arg)                                                                                      \
+{                                                                                                                                        \
+        struct thread_arg_t * const targ = (struct thread_arg_t*)arg;                                                                    \
+        struct ring_buffer ## payload_size__ ## _t * const buffer = targ->ring_buffer;                                                   \
+        struct entry ## payload_size__ ## _t *entry;                                                                                     \
+        struct cursor_t cursor;                                                                                                          \
+        uint_fast64_t reps;                                                                                                              \
+                                                                                                                                         \
+        if (targ->run->pin)                                                                                                              \
+                pin_thread(targ->cpu);                                                                                                   \
+        while (!go)                                                                                                                      \
+                ;                                                                                                                        \
+        for (reps = targ->entries; reps; --reps) {                                                                                       \
+                if (targ->run->nonblocking) {                                                                                            \
+                        while (!p ## payload_size__ ## _publisher_next_entry_nonblocking(buffer, &cursor))                               \
+                                ;                                                                                                        \
+                } else {                                                                                                                 \
+                        p ## payload_size__ ## _publisher_next_entry_blocking(buffer, &cursor);                                          \
+                }                                                                                                                        \
+                entry = p ## payload_size__ ## _ring_buffer_acquire_entry(buffer, &cursor);                                              \
+                PAYLOAD_WRITE__(entry, cursor.sequence);                                                                                 \
+                p ## payload_size__ ## _publisher_commit_entry_blocking(buffer, &cursor);                                                \
+        }                                                                                                                                \
+                                                                                                                                         \
+        return NULL;                                                                                                                     \
+}                                                                                                                                        \
+                                                                                                                                         \
+/* waits for the upstream entry processors, if any, or else for the entry publishers */                                                  \
+static inline void                                                                                                                       \
+p ## payload_size__ ## _wait_for(const struct thread_arg_t * const targ,                                                                 \
+                                 struct cursor_t * const cursor)                                                                         \
+{                                                                                                                                        \
+        const struct ring_buffer ## payload_size__ ## _t * const buffer = targ->ring_buffer;                                             \
+                                                                                                                                         \
+        if (targ->upstream_count)                                                                                                        \
+                p ## payload_size__ ## _entry_processor_barrier_wait_for_dependencies_blocking(buffer, targ->upstream,                   \
+                                                                                               targ->upstream_count, cursor);            \
+        else                                                                                                                             \
+                p ## payload_size__ ## _entry_processor_barrier_wait_for_blocking(buffer, cursor);                                       \
+}                                                                                                                                        \
+                                                                                                                                         \
+static void*                                                                                                                             \
+p ## payload_size__ ## _processor_thread(void *arg)                                                                                      \
+{                                                                                                                                        \
+        struct thread_arg_t * const targ = (struct thread_arg_t*)arg;                                                                    \
+        struct ring_buffer ## payload_size__ ## _t * const buffer = targ->ring_buffer;                                                   \
+        struct cursor_t n;                                                                                                               \
+        struct cursor_t cursor_upper_limit;                                                                                              \
+        uint_fast64_t sum = 0;                                                                                                           \
+                                                                                                                                         \
+        if (targ->run->pin)                                                                                                              \
+                pin_thread(targ->cpu);                                                                                                   \
+        n.sequence = PAYLOAD_PROCESS__(buffer, &targ->reg_number, targ->first_sequence, cursor_upper_limit,                              \
+                                       p ## payload_size__ ## _wait_for(targ, &cursor_upper_limit),                                      \
+                                       sum, p ## payload_size__ ## _);                                                                   \
+        /* let entry processors downstream see the STOP entry too */                                                                     \
+        p ## payload_size__ ## _entry_processor_barrier_release_entry(buffer, &targ->reg_number, &n);                                    \
+        __atomic_fetch_add(&payload_sum, sum, __ATOMIC_RELAXED);                                                                         \
+                                                                                                                                         \
+        return NULL;                                                                                                                     \
+}                                                                                                                                        \
+                                                                                                                                         \
+static int                                                                                                                               \
+p ## payload_size__ ## _run(struct run_t * const run)                                                                                    \
+{                                                                                                                                        \
+        struct ring_buffer ## payload_size__ ## _t *buffer;                                                                              \
+        struct thread_arg_t targs[MAX_THREADS];                                                                                          \
+        pthread_t threads[MAX_THREADS];                                                                                                  \
+        struct entry ## payload_size__ ## _t *entry;                                                                                     \
+        struct cursor_t cursor;                                                                                                          \
+        uint_fast64_t start;                                                                                                             \
+        unsigned int n;                                                                                                                  \
+        unsigned int m;                                                                                                                  \
+                                                                                                                                         \
+        if ((run->ring_size < 2) || (run->ring_size & (run->ring_size - 1)))                                                             \
+                return EINVAL;                                                                                                           \
+        buffer = p ## payload_size__ ## _ring_buffer_malloc(run->ring_size, run->processors);                                            \
+        if (!buffer)                                                                                                                     \
+                return ENOMEM;                                                                                                           \
+        p ## payload_size__ ## _ring_buffer_init(buffer);                                                                                \
+        p ## payload_size__ ## _ring_buffer_set_wait_strategy(buffer, wait_strategies[run->wait_strategy]);                              \
+        memset(targs, 0, sizeof(targs));                                                                                                 \
+        go = 0;                                                                                                                          \
+                                                                                                                                         \
+        /* register all entry processors up front so that upstream ones are known */                                                     \
+        for (n = 0; n < run->processors; ++n) {                                                                                          \
+                targs[n].run = run;                                                                                                      \
+                targs[n].ring_buffer = buffer;                                                                                           \
+                targs[n].cpu = run->publishers + n;                                                                                      \
+                targs[n].first_sequence = p ## payload_size__ ## _entry_processor_barrier_register(buffer, &targs[n].reg_number);        \
+        }                                                                                                                                \
+        switch (run->topology->kind) {                                                                                                   \
+        case TOPOLOGY_PIPELINE:                                                                                                          \
+                for (n = 1; n < run->processors; ++n) {                                                                                  \
+                        targs[n].upstream[0] = targs[n - 1].reg_number;                                                                  \
+                        targs[n].upstream_count = 1;                                                                                     \
+                        p ## payload_size__ ## _entry_processor_barrier_set_gating(buffer, &targs[n - 1].reg_number, 0);                 \
+                }                                                                                                                        \
+                break;                                                                                                                   \
+        case TOPOLOGY_DIAMOND:                                                                                                           \
+                targs[2].upstream[0] = targs[0].reg_number;                                                                              \
+                targs[2].upstream[1] = targs[1].reg_number;                                                                              \
+                targs[2].upstream_count = 2;                                                                                             \
+                p ## payload_size__ ## _entry_processor_barrier_set_gating(buffer, &targs[0].reg_number, 0);                             \
+                p ## payload_size__ ## _entry_processor_barrier_set_gating(buffer, &targs[1].reg_number, 0);                             \
+                break;                                                                                                                   \
+        default:                                                                                                                         \
+                break;                                                                                                                   \
+        }                                                                                                                                \
+        for (n = 0; n < run->processors; ++n) {                                                                                          \
+                if (!create_thread(&threads[n], &targs[n], p ## payload_size__ ## _processor_thread)) {                                  \
+                        printf("could not create entry processor thread\n");                                                             \
+                        exit(EXIT_FAILURE);                                                                                              \
+                }                                                                                                                        \
+        }                                                                                                                                \
+        for (m = 0; m < run->publishers; ++m) {                                                                                          \
+                n = run->processors + m;                                                                                                 \
+                targs[n].run = run;                                                                                                      \
+                targs[n].ring_buffer = buffer;                                                                                           \
+                targs[n].cpu = m;                                                                                                        \
+                targs[n].entries = run->entries / run->publishers + (m ? 0 : run->entries % run->publishers);                            \
+                if (!create_thread(&threads[n], &targs[n], p ## payload_size__ ## _publisher_thread)) {                                  \
+                        printf("could not create entry publisher thread\n");                                                             \
+                        exit(EXIT_FAILURE);                                                                                              \
+                }                                                                                                                        \
+        }                                                                                                                                \
+                                                                                                                                         \
+        start = now();                                                                                                                   \
+        __atomic_store_n(&go, 1, __ATOMIC_RELEASE);                                                                                      \
+        for (m = 0; m < run->publishers; ++m)                                                                                            \
+                pthread_join(threads[run->processors + m], NULL);                                                                        \
+        p ## payload_size__ ## _publisher_next_entry_blocking(buffer, &cursor);                                                          \
+        entry = p ## payload_size__ ## _ring_buffer_acquire_entry(buffer, &cursor);                                                      \
+        entry->content[0] = STOP;                                                                                                        \
+        p ## payload_size__ ## _publisher_commit_entry_blocking(buffer, &cursor);                                                        \
+        for (n = 0; n < run->processors; ++n)                                                                                            \
+                pthread_join(threads[n], NULL);                                                                                          \
+        run->seconds = (double)(now() - start) / 1000000000.0;                                                                           \
+                                                                                                                                         \
+        for (n = 0; n < run->processors; ++n)                                                                                            \
+                p ## payload_size__ ## _entry_processor_barrier_unregister(buffer, &targs[n].reg_number);                                \
+        free(buffer);                                                                                                                    \
+                                                                                                                                         \
+        return 0;                                                                                                                        \
+}
+
+DEFINE_PAYLOAD_BENCHMARK(8);
+DEFINE_PAYLOAD_BENCHMARK(16);
+DEFINE_PAYLOAD_BENCHMARK(32);
+DEFINE_PAYLOAD_BENCHMARK(64);
+DEFINE_PAYLOAD_BENCHMARK(128);
+DEFINE_PAYLOAD_BENCHMARK(256);
+
+struct payload_benchmark_t {
+        unsigned int payload_size;
+        int (*run)(struct run_t * const run);
+};
+
+static const struct payload_benchmark_t payload_benchmarks[] = {
+        { 8, p8_run },
+        { 16, p16_run },
+        { 32, p32_run },
+        { 64, p64_run },
+        { 128, p128_run },
+        { 256, p256_run },
+};
+
+static void
+usage(const char * const name)
+{
+        printf("Usage: %s [OPTION]...\n"
+               "Runs every combination of the given lists of comma separated values.\n"
+               "\n"
+               "  -t, --topology=LIST     1p1c, 1pnc, np1c, npnc, pipeline or diamond (1p1c)\n"
+               "  -n, --threads=N         entry publishers or entry processors for the n topologies (3)\n"
+               "  -r, --ring-size=LIST    entries in the ring buffer, powers of two (2048)\n"
+               "  -s, --payload-size=LIST bytes of payload, 8, 16, 32, 64, 128 or 256 (8)\n"
+               "  -p, --publish=LIST      blocking or nonblocking (blocking)\n"
+               "  -w, --wait=LIST         busy-spin, yield, blocking or timed (yield)\n"
+               "  -e, --entries=N         entries to publish per combination (10000000)\n"
+               "  -P, --pin               pin every thread to its own CPU\n"
+               "  -f, --format=FORMAT     text, csv or json (text)\n"
+               "  -h, --help              show this help\n",
+               name);
+}
+
+/*
+ * Splits the comma separated list in arg into values, using
+ * lookup to translate each element. Returns the number of values or
+ * 0 (zero) on error.
+ */
+static unsigned int
+parse_list(char * const arg,
+           uint_fast64_t * const values,
+           int (*lookup)(const char *element, uint_fast64_t *value))
+{
+        unsigned int count = 0;
+        char *save = NULL;
+        char *element;
+
+        for (element = strtok_r(arg, ",", &save); element; element = strtok_r(NULL, ",", &save)) {
+                if ((MAX_LIST == count) || !lookup(element, &values[count]))
+                        return 0;
+                ++count;
+        }
+
+        return count;
+}
+
+static int
+lookup_number(const char *element,
+              uint_fast64_t *value)
+{
+        char *end;
+
+        *value = strtoull(element, &end, 10);
+
+        return (end != element) && !*end && *value;
+}
+
+static int
+lookup_topology(const char *element,
+                uint_fast64_t *value)
+{
+        for (*value = 0; *value < sizeof(topologies)/sizeof(topologies[0]); ++*value) {
+                if (!strcmp(element, topologies[*value].name))
+                        return 1;
+        }
+
+        return 0;
+}
+
+static int
+lookup_payload_size(const char *element,
+                    uint_fast64_t *value)
+{
+        uint_fast64_t size;
+
+        if (!lookup_number(element, &size))
+                return 0;
+        for (*value = 0; *value < sizeof(payload_benchmarks)/sizeof(payload_benchmarks[0]); ++*value) {
+                if (size == payload_benchmarks[*value].payload_size)
+                        return 1;
+        }
+
+        return 0;
+}
+
+static int
+lookup_publish(const char *element,
+               uint_fast64_t *value)
+{
+        if (!strcmp(element, "blocking"))
+                *value = 0;
+        else if (!strcmp(element, "nonblocking"))
+                *value = 1;
+        else
+                return 0;
+
+        return 1;
+}
+
+static int
+lookup_wait_strategy(const char *element,
+                     uint_fast64_t *value)
+{
+        for (*value = 0; *value < sizeof(wait_strategy_names)/sizeof(wait_strategy_names[0]); ++*value) {
+                if (!strcmp(element, wait_strategy_names[*value]))
+                        return 1;
+        }
+
+        return 0;
+}
+
+static void
+print_header(const enum format_t format)
+{
+        if (FORMAT_CSV == format)
+                printf("topology,publishers,processors,ring_size,payload_size,publish,wait,pinned,entries,seconds,entries_per_second\n");
+}
+
+static void
+print_run(const enum format_t format,
+          const struct run_t * const run)
+{
+        const char * const publish = run->nonblocking ? "nonblocking" : "blocking";
+        const double entries_per_second = (double)run->entries / run->seconds;
+
+        switch (format) {
+        case FORMAT_CSV:
+                printf("%s,%u,%u,%" PRIuFAST64 ",%u,%s,%s,%d,%" PRIuFAST64 ",%lf,%lf\n",
+                       run->topology->name, run->publishers, run->processors, run->ring_size, run->payload_size,
+                       publish, wait_strategy_names[run->wait_strategy], run->pin, run->entries, run->seconds, entries_per_second);
+                break;
+        case FORMAT_JSON:
+                printf("{\"topology\": \"%s\", \"publishers\": %u, \"processors\": %u, \"ring_size\": %" PRIuFAST64
+                       ", \"payload_size\": %u, \"publish\": \"%s\", \"wait\": \"%s\", \"pinned\": %s, \"entries\": %" PRIuFAST64
+                       ", \"seconds\": %lf, \"entries_per_second\": %lf}\n",
+                       run->topology->name, run->publishers, run->processors, run->ring_size, run->payload_size,
+                       publish, wait_strategy_names[run->wait_strategy], run->pin ? "true" : "false", run->entries,
+                       run->seconds, entries_per_second);
+                break;
+        default:
+                printf("%-8s %2uP %2uC ring %8" PRIuFAST64 " payload %3u %-11s %-9s%s: %lf entries per second\n",
+                       run->topology->name, run->publishers, run->processors, run->ring_size, run->payload_size,
+                       publish, wait_strategy_names[run->wait_strategy], run->pin ? " pinned" : "", entries_per_second);
+                break;
+        }
+        fflush(stdout);
+}
+
+/*
+ * Runs one combination of the command line options and prints the
+ * result. Returns 0 (zero) on error.
+ */
+static int
+run_benchmark(const enum format_t format,
+              const struct topology_t * const topology,
+              const unsigned int threads,
+              const uint_fast64_t ring_size,
+              const struct payload_benchmark_t * const payload_benchmark,
+              const int nonblocking,
+              const unsigned int wait_strategy,
+              const int pin,
+              const uint_fast64_t entries)
+{
+        struct run_t run;
+        int err;
+
+        memset(&run, 0, sizeof(run));
+        run.topology = topology;
+        switch (topology->kind) {
+        case TOPOLOGY_1P1C:
+                run.publishers = 1;
+                run.processors = 1;
+                break;
+        case TOPOLOGY_1PNC:
+                run.publishers = 1;
+                run.processors = threads;
+                break;
+        case TOPOLOGY_NP1C:
+                run.publishers = threads;
+                run.processors = 1;
+                break;
+        case TOPOLOGY_NPNC:
+                run.publishers = threads;
+                run.processors = threads;
+                break;
+        case TOPOLOGY_PIPELINE:
+        case TOPOLOGY_DIAMOND:
+                run.publishers = 1;
+                run.processors = 3;
+                break;
+        }
+        run.ring_size = ring_size;
+        run.payload_size = payload_benchmark->payload_size;
+        run.nonblocking = nonblocking;
+        run.wait_strategy = wait_strategy;
+        run.pin = pin;
+        run.entries = entries;
+        err = payload_benchmark->run(&run);
+        if (EINVAL == err) {
+                fprintf(stderr, "Invalid ring size %" PRIuFAST64 ", must be a power of two\n", ring_size);
+                return 0;
+        }
+        if (err) {
+                fprintf(stderr, "Could not allocate a ring buffer of %" PRIuFAST64 " entries: %s\n", ring_size, strerror(err));
+                return 0;
+        }
+        print_run(format, &run);
+
+        return 1;
+}
+
+int
+main(int argc, char *argv[])
+{
+        static const struct option options[] = {
+                { "topology", required_argument, NULL, 't' },
+                { "threads", required_argument, NULL, 'n' },
+                { "ring-size", required_argument, NULL, 'r' },
+                { "payload-size", required_argument, NULL, 's' },
+                { "publish", required_argument, NULL, 'p' },
+                { "wait", required_argument, NULL, 'w' },
+                { "entries", required_argument, NULL, 'e' },
+                { "pin", no_argument, NULL, 'P' },
+                { "format", required_argument, NULL, 'f' },
+                { "help", no_argument, NULL, 'h' },
+                { NULL, 0, NULL, 0 }
+        };
+        uint_fast64_t topology_list[MAX_LIST] = { 0 };
+        uint_fast64_t ring_size_list[MAX_LIST] = { 2048 };
+        uint_fast64_t payload_list[MAX_LIST] = { 0 };
+        uint_fast64_t publish_list[MAX_LIST] = { 0 };
+        uint_fast64_t wait_list[MAX_LIST] = { 1 };
+        unsigned int topology_count = 1;
+        unsigned int ring_size_count = 1;
+        unsigned int payload_count = 1;
+        unsigned int publish_count = 1;
+        unsigned int wait_count = 1;
+        uint_fast64_t threads = 3;
+        uint_fast64_t entries = 10 * 1000 * 1000;
+        enum format_t format = FORMAT_TEXT;
+        int pin = 0;
+        unsigned int t, r, s, p, w;
+        int opt;
+
+        while (-1 != (opt = getopt_long(argc, argv, "t:n:r:s:p:w:e:Pf:h", options, NULL))) {
+                switch (opt) {
+                case 't':
+                        topology_count = parse_list(optarg, topology_list, lookup_topology);
+                        break;
+                case 'n':
+                        if (!lookup_number(optarg, &threads) || (threads > MAX_THREADS / 2))
+                                threads = 0;
+                        break;
+                case 'r':
+                        ring_size_count = parse_list(optarg, ring_size_list, lookup_number);
+                        break;
+                case 's':
+                        payload_count = parse_list(optarg, payload_list, lookup_payload_size);
+                        break;
+                case 'p':
+                        publish_count = parse_list(optarg, publish_list, lookup_publish);
+                        break;
+                case 'w':
+                        wait_count = parse_list(optarg, wait_list, lookup_wait_strategy);
+                        break;
+                case 'e':
+                        if (!lookup_number(optarg, &entries))
+                                entries = 0;
+                        break;
+                case 'P':
+                        pin = 1;
+                        break;
+                case 'f':
+                        if (!strcmp(optarg, "text"))
+                                format = FORMAT_TEXT;
+                        else if (!strcmp(optarg, "csv"))
+                                format = FORMAT_CSV;
+                        else if (!strcmp(optarg, "json"))
+                                format = FORMAT_JSON;
+                        else
+                                entries = 0;
+                        break;
+                case 'h':
+                        usage(argv[0]);
+                        return EXIT_SUCCESS;
+                default:
+                        usage(argv[0]);
+                        return EXIT_FAILURE;
+                }
+        }
+        if (!topology_count || !ring_size_count || !payload_count || !publish_count || !wait_count
+            || !threads || !entries || (optind < argc)) {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+
+        print_header(format);
+        for (t = 0; t < topology_count; ++t)
+                for (r = 0; r < ring_size_count; ++r)
+                        for (s = 0; s < payload_count; ++s)
+                                for (p = 0; p < publish_count; ++p)
+                                        for (w = 0; w < wait_count; ++w)
+                                                if (!run_benchmark(format, &topologies[topology_list[t]], (unsigned int)threads, ring_size_list[r],
+                                                                   &payload_benchmarks[payload_list[s]], (int)publish_list[p],
+                                                                   (unsigned int)wait_list[w], pin, entries))
+                                                        return EXIT_FAILURE;
+
+        return EXIT_SUCCESS;
+}
@@ -10,36 +10,232 @@
  *  You can use, modify and redistribute it in any way you want.
  */
 
+#ifdef HAVE_CONFIG_H
+    #include "ac_config.h"
+#endif
 #include <unistd.h>
 #include <stdio.h>
 #include <sys/time.h>
+#include <sys/wait.h>
 #include <pthread.h>
-
-#ifdef HAVE_CONFIG_H
-    #include "ac_config.h"
+#if defined __linux__
+    #include <sys/epoll.h>
+    #include <sys/eventfd.h>
+    #include <sys/socket.h>
+    #include <netinet/in.h>
 #endif
+
+#define DISRUPTOR_STATS
 #include "src/disruptor.h"
+#include "src/disruptor_shm.h"
+#include "src/disruptor_record.h"
+#include "src/disruptor_processor.h"
+#include "src/disruptor_journal.h"
+#include "src/disruptor_io.h"
+#include "src/disruptor_sink.h"
+#include "src/disruptor_shard.h"
 
 #define STOP UINT64_MAX
 #define ENTRIES_TO_GENERATE (400)
 #define ENTRY_BUFFER_SIZE (16)
-#define MAX_ENTRY_PROCESSORS (2)
+#define MAX_ENTRY_PROCESSORS (3)
+#define BATCH_SIZE (7) // must be less than ENTRY_BUFFER_SIZE, one less than a power of two
+#define UPSTREAM_MARK (1 << 20) // must be greater than any sequence number
+#define RECORD_BUFFER_SLOTS (32)
+#define RECORD_PUBLISHERS (2)
+#define RECORD_TYPE_STOP (RECORD_PUBLISHERS)
+#define BATCH_PROCESSOR_FAILURE (42)
+#define BATCH_PROCESSOR_SKIP (100) // every such sequence fails
+#define BATCH_PROCESSOR_LAST (300) // the failure that halts
+#define WORKER_POOL_WORKERS (MAX_ENTRY_PROCESSORS)
+#define WORKER_POOL_CHUNK (2)
+#define JOURNAL_SIZE (1024 * 1024)
+#define RING_SET_SHARD_COUNT (4)
+#define RING_SET_PUBLISHERS (2)
+#define RING_SET_KEYS (10)
+#define IO_DATAGRAM_SIZE (32)
+#define IO_DATAGRAMS (100)
 
 DEFINE_ENTRY_TYPE(uint_fast64_t, entry_t);
 DEFINE_RING_BUFFER_TYPE(MAX_ENTRY_PROCESSORS, ENTRY_BUFFER_SIZE, entry_t, ring_buffer_t);
 DEFINE_RING_BUFFER_MALLOC(ring_buffer_t);
 DEFINE_RING_BUFFER_INIT(ENTRY_BUFFER_SIZE, ring_buffer_t);
+DEFINE_RING_BUFFER_SET_WAIT_STRATEGY_FUNCTION(ring_buffer_t);
+DEFINE_RING_BUFFER_SET_EVENTFD_FUNCTION(ring_buffer_t);
 DEFINE_RING_BUFFER_SHOW_ENTRY_FUNCTION(entry_t, ring_buffer_t);
 DEFINE_RING_BUFFER_ACQUIRE_ENTRY_FUNCTION(entry_t, ring_buffer_t);
+DEFINE_RING_BUFFER_SHOW_SPANS_FUNCTION(entry_t, ring_buffer_t);
+DEFINE_RING_BUFFER_ACQUIRE_SPANS_FUNCTION(entry_t, ring_buffer_t);
 DEFINE_ENTRY_PROCESSOR_BARRIER_REGISTER_FUNCTION(ring_buffer_t);
 DEFINE_ENTRY_PROCESSOR_BARRIER_UNREGISTER_FUNCTION(ring_buffer_t);
+DEFINE_ENTRY_PROCESSOR_BARRIER_LAG_FUNCTION(ring_buffer_t);
 DEFINE_ENTRY_PROCESSOR_BARRIER_WAITFOR_BLOCKING_FUNCTION(ring_buffer_t);
+DEFINE_ENTRY_PROCESSOR_BARRIER_WAITFOR_TIMED_FUNCTION(ring_buffer_t);
+DEFINE_ENTRY_PROCESSOR_BARRIER_WAITFOR_DEPENDENCIES_BLOCKING_FUNCTION(ring_buffer_t);
+DEFINE_ENTRY_PROCESSOR_BARRIER_SET_GATING_FUNCTION(ring_buffer_t);
 DEFINE_ENTRY_PROCESSOR_BARRIER_RELEASEENTRY_FUNCTION(ring_buffer_t);
 DEFINE_ENTRY_PUBLISHER_NEXTENTRY_BLOCKING_FUNCTION(ring_buffer_t);
 DEFINE_ENTRY_PUBLISHER_NEXTENTRY_NONBLOCKING_FUNCTION(ring_buffer_t);
+DEFINE_ENTRY_PUBLISHER_NEXTENTRY_TIMED_FUNCTION(ring_buffer_t);
 DEFINE_ENTRY_PUBLISHER_COMMITENTRY_BLOCKING_FUNCTION(ring_buffer_t);
+DEFINE_ENTRY_PUBLISHER_NEXTENTRIES_BLOCKING_FUNCTION(ring_buffer_t);
+DEFINE_ENTRY_PUBLISHER_NEXTENTRIES_NONBLOCKING_FUNCTION(ring_buffer_t);
+DEFINE_ENTRY_PUBLISHER_COMMITENTRIES_BLOCKING_FUNCTION(ring_buffer_t);
+DEFINE_BATCH_PROCESSOR_TYPE(entry_t, ring_buffer_t, batch_processor_t);
+DEFINE_BATCH_PROCESSOR_INIT_FUNCTION(entry_t, ring_buffer_t, batch_processor_t);
+DEFINE_BATCH_PROCESSOR_START_FUNCTION(entry_t, ring_buffer_t, batch_processor_t);
+DEFINE_BATCH_PROCESSOR_HALT_FUNCTION(batch_processor_t);
+DEFINE_BATCH_PROCESSOR_JOIN_FUNCTION(batch_processor_t);
+DEFINE_WORKER_POOL_TYPE(entry_t, ring_buffer_t, worker_pool_t, WORKER_POOL_WORKERS);
+DEFINE_WORKER_POOL_INIT_FUNCTION(entry_t, ring_buffer_t, worker_pool_t);
+DEFINE_WORKER_POOL_START_FUNCTION(entry_t, ring_buffer_t, worker_pool_t);
+DEFINE_WORKER_POOL_HALT_FUNCTION(worker_pool_t);
+DEFINE_WORKER_POOL_JOIN_FUNCTION(worker_pool_t);
+DEFINE_POLLER_TYPE(entry_t, ring_buffer_t, poller_t);
+DEFINE_POLLER_INIT_FUNCTION(entry_t, ring_buffer_t, poller_t);
+DEFINE_POLLER_REGISTER_FUNCTION(poller_t);
+DEFINE_POLLER_UNREGISTER_FUNCTION(poller_t);
+DEFINE_POLLER_POLL_FUNCTION(entry_t, poller_t);
+DEFINE_POLLER_ARM_FUNCTION(poller_t);
+DEFINE_RING_SET_TYPE(ring_buffer_t, ring_set_t, RING_SET_SHARD_COUNT);
+DEFINE_RING_SET_INIT_FUNCTION(ring_buffer_t, ring_set_t);
+DEFINE_RING_SET_SHARD_FUNCTION(ring_buffer_t, ring_set_t);
+DEFINE_RING_SET_ROUTE_FUNCTION(ring_buffer_t, ring_set_t);
+DEFINE_RING_SET_INIT_PROCESSORS_FUNCTION(entry_t, ring_set_t, batch_processor_t);
+DEFINE_RING_SET_START_PROCESSORS_FUNCTION(ring_set_t, batch_processor_t);
+DEFINE_RING_SET_STOP_PROCESSORS_FUNCTION(ring_set_t, batch_processor_t);
+DEFINE_MERGE_PROCESSOR_TYPE(entry_t, ring_buffer_t, merge_processor_t, RING_SET_SHARD_COUNT);
+DEFINE_MERGE_PROCESSOR_INIT_FUNCTION(entry_t, ring_buffer_t, merge_processor_t);
+DEFINE_MERGE_PROCESSOR_START_FUNCTION(entry_t, ring_buffer_t, merge_processor_t);
+DEFINE_MERGE_PROCESSOR_HALT_FUNCTION(merge_processor_t);
+DEFINE_MERGE_PROCESSOR_JOIN_FUNCTION(merge_processor_t);
+DEFINE_JOURNAL_OPEN_FUNCTION(entry_t);
+DEFINE_JOURNAL_ON_ENTRY_FUNCTION(entry_t);
+DEFINE_JOURNAL_REPLAY_FUNCTION(entry_t, ring_buffer_t);
+DEFINE_SHM_RING_BUFFER_CREATE(ring_buffer_t);
+DEFINE_SHM_RING_BUFFER_ATTACH(ring_buffer_t);
+DEFINE_SHM_RING_BUFFER_DETACH(ring_buffer_t);
+DEFINE_SHM_ENTRY_PROCESSOR_BARRIER_REGISTER_FUNCTION(ring_buffer_t);
+DEFINE_SHM_ENTRY_PROCESSOR_BARRIER_UNREGISTER_FUNCTION(ring_buffer_t);
+DEFINE_SHM_RING_BUFFER_REAP_FUNCTION(ring_buffer_t);
+
+DEFINE_IO_CONTENT_TYPE(IO_DATAGRAM_SIZE, io_content_t);
+DEFINE_ENTRY_TYPE(io_content_t, net_entry_t);
+DEFINE_RING_BUFFER_TYPE(MAX_ENTRY_PROCESSORS, ENTRY_BUFFER_SIZE, net_entry_t, net_ring_buffer_t);
+DEFINE_RING_BUFFER_INIT(ENTRY_BUFFER_SIZE, net_ring_buffer_t, net_);
+DEFINE_RING_BUFFER_SHOW_ENTRY_FUNCTION(net_entry_t, net_ring_buffer_t, net_);
+DEFINE_RING_BUFFER_ACQUIRE_ENTRY_FUNCTION(net_entry_t, net_ring_buffer_t, net_);
+DEFINE_RING_BUFFER_ACQUIRE_SPANS_FUNCTION(net_entry_t, net_ring_buffer_t, net_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_REGISTER_FUNCTION(net_ring_buffer_t, net_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_UNREGISTER_FUNCTION(net_ring_buffer_t, net_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_WAITFOR_BLOCKING_FUNCTION(net_ring_buffer_t, net_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_RELEASEENTRY_FUNCTION(net_ring_buffer_t, net_);
+DEFINE_ENTRY_PUBLISHER_NEXTENTRIES_BLOCKING_FUNCTION(net_ring_buffer_t, net_);
+DEFINE_ENTRY_PUBLISHER_COMMITENTRIES_BLOCKING_FUNCTION(net_ring_buffer_t, net_);
+DEFINE_IO_READV_FUNCTION(net_entry_t, net_ring_buffer_t, net_);
+DEFINE_IO_WRITEV_FUNCTION(net_entry_t, net_ring_buffer_t, net_);
+DEFINE_SINK_TYPE(net_entry_t, net_ring_buffer_t, sink_t);
+DEFINE_SINK_INIT_FUNCTION(net_entry_t, net_ring_buffer_t, sink_t, net_);
+DEFINE_SINK_START_FUNCTION(net_entry_t, net_ring_buffer_t, sink_t, net_);
+DEFINE_SINK_HALT_FUNCTION(sink_t, net_);
+DEFINE_SINK_JOIN_FUNCTION(sink_t, net_);
+#if defined __linux__
+DEFINE_IO_RECVMMSG_FUNCTION(net_entry_t, net_ring_buffer_t, net_);
+DEFINE_IO_SENDMMSG_FUNCTION(net_entry_t, net_ring_buffer_t, net_);
+#endif
+
+DEFINE_MP_RING_BUFFER_TYPE(MAX_ENTRY_PROCESSORS, ENTRY_BUFFER_SIZE, entry_t, mp_ring_buffer_t);
+DEFINE_RING_BUFFER_MMAP(mp_ring_buffer_t, mp_);
+DEFINE_RING_BUFFER_INIT(ENTRY_BUFFER_SIZE, mp_ring_buffer_t, mp_);
+DEFINE_RING_BUFFER_SET_WAIT_STRATEGY_FUNCTION(mp_ring_buffer_t, mp_);
+DEFINE_RING_BUFFER_SHOW_ENTRY_FUNCTION(entry_t, mp_ring_buffer_t, mp_);
+DEFINE_RING_BUFFER_ACQUIRE_ENTRY_FUNCTION(entry_t, mp_ring_buffer_t, mp_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_REGISTER_FUNCTION(mp_ring_buffer_t, mp_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_UNREGISTER_FUNCTION(mp_ring_buffer_t, mp_);
+DEFINE_MP_ENTRY_PROCESSOR_BARRIER_WAITFOR_BLOCKING_FUNCTION(mp_ring_buffer_t, mp_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_RELEASEENTRY_FUNCTION(mp_ring_buffer_t, mp_);
+DEFINE_ENTRY_PUBLISHER_NEXTENTRY_BLOCKING_FUNCTION(mp_ring_buffer_t, mp_);
+DEFINE_ENTRY_PUBLISHER_NEXTENTRIES_BLOCKING_FUNCTION(mp_ring_buffer_t, mp_);
+DEFINE_MP_ENTRY_PUBLISHER_COMMITENTRY_BLOCKING_FUNCTION(mp_ring_buffer_t, mp_);
+DEFINE_MP_ENTRY_PUBLISHER_COMMITENTRIES_BLOCKING_FUNCTION(mp_ring_buffer_t, mp_);
+DEFINE_MP_ENTRY_PUBLISHER_COMMITENTRIES_NONBLOCKING_FUNCTION(mp_ring_buffer_t, mp_);
+
+DEFINE_SP_RING_BUFFER_TYPE(MAX_ENTRY_PROCESSORS, ENTRY_BUFFER_SIZE, entry_t, sp_ring_buffer_t);
+DEFINE_RING_BUFFER_INIT(ENTRY_BUFFER_SIZE, sp_ring_buffer_t, sp_);
+DEFINE_RING_BUFFER_SET_WAIT_STRATEGY_FUNCTION(sp_ring_buffer_t, sp_);
+DEFINE_RING_BUFFER_SHOW_ENTRY_FUNCTION(entry_t, sp_ring_buffer_t, sp_);
+DEFINE_RING_BUFFER_ACQUIRE_ENTRY_FUNCTION(entry_t, sp_ring_buffer_t, sp_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_REGISTER_FUNCTION(sp_ring_buffer_t, sp_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_UNREGISTER_FUNCTION(sp_ring_buffer_t, sp_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_WAITFOR_BLOCKING_FUNCTION(sp_ring_buffer_t, sp_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_RELEASEENTRY_FUNCTION(sp_ring_buffer_t, sp_);
+DEFINE_SP_ENTRY_PUBLISHER_NEXTENTRY_BLOCKING_FUNCTION(sp_ring_buffer_t, sp_);
+DEFINE_SP_ENTRY_PUBLISHER_NEXTENTRIES_BLOCKING_FUNCTION(sp_ring_buffer_t, sp_);
+DEFINE_SP_ENTRY_PUBLISHER_COMMITENTRY_BLOCKING_FUNCTION(sp_ring_buffer_t, sp_);
+DEFINE_SP_ENTRY_PUBLISHER_COMMITENTRIES_BLOCKING_FUNCTION(sp_ring_buffer_t, sp_);
+DEFINE_SP_ENTRY_PUBLISHER_COMMITENTRIES_NONBLOCKING_FUNCTION(sp_ring_buffer_t, sp_);
+
+DEFINE_RUNTIME_RING_BUFFER_TYPE(entry_t, rt_ring_buffer_t);
+DEFINE_RUNTIME_RING_BUFFER_MALLOC(entry_t, rt_ring_buffer_t, rt_);
+DEFINE_RUNTIME_RING_BUFFER_MMAP(entry_t, rt_ring_buffer_t, rt_);
+DEFINE_RUNTIME_RING_BUFFER_INIT(entry_t, rt_ring_buffer_t, rt_);
+DEFINE_RING_BUFFER_SET_WAIT_STRATEGY_FUNCTION(rt_ring_buffer_t, rt_);
+DEFINE_RING_BUFFER_SHOW_ENTRY_FUNCTION(entry_t, rt_ring_buffer_t, rt_);
+DEFINE_RING_BUFFER_ACQUIRE_ENTRY_FUNCTION(entry_t, rt_ring_buffer_t, rt_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_REGISTER_FUNCTION(rt_ring_buffer_t, rt_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_UNREGISTER_FUNCTION(rt_ring_buffer_t, rt_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_WAITFOR_BLOCKING_FUNCTION(rt_ring_buffer_t, rt_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_RELEASEENTRY_FUNCTION(rt_ring_buffer_t, rt_);
+DEFINE_ENTRY_PUBLISHER_NEXTENTRY_BLOCKING_FUNCTION(rt_ring_buffer_t, rt_);
+DEFINE_ENTRY_PUBLISHER_NEXTENTRIES_BLOCKING_FUNCTION(rt_ring_buffer_t, rt_);
+DEFINE_ENTRY_PUBLISHER_COMMITENTRY_BLOCKING_FUNCTION(rt_ring_buffer_t, rt_);
+DEFINE_ENTRY_PUBLISHER_COMMITENTRIES_BLOCKING_FUNCTION(rt_ring_buffer_t, rt_);
+
+DEFINE_RECORD_RING_BUFFER_TYPE(MAX_ENTRY_PROCESSORS, RECORD_BUFFER_SLOTS, record_ring_buffer_t);
+DEFINE_RING_BUFFER_INIT(RECORD_BUFFER_SLOTS, record_ring_buffer_t, record_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_REGISTER_FUNCTION(record_ring_buffer_t, record_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_UNREGISTER_FUNCTION(record_ring_buffer_t, record_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_WAITFOR_BLOCKING_FUNCTION(record_ring_buffer_t, record_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_RELEASEENTRY_FUNCTION(record_ring_buffer_t, record_);
+DEFINE_ENTRY_PUBLISHER_COMMITENTRIES_BLOCKING_FUNCTION(record_ring_buffer_t, record_);
+DEFINE_ENTRY_PUBLISHER_NEXTRECORD_BLOCKING_FUNCTION(record_ring_buffer_t, record_);
+DEFINE_ENTRY_PUBLISHER_NEXTRECORD_NONBLOCKING_FUNCTION(record_ring_buffer_t, record_);
+DEFINE_RING_BUFFER_NEXT_RECORD_FUNCTION(record_ring_buffer_t, record_);
 
 struct ring_buffer_t ring_buffer;
+struct mp_ring_buffer_t mp_ring_buffer;
+struct sp_ring_buffer_t sp_ring_buffer;
+struct record_ring_buffer_t record_ring_buffer;
+struct net_ring_buffer_t net_ring_buffer;
+struct sink_t sink;
+static uint32_t record_publishers;
+struct batch_processor_t batch_processor;
+struct worker_pool_t worker_pool;
+static uint32_t worker_seen[ENTRIES_TO_GENERATE + 2];
+static uint32_t worker_entries[WORKER_POOL_WORKERS];
+struct ring_set_t ring_set;
+struct batch_processor_t shard_processors[RING_SET_SHARD_COUNT];
+struct merge_processor_t merge_processor;
+
+/*
+ * The number of entries of each key seen from each publisher, by the
+ * shard processors or the merge processor.
+ */
+struct ring_set_context_t {
+        uint_fast64_t seen[RING_SET_PUBLISHERS][RING_SET_KEYS];
+        uint_fast64_t entries;
+        int misrouted;
+};
+
+struct batch_context_t {
+        uint_fast64_t expected;
+        uint_fast64_t entries;
+        uint_fast64_t batches;
+        uint_fast64_t errors;
+        unsigned int starts;
+        unsigned int shutdowns;
+        int fail;
+};
 
 static int
 create_thread(pthread_t * const thread_id,
@@ -115,6 +311,47 @@ entry_publisher_blocking_thread(void *arg)
         return NULL;
 }
 
+static void*
+entry_publisher_batch_thread(void *arg)
+{
+        struct ring_buffer_t *buffer = (struct ring_buffer_t*)arg;
+        struct cursor_t n;
+        struct cursor_t lo;
+        struct cursor_t hi;
+        struct cursor_t cursor;
+        struct entry_t *entry;
+        uint64_t count;
+        uint64_t reps = ENTRIES_TO_GENERATE;
+
+        do {
+                count = (reps < BATCH_SIZE) ? reps : BATCH_SIZE;
+                if (reps & 1) {
+                        publisher_next_entries_blocking(buffer, count, &lo, &hi);
+                } else {
+                        while (!publisher_next_entries_nonblocking(buffer, count, &lo, &hi))
+                                ;
+                }
+                if (hi.sequence - lo.sequence + 1 != count) {
+                        printf("Batch publisher - ERROR\n");
+                        return NULL;
+                }
+                for (n.sequence = lo.sequence; n.sequence <= hi.sequence; ++n.sequence) {
+                        entry = ring_buffer_acquire_entry(buffer, &n);
+                        entry->content = n.sequence;
+                }
+                publisher_commit_entries_blocking(buffer, &lo, &hi);
+                reps -= count;
+        } while (reps);
+
+        publisher_next_entry_blocking(buffer, &cursor);
+        entry = ring_buffer_acquire_entry(buffer, &cursor);
+        entry->content = STOP;
+        publisher_commit_entry_blocking(buffer, &cursor);
+        printf("Publisher done\n");
+
+        return NULL;
+}
+
 static void*
 entry_processor_thread(void *arg)
 {
@@ -155,87 +392,1796 @@ out:
         return NULL;
 }
 
-int
-main(int argc, char *argv[])
+/*
+ * The first stage of the diamond. Marks every entry as seen and
+ * leaves gating to the entry processor depending on it.
+ */
+static void*
+upstream_entry_processor_thread(void *arg)
 {
-        pthread_t p_1; // entry publisher
-        pthread_t p_2;
-        pthread_t p_3;
-        pthread_t c_1; // entry processor
-        pthread_t c_2;
-        struct ring_buffer_t *ring_buffer_heap;
-        struct ring_buffer_t ring_buffer_stack;
+        struct cursor_t n;
+        struct ring_buffer_t *buffer = (struct ring_buffer_t*)arg;
+        struct cursor_t cursor;
+        struct cursor_t cursor_upper_limit;
+        struct count_t reg_number;
+        struct entry_t *entry;
+        int stop = 0;
 
-        ring_buffer_heap = ring_buffer_malloc();
-        if (!ring_buffer_heap) {
-                printf("Malloc ring buffer - ERROR\n");
-                return EXIT_FAILURE;
+        cursor.sequence = entry_processor_barrier_register(buffer, &reg_number);
+        entry_processor_barrier_set_gating(buffer, &reg_number, 0);
+        cursor_upper_limit.sequence = cursor.sequence;
+
+        do {
+                entry_processor_barrier_wait_for_blocking(buffer, &cursor_upper_limit);
+                for (n.sequence = cursor.sequence; n.sequence <= cursor_upper_limit.sequence; ++n.sequence) {
+                        entry = ring_buffer_acquire_entry(buffer, &n);
+                        if (STOP == entry->content) {
+                                stop = 1;
+                                break;
+                        }
+                        if (entry->content % UPSTREAM_MARK != n.sequence) {
+                                printf("Upstream entry processor - ERROR\n");
+                                goto out;
+                        }
+                        __atomic_add_fetch(&entry->content, UPSTREAM_MARK, __ATOMIC_RELAXED);
+                }
+                entry_processor_barrier_release_entry(buffer, &reg_number, &cursor_upper_limit);
+
+                ++cursor_upper_limit.sequence;
+                cursor.sequence = cursor_upper_limit.sequence;
+        } while (!stop);
+        printf("Upstream entry processor exiting normally\n");
+out:
+        entry_processor_barrier_unregister(buffer, &reg_number);
+        printf("Upstream entry processor done\n");
+
+        return NULL;
+}
+
+/*
+ * The last stage of the diamond. Both upstream entry processors
+ * register first on a fresh ring buffer and thus hold spots 0 (zero)
+ * and 1 (one).
+ */
+static void*
+downstream_entry_processor_thread(void *arg)
+{
+        static const struct count_t upstream[2] = { { 0, { 0 } }, { 1, { 0 } } };
+        struct cursor_t n;
+        struct ring_buffer_t *buffer = (struct ring_buffer_t*)arg;
+        struct cursor_t cursor;
+        struct cursor_t cursor_upper_limit;
+        struct count_t reg_number;
+        const struct entry_t *entry;
+
+        cursor.sequence = entry_processor_barrier_register(buffer, &reg_number);
+        cursor_upper_limit.sequence = cursor.sequence;
+
+        do {
+                entry_processor_barrier_wait_for_dependencies_blocking(buffer, upstream, 2, &cursor_upper_limit);
+                for (n.sequence = cursor.sequence; n.sequence <= cursor_upper_limit.sequence; ++n.sequence) {
+                        entry = ring_buffer_show_entry(buffer, &n);
+                        if (STOP == entry->content) {
+                                printf("Downstream entry processor exiting normally\n");
+                                goto out;
+                        }
+                        if (entry->content != n.sequence + 2 * UPSTREAM_MARK) {
+                                printf("Downstream entry processor - ERROR\n");
+                                goto out;
+                        }
+                }
+                entry_processor_barrier_release_entry(buffer, &reg_number, &cursor_upper_limit);
+
+                ++cursor_upper_limit.sequence;
+                cursor.sequence = cursor_upper_limit.sequence;
+        } while (1);
+out:
+        entry_processor_barrier_unregister(buffer, &reg_number);
+        printf("Downstream entry processor done\n");
+
+        return NULL;
+}
+
+/*
+ * Defines an entry publisher thread and an entry processor thread for
+ * the ring buffer flavour identified by ring_buffer_prefix__. The
+ * publisher alternates between single entries and batches.
+ */
+#define DEFINE_TEST_THREADS(ring_buffer_type_name__, ring_buffer_prefix__)                                               \
+static void*                                                                                                             \
+ring_buffer_prefix__ ## entry_publisher_thread(void *arg)                                                                \
+{                                                                                                                        \
+        struct ring_buffer_type_name__ *buffer = (struct ring_buffer_type_name__*)arg;                                   \
+        struct cursor_t n;                                                                                               \
+        struct cursor_t lo;                                                                                              \
+        struct cursor_t hi;                                                                                              \
+        struct cursor_t cursor;                                                                                          \
+        struct entry_t *entry;                                                                                           \
+        uint64_t count;                                                                                                  \
+        uint64_t reps = ENTRIES_TO_GENERATE;                                                                             \
+                                                                                                                         \
+        do {                                                                                                             \
+                if (reps & 1) {                                                                                          \
+                        ring_buffer_prefix__ ## publisher_next_entry_blocking(buffer, &cursor);                          \
+                        entry = ring_buffer_prefix__ ## ring_buffer_acquire_entry(buffer, &cursor);                      \
+                        entry->content = cursor.sequence;                                                                \
+                        ring_buffer_prefix__ ## publisher_commit_entry_blocking(buffer, &cursor);                        \
+                        --reps;                                                                                          \
+                        continue;                                                                                        \
+                }                                                                                                        \
+                count = (reps < BATCH_SIZE) ? reps : BATCH_SIZE;                                                         \
+                ring_buffer_prefix__ ## publisher_next_entries_blocking(buffer, count, &lo, &hi);                        \
+                for (n.sequence = lo.sequence; n.sequence <= hi.sequence; ++n.sequence) {                                \
+                        entry = ring_buffer_prefix__ ## ring_buffer_acquire_entry(buffer, &n);                           \
+                        entry->content = n.sequence;                                                                     \
+                }                                                                                                        \
+                ring_buffer_prefix__ ## publisher_commit_entries_blocking(buffer, &lo, &hi);                             \
+                reps -= count;                                                                                           \
+        } while (reps);                                                                                                  \
+                                                                                                                         \
+        ring_buffer_prefix__ ## publisher_next_entry_blocking(buffer, &cursor);                                          \
+        entry = ring_buffer_prefix__ ## ring_buffer_acquire_entry(buffer, &cursor);                                      \
+        entry->content = STOP;                                                                                           \
+        ring_buffer_prefix__ ## publisher_commit_entry_blocking(buffer, &cursor);                                        \
+        printf("Publisher done\n");                                                                                      \
+                                                                                                                         \
+        return NULL;                                                                                                     \
+}                                                                                                                        \
+                                                                                                                         \
+static void*                                                                                                             \
+ring_buffer_prefix__ ## entry_processor_thread(void *arg)                                                                \
+{                                                                                                                        \
+        struct cursor_t n;                                                                                               \
+        struct ring_buffer_type_name__ *buffer = (struct ring_buffer_type_name__*)arg;                                   \
+        struct cursor_t cursor;                                                                                          \
+        struct cursor_t cursor_upper_limit;                                                                              \
+        struct count_t reg_number;                                                                                       \
+        const struct entry_t *entry;                                                                                     \
+                                                                                                                         \
+        cursor.sequence = ring_buffer_prefix__ ## entry_processor_barrier_register(buffer, &reg_number);                 \
+        cursor_upper_limit.sequence = cursor.sequence;                                                                   \
+                                                                                                                         \
+        do {                                                                                                             \
+                ring_buffer_prefix__ ## entry_processor_barrier_wait_for_blocking(buffer, &cursor_upper_limit);          \
+                for (n.sequence = cursor.sequence; n.sequence <= cursor_upper_limit.sequence; ++n.sequence) {            \
+                        entry = ring_buffer_prefix__ ## ring_buffer_show_entry(buffer, &n);                              \
+                        if (STOP == entry->content) {                                                                    \
+                                printf("Entry processor exiting normally\n");                                            \
+                                goto out;                                                                                \
+                        }                                                                                                \
+                                                                                                                         \
+                        if (entry->content != n.sequence) {                                                              \
+                                printf("Entry processor - ERROR\n");                                                     \
+                                goto out;                                                                                \
+                        }                                                                                                \
+                }                                                                                                        \
+                ring_buffer_prefix__ ## entry_processor_barrier_release_entry(buffer, &reg_number, &cursor_upper_limit); \
+                                                                                                                         \
+                ++cursor_upper_limit.sequence;                                                                           \
+                cursor.sequence = cursor_upper_limit.sequence;                                                           \
+        } while (1);                                                                                                     \
+out:                                                                                                                     \
+        ring_buffer_prefix__ ## entry_processor_barrier_unregister(buffer, &reg_number);                                 \
+        printf("Entry processor done\n");                                                                                \
+                                                                                                                         \
+        return NULL;                                                                                                     \
+}
+
+DEFINE_TEST_THREADS(mp_ring_buffer_t, mp_);
+DEFINE_TEST_THREADS(sp_ring_buffer_t, sp_);
+DEFINE_TEST_THREADS(rt_ring_buffer_t, rt_);
+
+/*
+ * Publishes ENTRIES_TO_GENERATE records of all lengths from 8 bytes up
+ * to the longest, each holding its number and then bytes counting up
+ * from it, and the type of the record is the number of the entry
+ * publisher.
+ */
+static void*
+record_publisher_thread(void *arg)
+{
+        struct record_ring_buffer_t *buffer = (struct record_ring_buffer_t*)arg;
+        const uint32_t publisher = __atomic_fetch_add(&record_publishers, 1, __ATOMIC_RELAXED);
+        struct cursor_t lo;
+        struct cursor_t hi;
+        uint8_t *payload;
+        uint64_t count;
+        uint32_t length;
+        uint32_t n;
+
+        for (count = 0; count < ENTRIES_TO_GENERATE; ++count) {
+                length = (uint32_t)(8 + count % (RECORD_MAX_LENGTH(RECORD_BUFFER_SLOTS) - 7));
+                if (count & 1) {
+                        while (!(payload = record_publisher_next_record_nonblocking(buffer, length, publisher, &lo, &hi)))
+                                ;
+                } else {
+                        payload = record_publisher_next_record_blocking(buffer, length, publisher, &lo, &hi);
+                }
+                memcpy(payload, &count, sizeof(count));
+                for (n = sizeof(count); n < length; ++n)
+                        payload[n] = (uint8_t)(count + n);
+                record_publisher_commit_entries_blocking(buffer, &lo, &hi);
         }
-        ring_buffer_init(ring_buffer_heap);
-        ring_buffer_init(&ring_buffer_stack);
-        ring_buffer_init(&ring_buffer);
 
-        //
-        // first as a global variable (non-blocking)
-        //
-        create_thread(&c_1, &ring_buffer, entry_processor_thread);
-        create_thread(&c_2, &ring_buffer, entry_processor_thread);
-        sleep(1);
-        create_thread(&p_1, &ring_buffer, entry_publisher_nonblocking_thread);
-        create_thread(&p_2, &ring_buffer, entry_publisher_nonblocking_thread);
-        create_thread(&p_3, &ring_buffer, entry_publisher_nonblocking_thread);
+        record_publisher_next_record_blocking(buffer, 0, RECORD_TYPE_STOP, &lo, &hi);
+        record_publisher_commit_entries_blocking(buffer, &lo, &hi);
+        printf("Publisher done\n");
 
-        // join entry publishers
-        pthread_join(p_1, NULL);
-        pthread_join(p_2, NULL);
-        pthread_join(p_3, NULL);
+        return NULL;
+}
 
-        // join entry processors
-        pthread_join(c_1, NULL);
-        pthread_join(c_2, NULL);
-        printf("As-Global-Variable (non-blocking) test done\n\n");
+/*
+ * Checks the records of every entry publisher, in order, until all
+ * of them have stopped.
+ */
+static void*
+record_processor_thread(void *arg)
+{
+        struct record_ring_buffer_t *buffer = (struct record_ring_buffer_t*)arg;
+        uint64_t next_count[RECORD_PUBLISHERS] = { 0 };
+        const struct record_header_t *record;
+        const uint8_t *payload;
+        struct cursor_t cursor;
+        struct cursor_t cursor_upper_limit;
+        struct count_t reg_number;
+        unsigned int stopped = 0;
+        uint64_t count;
+        uint32_t n;
 
+        cursor.sequence = record_entry_processor_barrier_register(buffer, &reg_number);
+        cursor_upper_limit.sequence = cursor.sequence;
 
-        //
-        // then as a stack variable (blocking)
-        //
-        create_thread(&c_1, &ring_buffer_stack, entry_processor_thread);
-        create_thread(&c_2, &ring_buffer_stack, entry_processor_thread);
-        sleep(1);
-        create_thread(&p_1, &ring_buffer_stack, entry_publisher_blocking_thread);
-        create_thread(&p_2, &ring_buffer_stack, entry_publisher_blocking_thread);
-        create_thread(&p_3, &ring_buffer_stack, entry_publisher_blocking_thread);
+        do {
+                record_entry_processor_barrier_wait_for_blocking(buffer, &cursor_upper_limit);
+                while ((record = record_ring_buffer_next_record(buffer, &cursor, &cursor_upper_limit))) {
+                        if (RECORD_TYPE_STOP == record->type) {
+                                ++stopped;
+                                continue;
+                        }
+                        payload = RECORD_PAYLOAD(record);
+                        memcpy(&count, payload, sizeof(count));
+                        if (record->type >= RECORD_PUBLISHERS || count != next_count[record->type]
+                            || record->length != 8 + count % (RECORD_MAX_LENGTH(RECORD_BUFFER_SLOTS) - 7)) {
+                                printf("Record entry processor - ERROR\n");
+                                goto out;
+                        }
+                        for (n = sizeof(count); n < record->length; ++n) {
+                                if (payload[n] != (uint8_t)(count + n)) {
+                                        printf("Record payload - ERROR\n");
+                                        goto out;
+                                }
+                        }
+                        ++next_count[record->type];
+                }
+                if (cursor.sequence != cursor_upper_limit.sequence + 1)
+                        printf("Record iteration - ERROR\n");
+                record_entry_processor_barrier_release_entry(buffer, &reg_number, &cursor_upper_limit);
 
-        // join entry publishers
-        pthread_join(p_1, NULL);
-        pthread_join(p_2, NULL);
-        pthread_join(p_3, NULL);
+                ++cursor_upper_limit.sequence;
+        } while (stopped < RECORD_PUBLISHERS);
+out:
+        record_entry_processor_barrier_unregister(buffer, &reg_number);
+        printf("Entry processor done\n");
 
-        // join entry processors
-        pthread_join(c_1, NULL);
-        pthread_join(c_2, NULL);
-        printf("As-Global-Variable (blocking) test done\n\n");
+        return NULL;
+}
 
-        //
-        // Now as allocated on the heap (blocking)
-        //
-        create_thread(&c_1, ring_buffer_heap, entry_processor_thread);
-        create_thread(&c_2, ring_buffer_heap, entry_processor_thread);
-        sleep(1);
-        create_thread(&p_1, ring_buffer_heap, entry_publisher_blocking_thread);
-        create_thread(&p_2, ring_buffer_heap, entry_publisher_blocking_thread);
-        create_thread(&p_3, ring_buffer_heap, entry_publisher_blocking_thread);
+/*
+ * Checks that the timed functions give up at the deadline, and only
+ * then, using a single thread and the given wait strategy.
+ */
+static void
+timed_test(struct ring_buffer_t * const buffer,
+           const uint_fast32_t wait_strategy,
+           const char * const test_name)
+{
+        struct count_t reg_number;
+        struct cursor_t cursor;
+        struct cursor_t n;
+        struct timespec deadline;
+        struct disruptor_stats_t before;
+        struct disruptor_stats_t after;
+        uint_fast64_t claimed;
 
-        // join entry publishers
-        pthread_join(p_1, NULL);
-        pthread_join(p_2, NULL);
-        pthread_join(p_3, NULL);
+        disruptor_stats_snapshot(&before);
+        ring_buffer_init(buffer);
+        ring_buffer_set_wait_strategy(buffer, wait_strategy);
+        cursor.sequence = entry_processor_barrier_register(buffer, &reg_number);
 
-        // join entry processors
-        pthread_join(c_1, NULL);
-        pthread_join(c_2, NULL);
-        free(ring_buffer_heap);
-        printf("On-The-Heap (blocking) test done\n");
+        // nothing has been published
+        deadline_after(&deadline, 50000000);
+        if (entry_processor_barrier_wait_for_timed(buffer, &cursor, &deadline))
+                printf("Timed wait for - ERROR\n");
+        if (deadline_remaining(&deadline))
+                printf("Timed wait for returned early - ERROR\n");
+
+        // fill up the ring buffer
+        for (claimed = 0; claimed < ENTRY_BUFFER_SIZE; ++claimed) {
+                deadline_after(&deadline, 50000000);
+                if (!publisher_next_entry_timed(buffer, &n, &deadline)) {
+                        printf("Timed next entry - ERROR\n");
+                        goto out;
+                }
+                ring_buffer_acquire_entry(buffer, &n)->content = n.sequence;
+                publisher_commit_entry_blocking(buffer, &n);
+        }
+
+        // the ring buffer is full and nothing must be claimed
+        deadline_after(&deadline, 50000000);
+        if (publisher_next_entry_timed(buffer, &n, &deadline))
+                printf("Timed next entry on full ring buffer - ERROR\n");
+        if (deadline_remaining(&deadline))
+                printf("Timed next entry returned early - ERROR\n");
+        if (ENTRY_BUFFER_SIZE != buffer->write_cursor.sequence)
+                printf("Timed next entry claimed an entry - ERROR\n");
+        if (ENTRY_BUFFER_SIZE != entry_processor_barrier_lag(buffer, &reg_number))
+                printf("Lag of full ring buffer - ERROR\n");
+
+        // everything published is available at once
+        deadline_after(&deadline, 50000000);
+        if (!entry_processor_barrier_wait_for_timed(buffer, &cursor, &deadline) || ENTRY_BUFFER_SIZE != cursor.sequence)
+                printf("Timed wait for on published entries - ERROR\n");
+
+        // and releasing makes room again
+        entry_processor_barrier_release_entry(buffer, &reg_number, &cursor);
+        if (entry_processor_barrier_lag(buffer, &reg_number))
+                printf("Lag after release - ERROR\n");
+        deadline_after(&deadline, 50000000);
+        if (!publisher_next_entry_timed(buffer, &n, &deadline) || ENTRY_BUFFER_SIZE + 1 != n.sequence)
+                printf("Timed next entry after release - ERROR\n");
+        publisher_commit_entry_blocking(buffer, &n);
+
+        // both time outs were counted, as was the batch of all published entries
+        disruptor_stats_snapshot(&after);
+        if (after.timeouts < before.timeouts + 2)
+                printf("Statistics of time outs - ERROR\n");
+        if (after.empty_waits == before.empty_waits || after.full_waits == before.full_waits)
+                printf("Statistics of waits - ERROR\n");
+        if (after.batches[4] == before.batches[4])
+                printf("Statistics of batches - ERROR\n");
+out:
+        entry_processor_barrier_unregister(buffer, &reg_number);
+        if (entry_processor_barrier_lag(buffer, &reg_number))
+                printf("Lag of unregistered entry processor - ERROR\n");
+        printf("%s test done\n\n", test_name);
+}
+
+/*
+ * Checks that an entry publisher sleeping on a full ring buffer with
+ * the blocking wait strategy is woken up when the only entry
+ * processor unregisters.
+ */
+static __attribute__((noinline)) void
+unregister_test(struct ring_buffer_t * const buffer)
+{
+        struct count_t reg_number;
+        pthread_t p;
+        unsigned int n;
+
+        ring_buffer_init(buffer);
+        ring_buffer_set_wait_strategy(buffer, WAIT_STRATEGY_BLOCKING);
+        entry_processor_barrier_register(buffer, &reg_number);
+        create_thread(&p, buffer, entry_publisher_blocking_thread);
+
+        // wait for the publisher to fall asleep on the full ring buffer
+        for (n = 0; n < 1000 && !__atomic_load_n(&buffer->wait_state.waiters, __ATOMIC_ACQUIRE); ++n)
+                usleep(1000);
+        if (!__atomic_load_n(&buffer->wait_state.waiters, __ATOMIC_ACQUIRE))
+                printf("Publisher not blocked - ERROR\n");
+
+        entry_processor_barrier_unregister(buffer, &reg_number);
+        for (n = 0; n < 1000 && __atomic_load_n(&buffer->max_read_cursor.sequence, __ATOMIC_ACQUIRE) <= ENTRIES_TO_GENERATE; ++n)
+                usleep(1000);
+        if (__atomic_load_n(&buffer->max_read_cursor.sequence, __ATOMIC_ACQUIRE) <= ENTRIES_TO_GENERATE) {
+                printf("Publisher not woken up by unregister - ERROR\n");
+                // wake it up anyway so that the test terminates
+                wait_strategy_wake(&buffer->wait_state);
+        }
+        pthread_join(p, NULL);
+        printf("Unregister test done\n\n");
+}
+
+#if defined __linux__
+/*
+ * Checks that a waiter with the blocking wait strategy goes through
+ * the spin budget and the yield rounds before it sets out to sleep.
+ */
+static __attribute__((noinline)) void
+backoff_test(struct ring_buffer_t * const buffer)
+{
+        struct waiter_t waiter = { 0, 0, 0, NULL };
+        uint_fast64_t spin_count;
+        uint_fast64_t period;
+
+        ring_buffer_init(buffer);
+        ring_buffer_set_wait_strategy(buffer, WAIT_STRATEGY_BLOCKING);
+        spin_count = SPIN_COUNT__(&buffer->wait_strategy, &buffer->wait_state);
+        period = buffer->wait_strategy.yield_spin_count + 1;
+        while (!waiter.sleeping)
+                wait_strategy_wait(&buffer->wait_strategy, &buffer->wait_state, &waiter);
+        if (spin_count + BUILTIN_YIELD_ROUNDS__ * period >= waiter.rounds)
+                printf("Blocking waiter slept after %" PRIuFAST64 " rounds - ERROR\n", waiter.rounds);
+        wait_strategy_done(&buffer->wait_strategy, &buffer->wait_state, &waiter);
+        if (__atomic_load_n(&buffer->wait_state.waiters, __ATOMIC_RELAXED))
+                printf("Blocking waiter left behind - ERROR\n");
+        printf("Back-off test done\n\n");
+}
+#endif
+
+/*
+ * Entry processor of a child process, attached to the ring buffer in
+ * the shared memory referred to by fd. Exits with EXIT_FAILURE on
+ * error. Kept out of line, as it only ever runs in the child.
+ */
+static __attribute__((noinline)) void
+shm_entry_processor_process(const int fd)
+{
+        struct ring_buffer_t *buffer;
+        struct cursor_t n;
+        struct cursor_t cursor;
+        struct cursor_t cursor_upper_limit;
+        struct count_t reg_number;
+        const struct entry_t *entry;
+        int retv = EXIT_FAILURE;
+
+        buffer = ring_buffer_shm_attach(fd);
+        if (!buffer) {
+                printf("Attach to shared ring buffer - ERROR\n");
+                exit(EXIT_FAILURE);
+        }
+        cursor.sequence = entry_processor_barrier_shm_register(buffer, &reg_number);
+        cursor_upper_limit.sequence = cursor.sequence;
+
+        do {
+                entry_processor_barrier_wait_for_blocking(buffer, &cursor_upper_limit);
+                for (n.sequence = cursor.sequence; n.sequence <= cursor_upper_limit.sequence; ++n.sequence) {
+                        entry = ring_buffer_show_entry(buffer, &n);
+                        if (STOP == entry->content) {
+                                retv = EXIT_SUCCESS;
+                                goto out;
+                        }
+                        if (entry->content != n.sequence) {
+                                printf("Shared entry processor - ERROR\n");
+                                goto out;
+                        }
+                }
+                entry_processor_barrier_release_entry(buffer, &reg_number, &cursor_upper_limit);
+
+                ++cursor_upper_limit.sequence;
+                cursor.sequence = cursor_upper_limit.sequence;
+        } while (1);
+out:
+        entry_processor_barrier_shm_unregister(buffer, &reg_number);
+        ring_buffer_shm_detach(buffer);
+        printf("Shared entry processor done\n");
+        exit(retv);
+}
+
+/*
+ * A ring buffer in shared memory with its entry processors in other
+ * processes, one of which dies without unregistering.
+ */
+static void
+shm_test(void)
+{
+        struct ring_buffer_t *buffer;
+        struct ring_buffer_t *attached;
+        struct count_t reg_number;
+        pthread_t p_1;
+        pid_t pid;
+        int status;
+        int fd;
+
+        fd = shared_memory_open_anonymous("correctness");
+        if (-1 == fd) {
+                printf("Open shared memory - ERROR\n");
+                return;
+        }
+        if (ring_buffer_shm_attach(fd) || (EAGAIN != errno))
+                printf("Attach to shared memory without ring buffer - ERROR\n");
+        buffer = ring_buffer_shm_create(fd);
+        if (!buffer) {
+                printf("Create shared ring buffer - ERROR\n");
+                goto out;
+        }
+        ring_buffer_set_wait_strategy(buffer, WAIT_STRATEGY_BLOCKING);
+
+        // creating must not destroy the ring buffer in use
+        if (ring_buffer_shm_create(fd) || (EEXIST != errno))
+                printf("Create shared ring buffer over an existing one - ERROR\n");
+
+        // attaching must fail on another layout
+        ++SHM_HEADER__(buffer)->version;
+        if (ring_buffer_shm_attach(fd) || (EINVAL != errno))
+                printf("Attach to shared ring buffer of another version - ERROR\n");
+        --SHM_HEADER__(buffer)->version;
+
+        // an entry processor dying without unregistering
+        fflush(stdout);
+        pid = fork();
+        if (!pid) {
+                attached = ring_buffer_shm_attach(fd);
+                if (attached)
+                        entry_processor_barrier_shm_register(attached, &reg_number);
+                _exit(attached ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || (EXIT_SUCCESS != WEXITSTATUS(status)))
+                printf("Dying entry processor - ERROR\n");
+        if (1 != ring_buffer_shm_reap(buffer))
+                printf("Reap dead entry processor - ERROR\n");
+
+        // publishing to an entry processor in another process
+        fflush(stdout);
+        pid = fork();
+        if (!pid)
+                shm_entry_processor_process(fd);
+        sleep(1);
+        create_thread(&p_1, buffer, entry_publisher_blocking_thread);
+        pthread_join(p_1, NULL);
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || (EXIT_SUCCESS != WEXITSTATUS(status)))
+                printf("Shared entry processor exit status - ERROR\n");
+        if (ring_buffer_shm_reap(buffer))
+                printf("Reap after clean exit - ERROR\n");
+        ring_buffer_shm_detach(buffer);
+out:
+        close(fd);
+        printf("Shared memory test done\n\n");
+}
+
+static int
+batch_on_entry(const struct entry_t *entry,
+               uint_fast64_t sequence,
+               int end_of_batch,
+               void *context)
+{
+        struct batch_context_t *ctx = (struct batch_context_t*)context;
+
+        if (sequence != ctx->expected++)
+                printf("Batch processor sequence - ERROR\n");
+        if (end_of_batch)
+                ++ctx->batches;
+        if (STOP == entry->content) {
+                if (!end_of_batch)
+                        printf("Batch processor end of batch - ERROR\n");
+                batch_processor_halt(&batch_processor);
+                return 0;
+        }
+        if (entry->content != sequence)
+                printf("Batch processor entry content - ERROR\n");
+        ++ctx->entries;
+
+        return (ctx->fail && !(sequence % BATCH_PROCESSOR_SKIP)) ? BATCH_PROCESSOR_FAILURE : 0;
+}
+
+static int
+batch_on_error(const struct entry_t *entry,
+               uint_fast64_t sequence,
+               int error,
+               void *context)
+{
+        struct batch_context_t *ctx = (struct batch_context_t*)context;
+
+        if ((BATCH_PROCESSOR_FAILURE != error) || (entry->content != sequence))
+                printf("Batch processor error hook - ERROR\n");
+        ++ctx->errors;
+
+        return (BATCH_PROCESSOR_LAST <= sequence);
+}
+
+static void
+batch_on_start(void *context)
+{
+        ++((struct batch_context_t*)context)->starts;
+}
+
+static void
+batch_on_shutdown(void *context)
+{
+        ++((struct batch_context_t*)context)->shutdowns;
+}
+
+/*
+ * A batch processor halted by its handler at the end of the entries
+ * and one halted by a failing entry.
+ */
+static void
+batch_processor_test(void)
+{
+        struct batch_context_t ctx;
+        pthread_t p_1;
+        int fail;
+        int retv;
+
+        for (fail = 0; fail <= 1; ++fail) {
+                memset(&ctx, 0, sizeof(ctx));
+                ctx.expected = 1;
+                ctx.fail = fail;
+
+                ring_buffer_init(&ring_buffer);
+                ring_buffer_set_wait_strategy(&ring_buffer, WAIT_STRATEGY_BLOCKING);
+                batch_processor_init(&batch_processor, &ring_buffer, batch_on_entry, &ctx);
+                batch_processor.on_error = batch_on_error;
+                batch_processor.on_start = batch_on_start;
+                batch_processor.on_shutdown = batch_on_shutdown;
+                batch_processor.cpu = 0;
+                if (!batch_processor_start(&batch_processor)) {
+                        printf("Start batch processor - ERROR\n");
+                        return;
+                }
+                create_thread(&p_1, &ring_buffer, entry_publisher_blocking_thread);
+                pthread_join(p_1, NULL);
+                retv = batch_processor_join(&batch_processor);
+
+                if ((1 != ctx.starts) || (1 != ctx.shutdowns))
+                        printf("Batch processor hooks - ERROR\n");
+                if (!ctx.batches || (ctx.batches > ctx.entries + 1))
+                        printf("Batch processor batches - ERROR\n");
+                if (fail) {
+                        if ((BATCH_PROCESSOR_FAILURE != retv)
+                            || (BATCH_PROCESSOR_LAST != ctx.entries)
+                            || (BATCH_PROCESSOR_LAST / BATCH_PROCESSOR_SKIP != ctx.errors))
+                                printf("Failing batch processor - ERROR\n");
+                } else {
+                        if (retv || (ENTRIES_TO_GENERATE != ctx.entries) || ctx.errors)
+                                printf("Batch processor - ERROR\n");
+                }
+        }
+        printf("Batch processor test done\n\n");
+}
+
+static int
+worker_on_entry(const struct entry_t *entry,
+                uint_fast64_t sequence,
+                unsigned int worker,
+                void *context)
+{
+        const int fail = *(int*)context;
+
+        if (WORKER_POOL_WORKERS <= worker) {
+                printf("Worker index - ERROR\n");
+                return 0;
+        }
+        if (STOP == entry->content) {
+                worker_pool_halt(&worker_pool);
+                return 0;
+        }
+        if ((entry->content != sequence) || (ENTRIES_TO_GENERATE < sequence)) {
+                printf("Worker entry content - ERROR\n");
+                return 0;
+        }
+        __atomic_add_fetch(&worker_seen[sequence], 1, __ATOMIC_RELAXED);
+        ++worker_entries[worker];
+
+        return (fail && (BATCH_PROCESSOR_LAST == sequence)) ? BATCH_PROCESSOR_FAILURE : 0;
+}
+
+/*
+ * A worker pool sharing the entries between its workers, halted at
+ * the end of the entries, and one halted by a failing entry.
+ */
+static void
+worker_pool_test(void)
+{
+        pthread_t p_1;
+        unsigned int n;
+        int fail;
+        int retv;
+
+        for (fail = 0; fail <= 1; ++fail) {
+                memset(worker_seen, 0, sizeof(worker_seen));
+                memset(worker_entries, 0, sizeof(worker_entries));
+
+                ring_buffer_init(&ring_buffer);
+                ring_buffer_set_wait_strategy(&ring_buffer, WAIT_STRATEGY_BLOCKING);
+                worker_pool_init(&worker_pool, &ring_buffer, WORKER_POOL_WORKERS, worker_on_entry, &fail);
+                worker_pool.chunk = WORKER_POOL_CHUNK;
+                if (!worker_pool_start(&worker_pool)) {
+                        printf("Start worker pool - ERROR\n");
+                        return;
+                }
+                create_thread(&p_1, &ring_buffer, entry_publisher_blocking_thread);
+                pthread_join(p_1, NULL);
+                retv = worker_pool_join(&worker_pool);
+
+                if (fail) {
+                        if ((BATCH_PROCESSOR_FAILURE != retv) || (1 != worker_seen[BATCH_PROCESSOR_LAST]))
+                                printf("Failing worker pool - ERROR\n");
+                        continue;
+                }
+                if (retv)
+                        printf("Worker pool - ERROR\n");
+                for (n = 1; n <= ENTRIES_TO_GENERATE; ++n) {
+                        if (1 != worker_seen[n]) {
+                                printf("Worker pool entry %u seen %u times - ERROR\n", n, worker_seen[n]);
+                                break;
+                        }
+                }
+                for (n = 0; n < WORKER_POOL_WORKERS; ++n)
+                        printf("Worker %u handled %u entries\n", n, worker_entries[n]);
+        }
+        printf("Worker pool test done\n\n");
+}
+
+/*
+ * Entry contents of the ring set test, made of the publisher, the key
+ * and the number of the entry among those of the key.
+ */
+#define RING_SET_CONTENT(publisher__, key__, n__) (((uint_fast64_t)(n__) << 16) | ((publisher__) << 8) | (key__))
+#define RING_SET_PUBLISHER(content__) (((content__) >> 8) & 0xff)
+#define RING_SET_KEY(content__) ((content__) & 0xff)
+#define RING_SET_NUMBER(content__) ((content__) >> 16)
+
+static void*
+ring_set_publisher_thread(void *arg)
+{
+        const uint_fast64_t publisher = (uint_fast64_t)(uintptr_t)arg;
+        struct ring_buffer_t *shard;
+        struct cursor_t cursor;
+        uint_fast64_t n;
+
+        for (n = 0; n < ENTRIES_TO_GENERATE; ++n) {
+                shard = ring_set_route(&ring_set, n % RING_SET_KEYS);
+                publisher_next_entry_blocking(shard, &cursor);
+                ring_buffer_acquire_entry(shard, &cursor)->content = RING_SET_CONTENT(publisher, n % RING_SET_KEYS, n / RING_SET_KEYS);
+                publisher_commit_entry_blocking(shard, &cursor);
+        }
+
+        return NULL;
+}
+
+/*
+ * Checks that the entries of each key from each publisher are seen in
+ * order.
+ */
+static void
+ring_set_check(struct ring_set_context_t * const ctx,
+               const uint_fast64_t content)
+{
+        uint_fast64_t * const seen = &ctx->seen[RING_SET_PUBLISHER(content)][RING_SET_KEY(content)];
+
+        if (RING_SET_NUMBER(content) != (*seen)++)
+                printf("Ring set order - ERROR\n");
+        ++ctx->entries;
+}
+
+static int
+shard_on_entry(const struct entry_t *entry,
+               uint_fast64_t sequence,
+               int end_of_batch,
+               void *context)
+{
+        (void)sequence;
+        (void)end_of_batch;
+        ring_set_check((struct ring_set_context_t*)context, entry->content);
+
+        return 0;
+}
+
+static int
+merge_on_entry(const struct entry_t *entry,
+               unsigned int ring_buffer,
+               uint_fast64_t sequence,
+               void *context)
+{
+        struct ring_set_context_t * const ctx = (struct ring_set_context_t*)context;
+
+        (void)sequence;
+        if (ring_set_shard(&ring_set, RING_SET_KEY(entry->content)) != ring_buffer)
+                ctx->misrouted = 1;
+        ring_set_check(ctx, entry->content);
+
+        return 0;
+}
+
+/*
+ * Entry publishers spread over the shards of a ring set by key, each
+ * shard processed by a batch processor of its own and all shards
+ * merged by a merge processor, which sleeps on event_fd unless it is
+ * negative.
+ */
+static void
+ring_set_test(const int event_fd)
+{
+        static struct ring_set_context_t shard_ctx[RING_SET_SHARD_COUNT];
+        static struct ring_set_context_t merge_ctx;
+        uint_fast64_t entries = 0;
+        unsigned int used[RING_SET_SHARD_COUNT] = { 0 };
+        pthread_t p[RING_SET_PUBLISHERS];
+        uint_fast64_t key;
+        unsigned int n;
+        unsigned int shard;
+
+        for (key = 0; key < 1000; ++key) {
+                shard = ring_set_shard(&ring_set, key);
+                if ((RING_SET_SHARD_COUNT <= shard) || (&ring_set.shards[shard] != ring_set_route(&ring_set, key))) {
+                        printf("Ring set shard - ERROR\n");
+                        return;
+                }
+                ++used[shard];
+        }
+        for (n = 0; n < RING_SET_SHARD_COUNT; ++n) {
+                if (!used[n])
+                        printf("Ring set spread - ERROR\n");
+        }
+
+        memset(&shard_ctx, 0, sizeof(shard_ctx));
+        memset(&merge_ctx, 0, sizeof(merge_ctx));
+        ring_set_init(&ring_set);
+        for (n = 0; (0 <= event_fd) && (n < RING_SET_SHARD_COUNT); ++n)
+                ring_buffer_set_eventfd(&ring_set.shards[n], event_fd);
+        ring_set_init_processors(&ring_set, shard_processors, shard_on_entry, NULL);
+        for (n = 0; n < RING_SET_SHARD_COUNT; ++n)
+                shard_processors[n].context = &shard_ctx[n];
+        if (!ring_set_start_processors(&ring_set, shard_processors)) {
+                printf("Start shard processors - ERROR\n");
+                return;
+        }
+        if (merge_processor_init(&merge_processor, ring_set.shards, 0, merge_on_entry, &merge_ctx)
+            || merge_processor_init(&merge_processor, ring_set.shards, RING_SET_SHARD_COUNT + 1, merge_on_entry, &merge_ctx)
+            || !merge_processor_init(&merge_processor, ring_set.shards, RING_SET_SHARD_COUNT, merge_on_entry, &merge_ctx))
+                printf("Merge processor count - ERROR\n");
+        merge_processor.max_batch = BATCH_SIZE;
+        merge_processor.event_fd = event_fd;
+        if (!merge_processor_start(&merge_processor)) {
+                printf("Start merge processor - ERROR\n");
+                ring_set_stop_processors(&ring_set, shard_processors);
+                return;
+        }
+        for (n = 0; n < RING_SET_PUBLISHERS; ++n)
+                create_thread(&p[n], (void*)(uintptr_t)n, ring_set_publisher_thread);
+        for (n = 0; n < RING_SET_PUBLISHERS; ++n)
+                pthread_join(p[n], NULL);
+
+        if (ring_set_stop_processors(&ring_set, shard_processors))
+                printf("Stop shard processors - ERROR\n");
+        for (n = 0; n < RING_SET_SHARD_COUNT; ++n)
+                entries += shard_ctx[n].entries;
+        if (RING_SET_PUBLISHERS * ENTRIES_TO_GENERATE != entries)
+                printf("Shard processors - ERROR\n");
+        merge_processor_halt(&merge_processor);
+        if (merge_processor_join(&merge_processor)
+            || merge_ctx.misrouted
+            || (RING_SET_PUBLISHERS * ENTRIES_TO_GENERATE != merge_ctx.entries))
+                printf("Merge processor - ERROR\n");
+        printf("Ring set test done\n\n");
+}
+
+#if defined __linux__
+/*
+ * The ring set test with the merge processor sleeping on an eventfd
+ * of all shards.
+ */
+static void
+ring_set_eventfd_test(void)
+{
+        const int event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        if (-1 == event_fd) {
+                printf("Create eventfd - ERROR\n");
+                return;
+        }
+        ring_set_test(event_fd);
+        close(event_fd);
+}
+#endif
+
+#if defined __linux__
+static int
+poller_on_entry(const struct entry_t *entry,
+                uint_fast64_t sequence,
+                int end_of_batch,
+                void *context)
+{
+        uint_fast64_t *expected = (uint_fast64_t*)context;
+
+        (void)end_of_batch;
+        if (sequence != (*expected)++)
+                printf("Poller sequence - ERROR\n");
+        if ((STOP != entry->content) && (entry->content != sequence))
+                printf("Poller entry content - ERROR\n");
+
+        return (STOP == entry->content);
+}
+
+/*
+ * A poller in an epoll event loop, woken up through an eventfd by the
+ * entry publisher.
+ */
+static void
+poller_test(void)
+{
+        struct poller_t poller;
+        struct poller_t other;
+        struct cursor_t cursor;
+        struct epoll_event event;
+        uint_fast64_t expected = 1;
+        uint_fast64_t other_expected;
+        uint_fast64_t count;
+        uint_fast64_t total = 0;
+        uint64_t value;
+        unsigned int sleeps = 0;
+        pthread_t p_1;
+        int event_fd;
+        int epoll_fd;
+
+        event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if ((-1 == event_fd) || (-1 == epoll_fd)) {
+                printf("Create eventfd and epoll - ERROR\n");
+                return;
+        }
+        event.events = EPOLLIN;
+        event.data.fd = event_fd;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, event_fd, &event)) {
+                printf("Add eventfd to epoll - ERROR\n");
+                goto out;
+        }
+
+        ring_buffer_init(&ring_buffer);
+        ring_buffer_set_eventfd(&ring_buffer, event_fd);
+        poller_init(&poller, &ring_buffer, poller_on_entry, &expected);
+        poller_register(&poller);
+
+        // idle, then gating on a claimed entry, then processing it
+        if ((POLLER_IDLE != poller_poll(&poller, &count)) || count)
+                printf("Idle poller - ERROR\n");
+        publisher_next_entry_blocking(&ring_buffer, &cursor);
+        ring_buffer_acquire_entry(&ring_buffer, &cursor)->content = cursor.sequence;
+        if (POLLER_GATING != poller_poll(&poller, &count))
+                printf("Gating poller - ERROR\n");
+        if (!poller_arm(&poller))
+                printf("Arm poller - ERROR\n");
+        publisher_commit_entry_blocking(&ring_buffer, &cursor);
+        if ((sizeof(value) != read(event_fd, &value, sizeof(value))) || (1 != value))
+                printf("Eventfd not signalled - ERROR\n");
+        publisher_next_entry_blocking(&ring_buffer, &cursor);
+        ring_buffer_acquire_entry(&ring_buffer, &cursor)->content = cursor.sequence;
+        publisher_commit_entry_blocking(&ring_buffer, &cursor);
+        if (sizeof(value) == read(event_fd, &value, sizeof(value)))
+                printf("Eventfd signalled without armed poller - ERROR\n");
+        if (poller_arm(&poller))
+                printf("Arm poller with entries - ERROR\n");
+        poller.max_batch = 1;
+        if ((POLLER_PROCESSING != poller_poll(&poller, &count)) || (1 != count))
+                printf("Processing poller - ERROR\n");
+        poller.max_batch = 0;
+        if ((POLLER_PROCESSING != poller_poll(&poller, &count)) || (1 != count))
+                printf("Processing poller - ERROR\n");
+        read(event_fd, &value, sizeof(value));
+
+        // two armed pollers, signalled once each
+        poller_init(&other, &ring_buffer, poller_on_entry, &other_expected);
+        poller_register(&other);
+        other_expected = other.cursor.sequence;
+        poller_poll(&other, &count);
+        if (!poller_arm(&poller) || !poller_arm(&other))
+                printf("Arm pollers - ERROR\n");
+        publisher_next_entry_blocking(&ring_buffer, &cursor);
+        ring_buffer_acquire_entry(&ring_buffer, &cursor)->content = cursor.sequence;
+        publisher_commit_entry_blocking(&ring_buffer, &cursor);
+        if ((sizeof(value) != read(event_fd, &value, sizeof(value))) || (2 != value))
+                printf("Eventfd not signalled per armed poller - ERROR\n");
+        poller_unregister(&other);
+        if ((POLLER_PROCESSING != poller_poll(&poller, &count)) || (1 != count))
+                printf("Processing poller - ERROR\n");
+
+        // an event loop
+        create_thread(&p_1, &ring_buffer, entry_publisher_blocking_thread);
+        do {
+                switch (poller_poll(&poller, &count)) {
+                case POLLER_PROCESSING:
+                        total += count;
+                        break;
+                case POLLER_IDLE:
+                        if (!poller_arm(&poller))
+                                break;
+                        if (1 != epoll_wait(epoll_fd, &event, 1, 10 * 1000)) {
+                                printf("Poller wake up - ERROR\n");
+                                expected = STOP;
+                                break;
+                        }
+                        read(event_fd, &value, sizeof(value));
+                        ++sleeps;
+                        break;
+                default:
+                        sched_yield();
+                        break;
+                }
+        } while (expected < ENTRIES_TO_GENERATE + 5);
+        pthread_join(p_1, NULL);
+        poller_unregister(&poller);
+        ring_buffer_set_eventfd(&ring_buffer, -1);
+
+        if (ENTRIES_TO_GENERATE + 1 != total)
+                printf("Poller entries - ERROR\n");
+        printf("Poller slept %u times\n", sleeps);
+out:
+        close(epoll_fd);
+        close(event_fd);
+        printf("Poller test done\n\n");
+}
+#endif
+
+#if defined __linux__
+/*
+ * Fills data with datagram number n, of a length of its own. Returns
+ * the length.
+ */
+static unsigned int
+io_datagram(uint8_t *data,
+            const uint_fast64_t n)
+{
+        const unsigned int length = 1 + n % IO_DATAGRAM_SIZE;
+        unsigned int k;
+
+        for (k = 0; k < length; ++k)
+                data[k] = (uint8_t)(n + k);
+
+        return length;
+}
+
+struct io_relay_t {
+        struct count_t reg_number;
+        struct cursor_t cursor;
+        uint_fast64_t entries; // to relay
+        int pipe_fd;
+        int socket_fd;
+        int error;
+};
+
+/*
+ * Writes the entries to a pipe and sends them on a socket.
+ */
+static void*
+io_relay_thread(void *arg)
+{
+        struct io_relay_t * const relay = (struct io_relay_t*)arg;
+        struct cursor_t lo;
+        struct cursor_t hi;
+        struct cursor_t n;
+
+        lo.sequence = relay->cursor.sequence;
+        while (relay->entries) {
+                hi.sequence = lo.sequence;
+                net_entry_processor_barrier_wait_for_blocking(&net_ring_buffer, &hi);
+                if (net_io_writev(&net_ring_buffer, relay->pipe_fd, &lo, &hi)
+                    || net_io_sendmmsg(&net_ring_buffer, relay->socket_fd, &lo, &hi, 0))
+                        relay->error = 1;
+                for (n.sequence = lo.sequence; n.sequence <= hi.sequence; ++n.sequence) {
+                        if (net_ring_buffer_show_entry(&net_ring_buffer, &n)->content.length)
+                                --relay->entries;
+                }
+                net_entry_processor_barrier_release_entry(&net_ring_buffer, &relay->reg_number, &hi);
+                lo.sequence = hi.sequence + 1;
+        }
+        net_entry_processor_barrier_unregister(&net_ring_buffer, &relay->reg_number);
+
+        return NULL;
+}
+
+/*
+ * Reads what the relay wrote to the pipe and sent on the socket and
+ * compares it with the datagrams in data.
+ */
+static int
+io_relayed(const int pipe_fd,
+           const int socket_fd,
+           const uint8_t *data,
+           const unsigned int *lengths,
+           const unsigned int count)
+{
+        uint8_t buf[IO_DATAGRAM_SIZE * BATCH_SIZE];
+        size_t size = 0;
+        size_t offset;
+        ssize_t retv;
+        unsigned int n;
+
+        for (n = 0; n < count; ++n)
+                size += lengths[n];
+        for (offset = 0; offset < size; offset += (size_t)retv) {
+                retv = read(pipe_fd, buf + offset, size - offset);
+                if (0 >= retv)
+                        return 0;
+        }
+        if (memcmp(buf, data, size))
+                return 0;
+        for (n = 0, offset = 0; n < count; offset += lengths[n++]) {
+                if ((lengths[n] != recv(socket_fd, buf, sizeof(buf), 0))
+                    || memcmp(buf, data + offset, lengths[n]))
+                        return 0;
+        }
+        return 1;
+}
+
+/*
+ * Datagrams received from a socket pair and from loopback UDP, and a
+ * stream read from a pipe, straight into the entries. A relay writes
+ * the entries to another pipe and sends them back over loopback UDP.
+ */
+static void
+io_test(void)
+{
+        uint8_t data[IO_DATAGRAM_SIZE * BATCH_SIZE];
+        unsigned int lengths[BATCH_SIZE];
+        struct sockaddr_in addr[2];
+        socklen_t addr_len;
+        struct io_relay_t relay;
+        pthread_t r_1;
+        uint_fast64_t claimed;
+        uint_fast64_t first;
+        unsigned int round;
+        unsigned int count;
+        unsigned int n;
+        size_t offset;
+        int pair[2] = { -1, -1 };
+        int fds[2] = { -1, -1 };
+        int stream[2] = { -1, -1 };
+        int udp[2] = { -1, -1 };
+        int retv;
+
+        if (socketpair(AF_UNIX, SOCK_DGRAM, 0, pair) || pipe(fds) || pipe(stream)) {
+                printf("Create file descriptors - ERROR\n");
+                goto out;
+        }
+        for (n = 0; n < 2; ++n) {
+                memset(&addr[n], 0, sizeof(addr[n]));
+                addr[n].sin_family = AF_INET;
+                addr[n].sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+                addr_len = sizeof(addr[n]);
+                if ((0 > (udp[n] = socket(AF_INET, SOCK_DGRAM, 0)))
+                    || bind(udp[n], (struct sockaddr*)&addr[n], sizeof(addr[n]))
+                    || getsockname(udp[n], (struct sockaddr*)&addr[n], &addr_len)) {
+                        printf("Create UDP sockets - ERROR\n");
+                        goto out;
+                }
+        }
+        if (connect(udp[0], (struct sockaddr*)&addr[1], sizeof(addr[1]))
+            || connect(udp[1], (struct sockaddr*)&addr[0], sizeof(addr[0]))) {
+                printf("Connect UDP sockets - ERROR\n");
+                goto out;
+        }
+
+        net_ring_buffer_init(&net_ring_buffer);
+        memset(&relay, 0, sizeof(relay));
+        relay.cursor.sequence = net_entry_processor_barrier_register(&net_ring_buffer, &relay.reg_number);
+        relay.entries = IO_DATAGRAMS + 4;
+        relay.pipe_fd = fds[1];
+        relay.socket_fd = udp[0];
+
+        // nothing received, the claimed entries are given back
+        claimed = net_ring_buffer.write_cursor.sequence;
+        if ((-1 != net_io_recvmmsg(&net_ring_buffer, pair[1], BATCH_SIZE, MSG_DONTWAIT))
+            || (EAGAIN != errno)
+            || (claimed != net_ring_buffer.write_cursor.sequence)) {
+                printf("Receive nothing - ERROR\n");
+                goto out;
+        }
+        if (!create_thread(&r_1, &relay, io_relay_thread)) {
+                printf("Create relay - ERROR\n");
+                goto out;
+        }
+
+        // fewer datagrams than asked for, every other round over UDP
+        for (first = 0, round = 0; first < IO_DATAGRAMS; ++round, first += count) {
+                count = 1 + round % BATCH_SIZE;
+                if (IO_DATAGRAMS - first < count)
+                        count = IO_DATAGRAMS - first;
+                for (n = 0, offset = 0; n < count; offset += lengths[n++]) {
+                        lengths[n] = io_datagram(data + offset, first + n);
+                        if (lengths[n] != send((round & 1) ? udp[1] : pair[0], data + offset, lengths[n], 0))
+                                printf("Send datagram - ERROR\n");
+                }
+                for (n = 0; n < count; n += (unsigned int)retv) {
+                        retv = net_io_recvmmsg(&net_ring_buffer, (round & 1) ? udp[0] : pair[1], BATCH_SIZE, MSG_WAITFORONE);
+                        if ((0 >= retv) || (net_ring_buffer.write_cursor.sequence != net_ring_buffer.max_read_cursor.sequence))
+                                break;
+                }
+                if ((count != n) || !io_relayed(fds[0], udp[1], data, lengths, count)) {
+                        printf("Relay datagrams - ERROR\n");
+                        break;
+                }
+        }
+
+        // a stream filling the entries, the last one partially
+        for (n = 0; n < 4 * IO_DATAGRAM_SIZE; ++n)
+                data[n] = (uint8_t)n;
+        for (n = 0; n < 4; ++n)
+                lengths[n] = (3 == n) ? IO_DATAGRAM_SIZE / 2 : IO_DATAGRAM_SIZE;
+        offset = 3 * IO_DATAGRAM_SIZE + IO_DATAGRAM_SIZE / 2;
+        if (offset != write(stream[1], data, offset))
+                printf("Write stream - ERROR\n");
+        if ((4 != net_io_readv(&net_ring_buffer, stream[0], BATCH_SIZE))
+            || (net_ring_buffer.write_cursor.sequence != net_ring_buffer.max_read_cursor.sequence)
+            || !io_relayed(fds[0], udp[1], data, lengths, 4))
+                printf("Read stream - ERROR\n");
+
+        // end of file
+        close(stream[1]);
+        stream[1] = -1;
+        claimed = net_ring_buffer.write_cursor.sequence;
+        if (net_io_readv(&net_ring_buffer, stream[0], BATCH_SIZE) || (claimed != net_ring_buffer.write_cursor.sequence))
+                printf("Read end of file - ERROR\n");
+
+        pthread_join(r_1, NULL);
+        if (relay.error || relay.entries)
+                printf("Relay - ERROR\n");
+out:
+        for (n = 0; n < 2; ++n) {
+                if (-1 != pair[n])
+                        close(pair[n]);
+                if (-1 != fds[n])
+                        close(fds[n]);
+                if (-1 != stream[n])
+                        close(stream[n]);
+                if (-1 != udp[n])
+                        close(udp[n]);
+        }
+        printf("I/O test done\n\n");
+}
+
+/*
+ * Publishes count datagrams, numbered from first, of which every
+ * tenth is empty.
+ */
+static void
+sink_publish(const uint_fast64_t first,
+             const uint_fast64_t count)
+{
+        struct net_entry_t *entry;
+        struct cursor_t lo;
+        struct cursor_t hi;
+        uint_fast64_t n;
+
+        for (n = first; n < first + count; ++n) {
+                net_publisher_next_entries_blocking(&net_ring_buffer, 1, &lo, &hi);
+                entry = net_ring_buffer_acquire_entry(&net_ring_buffer, &lo);
+                entry->content.length = (n % 10) ? io_datagram(entry->content.data, n) : 0;
+                net_publisher_commit_entries_blocking(&net_ring_buffer, &lo, &hi);
+        }
+}
+
+/*
+ * A sink writing datagrams to a file in batches, and one failing to
+ * write to the read end of a pipe.
+ */
+static void
+sink_test(void)
+{
+        char path[] = "/tmp/disruptor-sink-XXXXXX";
+        uint8_t data[IO_DATAGRAM_SIZE];
+        uint8_t buf[IO_DATAGRAM_SIZE];
+        struct sink_queue_t queue;
+        struct sink_batch_t *batch;
+        unsigned int length;
+        uint_fast64_t n;
+        off_t offset;
+        int fds[2];
+        int fd;
+        int retv;
+
+        fd = mkstemp(path);
+        if (-1 == fd) {
+                printf("Create sink file - ERROR\n");
+                return;
+        }
+        net_ring_buffer_init(&net_ring_buffer);
+        net_sink_init(&sink, &net_ring_buffer, fd, 0);
+        sink.max_batch = BATCH_SIZE;
+        if (!net_sink_start(&sink)) {
+                printf("Start sink - ERROR\n");
+                goto out;
+        }
+        sink_publish(0, ENTRIES_TO_GENERATE);
+        net_sink_halt(&sink);
+        retv = net_sink_join(&sink);
+        if (retv)
+                printf("Sink - ERROR\n");
+        for (n = 0, offset = 0; n < ENTRIES_TO_GENERATE; ++n) {
+                if (!(n % 10))
+                        continue;
+                length = io_datagram(data, n);
+                if ((length != pread(fd, buf, length, offset)) || memcmp(data, buf, length)) {
+                        printf("Sunk entries - ERROR\n");
+                        break;
+                }
+                offset += length;
+        }
+        if ((offset != sink.offset) || (offset != lseek(fd, 0, SEEK_END)))
+                printf("Sunk file - ERROR\n");
+
+        // a failing write
+        if (pipe(fds)) {
+                printf("Create pipe - ERROR\n");
+                goto out;
+        }
+        net_sink_init(&sink, &net_ring_buffer, fds[0], SINK_STREAM);
+        if (!net_sink_start(&sink)) {
+                printf("Start failing sink - ERROR\n");
+        } else {
+                sink_publish(1, BATCH_SIZE);
+                net_sink_halt(&sink);
+                if (EBADF != net_sink_join(&sink))
+                        printf("Failing sink - ERROR\n");
+        }
+
+        // a failed batch is not retired, nor any batch after it
+        if (sink_queue_open(&queue, 4)) {
+                printf("Open sink queue - ERROR\n");
+        } else {
+                for (n = 1; n <= 3; ++n) {
+                        batch = &queue.batches[queue.count++];
+                        batch->hi = n;
+                        batch->offset = SINK_STREAM;
+                        batch->iov[0].iov_base = data;
+                        batch->iov[0].iov_len = 1;
+                        batch->next = batch->iov;
+                        batch->iovcnt = 1;
+                        batch->done = 0;
+                        batch->failed = 0;
+                        sink_queue_submit(&queue, batch, (2 == n) ? fds[0] : fds[1]);
+                }
+                while (!sink_queue_settled(&queue))
+                        sink_queue_reap(&queue, fds[1], 1);
+                if ((EBADF != queue.error) || (1 != sink_queue_retire(&queue)) || (2 != queue.count))
+                        printf("Failed sink batch - ERROR\n");
+                sink_queue_close(&queue);
+        }
+        close(fds[0]);
+        close(fds[1]);
+out:
+        close(fd);
+        unlink(path);
+        printf("Sink test done\n\n");
+}
+#endif
+
+static int
+journal_test_on_entry(const struct entry_t *entry,
+                      uint_fast64_t sequence,
+                      int end_of_batch,
+                      void *context)
+{
+        if (STOP == entry->content)
+                batch_processor_halt(&batch_processor);
+
+        return journal_on_entry(entry, sequence, end_of_batch, context);
+}
+
+/*
+ * A batch processor journaling the entries, a torn batch at the end
+ * of the journal and the entries replayed into a fresh ring buffer.
+ */
+static void
+journal_test(void)
+{
+        char path[] = "/tmp/disruptor-journal-XXXXXX";
+        struct journal_t journal;
+        struct journal_batch_t torn;
+        uint_fast64_t count;
+        pthread_t p_1;
+        pthread_t c_1;
+        off_t offset;
+        int fd;
+        int retv;
+
+        fd = mkstemp(path);
+        if (-1 == fd) {
+                printf("Create journal file - ERROR\n");
+                return;
+        }
+        close(fd);
+        if (journal_open(&journal, path, JOURNAL_SIZE) || journal.entries) {
+                printf("Open journal - ERROR\n");
+                goto out;
+        }
+
+        // journaling
+        ring_buffer_init(&ring_buffer);
+        ring_buffer_set_wait_strategy(&ring_buffer, WAIT_STRATEGY_BLOCKING);
+        batch_processor_init(&batch_processor, &ring_buffer, journal_test_on_entry, &journal);
+        if (!batch_processor_start(&batch_processor)) {
+                printf("Start journaling batch processor - ERROR\n");
+                journal_close(&journal);
+                goto out;
+        }
+        create_thread(&p_1, &ring_buffer, entry_publisher_blocking_thread);
+        pthread_join(p_1, NULL);
+        retv = batch_processor_join(&batch_processor);
+        if (retv || (ENTRIES_TO_GENERATE + 1 != journal.entries))
+                printf("Journaling - ERROR\n");
+
+        // a batch torn by a crash is dropped
+        offset = journal.offset;
+        memset(&torn, 0, sizeof(torn));
+        torn.magic = JOURNAL_MAGIC;
+        torn.count = 3;
+        if (sizeof(torn) != pwrite(journal.fd, &torn, sizeof(torn), offset))
+                printf("Tear journal - ERROR\n");
+        journal_close(&journal);
+        if (journal_open(&journal, path, JOURNAL_SIZE)
+            || (ENTRIES_TO_GENERATE + 1 != journal.entries)
+            || (offset != journal.offset)) {
+                printf("Reopen journal - ERROR\n");
+                goto out;
+        }
+
+        // replaying
+        ring_buffer_init(&ring_buffer);
+        create_thread(&c_1, &ring_buffer, entry_processor_thread);
+        sleep(1);
+        if (journal_replay(&journal, &ring_buffer, &count) || (ENTRIES_TO_GENERATE + 1 != count))
+                printf("Replay journal - ERROR\n");
+        pthread_join(c_1, NULL);
+
+        // a replay cut short counts the entries it published all the same
+        if ((sizeof(torn) != pread(journal.fd, &torn, sizeof(torn), 0))
+            || ftruncate(journal.fd, (off_t)(sizeof(torn) + sizeof(struct entry_t)))) {
+                printf("Cut journal - ERROR\n");
+        } else {
+                ring_buffer_init(&ring_buffer);
+                if ((EIO != journal_replay(&journal, &ring_buffer, &count))
+                    || (((ENTRY_BUFFER_SIZE - 1 < torn.count) ? ENTRY_BUFFER_SIZE - 1 : torn.count) != count))
+                        printf("Cut replay - ERROR\n");
+        }
+        journal_close(&journal);
+out:
+        unlink(path);
+        printf("Journal test done\n\n");
+}
+
+/*
+ * Spans of entries published in batches that wrap around the end of
+ * the ring buffer every now and then.
+ */
+static void
+spans_test(void)
+{
+        struct entry_t *spans[2];
+        const struct entry_t *shown[2];
+        uint_fast64_t counts[2];
+        uint_fast64_t shown_counts[2];
+        struct cursor_t lo;
+        struct cursor_t hi;
+        struct count_t reg_number;
+        uint_fast64_t expected;
+        uint_fast64_t content;
+        uint_fast64_t n;
+        unsigned int k;
+        unsigned int m;
+
+        ring_buffer_init(&ring_buffer);
+        expected = entry_processor_barrier_register(&ring_buffer, &reg_number);
+        for (n = 0; n < ENTRIES_TO_GENERATE; ++n) {
+                publisher_next_entries_blocking(&ring_buffer, 1 + n % BATCH_SIZE, &lo, &hi);
+                k = ring_buffer_acquire_spans(&ring_buffer, &lo, &hi, spans, counts);
+                if ((k != 1 + ((ring_buffer.reduced_size.count & lo.sequence) > (ring_buffer.reduced_size.count & hi.sequence)))
+                    || (counts[0] + ((2 == k) ? counts[1] : 0) != hi.sequence - lo.sequence + 1)
+                    || (spans[0] != ring_buffer_acquire_entry(&ring_buffer, &lo))) {
+                        printf("Acquire spans - ERROR\n");
+                        return;
+                }
+                for (m = 0, content = lo.sequence; m < k; ++m) {
+                        while (counts[m]--)
+                                (spans[m]++)->content = content++;
+                }
+                publisher_commit_entries_blocking(&ring_buffer, &lo, &hi);
+
+                lo.sequence = expected;
+                k = ring_buffer_show_spans(&ring_buffer, &lo, &hi, shown, shown_counts);
+                for (m = 0; m < k; ++m) {
+                        while (shown_counts[m]--) {
+                                if ((shown[m]++)->content != expected++)
+                                        printf("Show spans - ERROR\n");
+                        }
+                }
+                entry_processor_barrier_release_entry(&ring_buffer, &reg_number, &hi);
+        }
+        entry_processor_barrier_unregister(&ring_buffer, &reg_number);
+        printf("Spans test done\n\n");
+}
+
+/*
+ * Runs two entry processors and publishers__ entry publishers on the
+ * ring buffer using the given wait strategy.
+ */
+#define RUN_TEST(ring_buffer__, ring_buffer_prefix__, publishers__, wait_strategy__, test_name__)              \
+        do {                                                                                                   \
+                unsigned int n_;                                                                               \
+                pthread_t p_[publishers__];                                                                    \
+                pthread_t c_1_;                                                                                \
+                pthread_t c_2_;                                                                                \
+                                                                                                               \
+                ring_buffer_prefix__ ## ring_buffer_init(ring_buffer__);                                       \
+                ring_buffer_prefix__ ## ring_buffer_set_wait_strategy(ring_buffer__, wait_strategy__);         \
+                create_thread(&c_1_, ring_buffer__, ring_buffer_prefix__ ## entry_processor_thread);           \
+                create_thread(&c_2_, ring_buffer__, ring_buffer_prefix__ ## entry_processor_thread);           \
+                sleep(1);                                                                                      \
+                for (n_ = 0; n_ < publishers__; ++n_)                                                          \
+                        create_thread(&p_[n_], ring_buffer__, ring_buffer_prefix__ ## entry_publisher_thread); \
+                                                                                                               \
+                for (n_ = 0; n_ < publishers__; ++n_)                                                          \
+                        pthread_join(p_[n_], NULL);                                                            \
+                pthread_join(c_1_, NULL);                                                                      \
+                pthread_join(c_2_, NULL);                                                                      \
+                printf("%s test done\n\n", test_name__);                                                       \
+        } while (0)
+
+int
+main(int argc, char *argv[])
+{
+        pthread_t p_1; // entry publisher
+        pthread_t p_2;
+        pthread_t p_3;
+        pthread_t c_1; // entry processor
+        pthread_t c_2;
+        pthread_t c_3;
+        struct ring_buffer_t *ring_buffer_heap;
+        struct ring_buffer_t ring_buffer_stack;
+        struct rt_ring_buffer_t *rt_ring_buffer_heap;
+        struct rt_ring_buffer_t *rt_ring_buffer_mapped;
+        struct mp_ring_buffer_t *mp_ring_buffer_mapped;
+
+        ring_buffer_heap = ring_buffer_malloc();
+        if (!ring_buffer_heap) {
+                printf("Malloc ring buffer - ERROR\n");
+                return EXIT_FAILURE;
+        }
+        ring_buffer_init(ring_buffer_heap);
+        ring_buffer_init(&ring_buffer_stack);
+        ring_buffer_init(&ring_buffer);
+
+        //
+        // first as a global variable (non-blocking)
+        //
+        create_thread(&c_1, &ring_buffer, entry_processor_thread);
+        create_thread(&c_2, &ring_buffer, entry_processor_thread);
+        sleep(1);
+        create_thread(&p_1, &ring_buffer, entry_publisher_nonblocking_thread);
+        create_thread(&p_2, &ring_buffer, entry_publisher_nonblocking_thread);
+        create_thread(&p_3, &ring_buffer, entry_publisher_nonblocking_thread);
+
+        // join entry publishers
+        pthread_join(p_1, NULL);
+        pthread_join(p_2, NULL);
+        pthread_join(p_3, NULL);
+
+        // join entry processors
+        pthread_join(c_1, NULL);
+        pthread_join(c_2, NULL);
+        printf("As-Global-Variable (non-blocking) test done\n\n");
+
+
+        //
+        // then as a stack variable (blocking)
+        //
+        create_thread(&c_1, &ring_buffer_stack, entry_processor_thread);
+        create_thread(&c_2, &ring_buffer_stack, entry_processor_thread);
+        sleep(1);
+        create_thread(&p_1, &ring_buffer_stack, entry_publisher_blocking_thread);
+        create_thread(&p_2, &ring_buffer_stack, entry_publisher_blocking_thread);
+        create_thread(&p_3, &ring_buffer_stack, entry_publisher_blocking_thread);
+
+        // join entry publishers
+        pthread_join(p_1, NULL);
+        pthread_join(p_2, NULL);
+        pthread_join(p_3, NULL);
+
+        // join entry processors
+        pthread_join(c_1, NULL);
+        pthread_join(c_2, NULL);
+        printf("As-Global-Variable (blocking) test done\n\n");
+
+        //
+        // Now as allocated on the heap (blocking)
+        //
+        create_thread(&c_1, ring_buffer_heap, entry_processor_thread);
+        create_thread(&c_2, ring_buffer_heap, entry_processor_thread);
+        sleep(1);
+        create_thread(&p_1, ring_buffer_heap, entry_publisher_blocking_thread);
+        create_thread(&p_2, ring_buffer_heap, entry_publisher_blocking_thread);
+        create_thread(&p_3, ring_buffer_heap, entry_publisher_blocking_thread);
+
+        // join entry publishers
+        pthread_join(p_1, NULL);
+        pthread_join(p_2, NULL);
+        pthread_join(p_3, NULL);
+
+        // join entry processors
+        pthread_join(c_1, NULL);
+        pthread_join(c_2, NULL);
+        printf("On-The-Heap (blocking) test done\n\n");
+
+        //
+        // and on the heap again with batching publishers
+        //
+        ring_buffer_init(ring_buffer_heap);
+        create_thread(&c_1, ring_buffer_heap, entry_processor_thread);
+        create_thread(&c_2, ring_buffer_heap, entry_processor_thread);
+        sleep(1);
+        create_thread(&p_1, ring_buffer_heap, entry_publisher_batch_thread);
+        create_thread(&p_2, ring_buffer_heap, entry_publisher_batch_thread);
+        create_thread(&p_3, ring_buffer_heap, entry_publisher_blocking_thread);
+
+        // join entry publishers
+        pthread_join(p_1, NULL);
+        pthread_join(p_2, NULL);
+        pthread_join(p_3, NULL);
+
+        // join entry processors
+        pthread_join(c_1, NULL);
+        pthread_join(c_2, NULL);
+        free(ring_buffer_heap);
+        printf("On-The-Heap (batching) test done\n\n");
+
+        //
+        // out of order commits by multiple publishers
+        //
+        RUN_TEST(&mp_ring_buffer, mp_, 3, WAIT_STRATEGY_YIELD, "Multi-Publisher");
+        RUN_TEST(&mp_ring_buffer, mp_, 3, WAIT_STRATEGY_BLOCKING, "Multi-Publisher (blocking wait strategy)");
+
+        //
+        // the single publisher ring buffer
+        //
+        RUN_TEST(&sp_ring_buffer, sp_, 1, WAIT_STRATEGY_YIELD, "Single-Publisher");
+        RUN_TEST(&sp_ring_buffer, sp_, 1, WAIT_STRATEGY_TIMED, "Single-Publisher (timed wait strategy)");
+
+        //
+        // ring buffers sized at run time
+        //
+        if (rt_ring_buffer_malloc(ENTRY_BUFFER_SIZE + 1, MAX_ENTRY_PROCESSORS))
+                printf("Runtime-sized ring buffer of non power of two size - ERROR\n");
+        if (rt_ring_buffer_malloc((uint_fast64_t)1 << 63, MAX_ENTRY_PROCESSORS))
+                printf("Runtime-sized ring buffer of overflowing size - ERROR\n");
+        if (rt_ring_buffer_malloc(ENTRY_BUFFER_SIZE, UINT_FAST64_MAX / 2))
+                printf("Runtime-sized ring buffer of overflowing entry processor capacity - ERROR\n");
+        rt_ring_buffer_heap = rt_ring_buffer_malloc(2 * ENTRY_BUFFER_SIZE, MAX_ENTRY_PROCESSORS);
+        if (!rt_ring_buffer_heap) {
+                printf("Malloc runtime-sized ring buffer - ERROR\n");
+                return EXIT_FAILURE;
+        }
+        RUN_TEST(rt_ring_buffer_heap, rt_, 3, WAIT_STRATEGY_YIELD, "Runtime-Sized");
+        free(rt_ring_buffer_heap);
+        rt_ring_buffer_heap = rt_ring_buffer_malloc(BATCH_SIZE + 1, MAX_ENTRY_PROCESSORS);
+        if (!rt_ring_buffer_heap) {
+                printf("Malloc runtime-sized ring buffer - ERROR\n");
+                return EXIT_FAILURE;
+        }
+        RUN_TEST(rt_ring_buffer_heap, rt_, 3, WAIT_STRATEGY_BLOCKING, "Runtime-Sized (small, blocking wait strategy)");
+        free(rt_ring_buffer_heap);
+
+        //
+        // ring buffers mapped on huge pages and NUMA node 0 (zero)
+        //
+        mp_ring_buffer_mapped = mp_ring_buffer_mmap(RING_BUFFER_MAP_THP | RING_BUFFER_MAP_PREFAULT, 0);
+        if (!mp_ring_buffer_mapped) {
+                printf("Map ring buffer - ERROR\n");
+                return EXIT_FAILURE;
+        }
+        RUN_TEST(mp_ring_buffer_mapped, mp_, 3, WAIT_STRATEGY_YIELD, "Multi-Publisher (transparent huge pages)");
+        mp_ring_buffer_munmap(mp_ring_buffer_mapped, RING_BUFFER_MAP_THP | RING_BUFFER_MAP_PREFAULT);
+
+        rt_ring_buffer_mapped = rt_ring_buffer_mmap(ENTRY_BUFFER_SIZE, MAX_ENTRY_PROCESSORS, RING_BUFFER_MAP_HUGETLB | RING_BUFFER_MAP_PREFAULT, 0);
+        if (!rt_ring_buffer_mapped) {
+                printf("Map runtime-sized ring buffer - ERROR\n");
+                return EXIT_FAILURE;
+        }
+        RUN_TEST(rt_ring_buffer_mapped, rt_, 3, WAIT_STRATEGY_YIELD, "Runtime-Sized (huge pages)");
+        rt_ring_buffer_munmap(rt_ring_buffer_mapped, RING_BUFFER_MAP_HUGETLB | RING_BUFFER_MAP_PREFAULT);
+
+        rt_ring_buffer_mapped = rt_ring_buffer_mmap(ENTRY_BUFFER_SIZE, MAX_ENTRY_PROCESSORS, RING_BUFFER_MAP_NUMA_BIND, 0);
+        if (!rt_ring_buffer_mapped) {
+                printf("Map runtime-sized ring buffer bound to NUMA node 0 - ERROR\n");
+                return EXIT_FAILURE;
+        }
+        RUN_TEST(rt_ring_buffer_mapped, rt_, 3, WAIT_STRATEGY_YIELD, "Runtime-Sized (bound to NUMA node 0)");
+        rt_ring_buffer_munmap(rt_ring_buffer_mapped, RING_BUFFER_MAP_NUMA_BIND);
+
+        //
+        // a diamond of entry processors where only the last stage gates
+        //
+        ring_buffer_init(&ring_buffer);
+        create_thread(&c_1, &ring_buffer, upstream_entry_processor_thread);
+        create_thread(&c_2, &ring_buffer, upstream_entry_processor_thread);
+        sleep(1);
+        create_thread(&c_3, &ring_buffer, downstream_entry_processor_thread);
+        sleep(1);
+        create_thread(&p_1, &ring_buffer, entry_publisher_blocking_thread);
+        pthread_join(p_1, NULL);
+        pthread_join(c_1, NULL);
+        pthread_join(c_2, NULL);
+        pthread_join(c_3, NULL);
+        printf("Diamond test done\n\n");
+
+        //
+        // waiting with a deadline
+        //
+        timed_test(&ring_buffer, WAIT_STRATEGY_BUSY_SPIN, "Timed (busy-spin wait strategy)");
+        timed_test(&ring_buffer, WAIT_STRATEGY_YIELD, "Timed (yield wait strategy)");
+        timed_test(&ring_buffer, WAIT_STRATEGY_BLOCKING, "Timed (blocking wait strategy)");
+        timed_test(&ring_buffer, WAIT_STRATEGY_TIMED, "Timed (timed wait strategy)");
+
+        //
+        // unregistering the entry processor a blocked publisher waits for
+        //
+        unregister_test(&ring_buffer);
+
+#if defined __linux__
+        //
+        // spinning and yielding before sleeping
+        //
+        backoff_test(&ring_buffer);
+#endif
+
+        //
+        // variable length records, wrapping around many times
+        //
+        record_ring_buffer_init(&record_ring_buffer);
+        create_thread(&c_1, &record_ring_buffer, record_processor_thread);
+        create_thread(&c_2, &record_ring_buffer, record_processor_thread);
+        sleep(1);
+        create_thread(&p_1, &record_ring_buffer, record_publisher_thread);
+        create_thread(&p_2, &record_ring_buffer, record_publisher_thread);
+        pthread_join(p_1, NULL);
+        pthread_join(p_2, NULL);
+        pthread_join(c_1, NULL);
+        pthread_join(c_2, NULL);
+        printf("Variable length records test done\n\n");
+
+        //
+        // batch processors with handler callbacks
+        //
+        batch_processor_test();
+
+        //
+        // a worker pool sharing the entries between its workers
+        //
+        worker_pool_test();
+
+        //
+        // a ring set of shards with a batch processor each and a merge processor
+        //
+        ring_set_test(-1);
+
+#if defined __linux__
+        //
+        // the same, with the merge processor sleeping on an eventfd
+        //
+        ring_set_eventfd_test();
+
+        //
+        // a poller in an epoll event loop
+        //
+        poller_test();
+#endif
+
+#if defined __linux__
+        //
+        // entries read and written without copying
+        //
+        io_test();
+
+        //
+        // a sink writing the entries to a file
+        //
+        sink_test();
+#endif
+
+        //
+        // spans of entries wrapping around the end of the ring buffer
+        //
+        spans_test();
+
+        //
+        // journaling and replaying the entries
+        //
+        journal_test();
+
+        //
+        // a ring buffer shared with other processes
+        //
+        shm_test();
 
         return EXIT_SUCCESS;
 }
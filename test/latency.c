@@ -0,0 +1,386 @@
+/*
+ *  Copyright (C) 2012-2025 Jules Colding <jcolding@gmail.com>
+ *
+ *  All Rights Reserved.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *  You can use, modify and redistribute it in any way you want.
+ */
+
+/*
+ * Measures the distribution of latencies through a ring buffer:
+ *
+ *   - one-way, from publishing to processing, at a number of offered
+ *     rates. Every entry carries the time at which it was meant to be
+ *     published, so that a publisher falling behind schedule is
+ *     accounted for instead of hidden (coordinated omission).
+ *
+ *   - round trip, with an entry processor echoing every entry back to
+ *     the publisher on a second ring buffer (ping-pong).
+ *
+ * Usage: latency [rate ...]
+ *
+ * The rates are in entries per second, 0 (zero) meaning as fast as
+ * possible. The default is DEFAULT_RATES.
+ */
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+
+#ifdef HAVE_CONFIG_H
+    #include "ac_config.h"
+#endif
+#include "src/disruptor.h"
+
+#ifndef CLOCK_MONOTONIC_RAW
+#define CLOCK_MONOTONIC_RAW CLOCK_MONOTONIC
+#endif
+
+#define STOP UINT_FAST64_MAX
+#define ENTRY_BUFFER_SIZE (1024*2) // must be a power of two
+#define MAX_ENTRY_PROCESSORS (1)
+#define SECONDS_PER_RATE (2)
+#define SATURATION_ENTRIES (10 * 1000 * 1000)
+#define WARMUP_ENTRIES (10 * 1000) // at most, and no more than a tenth of the entries
+#define PING_PONG_ENTRIES (1000 * 1000)
+#define DEFAULT_RATES { 10000, 100000, 1000000, 0 }
+
+/*
+ * Log-linear histogram of nanosecond values in the spirit of
+ * HdrHistogram. Values below 2^HISTOGRAM_SUB_BUCKET_BITS are counted
+ * exactly, larger values in buckets of width 2^(magnitude -
+ * HISTOGRAM_SUB_BUCKET_BITS + 1), that is with a relative error of
+ * less than 2^-(HISTOGRAM_SUB_BUCKET_BITS - 1).
+ */
+#define HISTOGRAM_SUB_BUCKET_BITS (7)
+#define HISTOGRAM_HALF_SUB_BUCKETS (1 << (HISTOGRAM_SUB_BUCKET_BITS - 1))
+#define HISTOGRAM_BUCKETS ((64 - HISTOGRAM_SUB_BUCKET_BITS + 2) * HISTOGRAM_HALF_SUB_BUCKETS)
+
+struct histogram_t {
+        uint_fast64_t count;
+        uint_fast64_t max;
+        uint_fast64_t buckets[HISTOGRAM_BUCKETS];
+};
+
+DEFINE_ENTRY_TYPE(uint_fast64_t, entry_t);
+DEFINE_SP_RING_BUFFER_TYPE(MAX_ENTRY_PROCESSORS, ENTRY_BUFFER_SIZE, entry_t, ring_buffer_t);
+DEFINE_RING_BUFFER_INIT(ENTRY_BUFFER_SIZE, ring_buffer_t);
+DEFINE_RING_BUFFER_SET_WAIT_STRATEGY_FUNCTION(ring_buffer_t);
+DEFINE_RING_BUFFER_SHOW_ENTRY_FUNCTION(entry_t, ring_buffer_t);
+DEFINE_RING_BUFFER_ACQUIRE_ENTRY_FUNCTION(entry_t, ring_buffer_t);
+DEFINE_ENTRY_PROCESSOR_BARRIER_REGISTER_FUNCTION(ring_buffer_t);
+DEFINE_ENTRY_PROCESSOR_BARRIER_UNREGISTER_FUNCTION(ring_buffer_t);
+DEFINE_ENTRY_PROCESSOR_BARRIER_WAITFOR_BLOCKING_FUNCTION(ring_buffer_t);
+DEFINE_ENTRY_PROCESSOR_BARRIER_RELEASEENTRY_FUNCTION(ring_buffer_t);
+DEFINE_SP_ENTRY_PUBLISHER_NEXTENTRY_BLOCKING_FUNCTION(ring_buffer_t);
+DEFINE_SP_ENTRY_PUBLISHER_COMMITENTRY_BLOCKING_FUNCTION(ring_buffer_t);
+
+struct ring_buffer_t ping;
+struct ring_buffer_t pong;
+struct histogram_t histogram;
+uint_fast64_t warmup_entries;
+
+static inline uint_fast64_t
+now(void)
+{
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+
+        return (uint_fast64_t)ts.tv_sec * 1000000000 + (uint_fast64_t)ts.tv_nsec;
+}
+
+static inline unsigned int
+histogram_index(const uint_fast64_t value)
+{
+        unsigned int shift;
+
+        if (value < 2 * HISTOGRAM_HALF_SUB_BUCKETS)
+                return (unsigned int)value;
+        shift = 63 - (unsigned int)__builtin_clzll(value) - HISTOGRAM_SUB_BUCKET_BITS + 1;
+
+        return shift * HISTOGRAM_HALF_SUB_BUCKETS + (unsigned int)(value >> shift);
+}
+
+/*
+ * Returns the lowest value counted in the bucket at index.
+ */
+static uint_fast64_t
+histogram_value(const unsigned int index)
+{
+        unsigned int shift;
+
+        if (index < 2 * HISTOGRAM_HALF_SUB_BUCKETS)
+                return index;
+        shift = index / HISTOGRAM_HALF_SUB_BUCKETS - 1;
+
+        return (uint_fast64_t)(index - shift * HISTOGRAM_HALF_SUB_BUCKETS) << shift;
+}
+
+static inline void
+histogram_record(struct histogram_t * const hist,
+                 const uint_fast64_t value)
+{
+        ++hist->buckets[histogram_index(value)];
+        ++hist->count;
+        if (value > hist->max)
+                hist->max = value;
+}
+
+/*
+ * Returns the value below or at which percentile percent of the
+ * recorded values are.
+ */
+static uint_fast64_t
+histogram_percentile(const struct histogram_t * const hist,
+                     const double percentile)
+{
+        const uint_fast64_t rank = (uint_fast64_t)((double)hist->count * percentile / 100.0 + 0.5);
+        uint_fast64_t seen = 0;
+        unsigned int n;
+
+        for (n = 0; n < HISTOGRAM_BUCKETS; ++n) {
+                seen += hist->buckets[n];
+                if (seen && (seen >= rank))
+                        return histogram_value(n);
+        }
+
+        return hist->max;
+}
+
+static void
+histogram_print(const struct histogram_t * const hist,
+                const char * const name)
+{
+        printf("%s: %" PRIuFAST64 " samples, p50 %" PRIuFAST64 " ns, p99 %" PRIuFAST64 " ns, p99.9 %" PRIuFAST64
+               " ns, p99.99 %" PRIuFAST64 " ns, max %" PRIuFAST64 " ns\n",
+               name,
+               hist->count,
+               histogram_percentile(hist, 50.0),
+               histogram_percentile(hist, 99.0),
+               histogram_percentile(hist, 99.9),
+               histogram_percentile(hist, 99.99),
+               hist->max);
+}
+
+static int
+create_thread(pthread_t * const thread_id,
+              void *thread_arg,
+              void *(*thread_func)(void *))
+{
+        int retv = 0;
+        pthread_attr_t thread_attr;
+
+        if (pthread_attr_init(&thread_attr))
+                return 0;
+
+        if (pthread_attr_setdetachstate(&thread_attr, PTHREAD_CREATE_JOINABLE))
+                goto err;
+
+        if (pthread_create(thread_id, &thread_attr, thread_func, thread_arg))
+                goto err;
+
+        retv = 1;
+err:
+        pthread_attr_destroy(&thread_attr);
+
+        return retv;
+}
+
+/*
+ * Records the time from the timestamp of each entry until it is
+ * processed, except for the first warmup_entries entries.
+ */
+static void*
+entry_processor_thread(void *arg)
+{
+        struct cursor_t n;
+        struct ring_buffer_t *buffer = (struct ring_buffer_t*)arg;
+        struct cursor_t cursor;
+        struct cursor_t cursor_upper_limit;
+        struct count_t reg_number;
+        const struct entry_t *entry;
+        uint_fast64_t timestamp;
+
+        cursor.sequence = entry_processor_barrier_register(buffer, &reg_number);
+        cursor_upper_limit.sequence = cursor.sequence;
+
+        do {
+                entry_processor_barrier_wait_for_blocking(buffer, &cursor_upper_limit);
+                timestamp = now();
+                for (n.sequence = cursor.sequence; n.sequence <= cursor_upper_limit.sequence; ++n.sequence) {
+                        entry = ring_buffer_show_entry(buffer, &n);
+                        if (STOP == entry->content)
+                                goto out;
+                        if (n.sequence > warmup_entries)
+                                histogram_record(&histogram, (timestamp > entry->content) ? timestamp - entry->content : 0);
+                }
+                entry_processor_barrier_release_entry(buffer, &reg_number, &cursor_upper_limit);
+
+                ++cursor_upper_limit.sequence;
+                cursor.sequence = cursor_upper_limit.sequence;
+        } while (1);
+out:
+        entry_processor_barrier_unregister(buffer, &reg_number);
+
+        return NULL;
+}
+
+/*
+ * Echoes every entry of the ping ring buffer to the pong ring buffer.
+ */
+static void*
+echo_thread(void *arg)
+{
+        struct cursor_t n;
+        struct cursor_t cursor;
+        struct cursor_t cursor_upper_limit;
+        struct cursor_t out;
+        struct count_t reg_number;
+        uint_fast64_t content;
+
+        (void)arg;
+        cursor.sequence = entry_processor_barrier_register(&ping, &reg_number);
+        cursor_upper_limit.sequence = cursor.sequence;
+
+        do {
+                entry_processor_barrier_wait_for_blocking(&ping, &cursor_upper_limit);
+                for (n.sequence = cursor.sequence; n.sequence <= cursor_upper_limit.sequence; ++n.sequence) {
+                        content = ring_buffer_show_entry(&ping, &n)->content;
+                        publisher_next_entry_blocking(&pong, &out);
+                        ring_buffer_acquire_entry(&pong, &out)->content = content;
+                        publisher_commit_entry_blocking(&pong, &out);
+                        if (STOP == content)
+                                goto out;
+                }
+                entry_processor_barrier_release_entry(&ping, &reg_number, &cursor_upper_limit);
+
+                ++cursor_upper_limit.sequence;
+                cursor.sequence = cursor_upper_limit.sequence;
+        } while (1);
+out:
+        entry_processor_barrier_unregister(&ping, &reg_number);
+
+        return NULL;
+}
+
+/*
+ * Publishes at rate entries per second, or as fast as possible if
+ * rate is 0 (zero), and prints the one-way latencies.
+ */
+static void
+one_way_test(const uint_fast64_t rate)
+{
+        const uint_fast64_t entries = rate ? rate * SECONDS_PER_RATE : SATURATION_ENTRIES;
+        pthread_t thread_id;
+        struct cursor_t cursor;
+        uint_fast64_t start;
+        uint_fast64_t scheduled;
+        uint_fast64_t n;
+        char name[64];
+
+        memset(&histogram, 0, sizeof(histogram));
+        warmup_entries = (entries / 10 < WARMUP_ENTRIES) ? entries / 10 : WARMUP_ENTRIES;
+        ring_buffer_init(&ping);
+        ring_buffer_set_wait_strategy(&ping, WAIT_STRATEGY_YIELD);
+        if (!create_thread(&thread_id, &ping, entry_processor_thread)) {
+                printf("could not create entry processor thread\n");
+                exit(EXIT_FAILURE);
+        }
+
+        start = now();
+        for (n = 0; n < entries; ++n) {
+                if (rate) {
+                        scheduled = start + n * 1000000000 / rate;
+                        while (now() < scheduled)
+                                ;
+                } else {
+                        scheduled = now();
+                }
+                publisher_next_entry_blocking(&ping, &cursor);
+                ring_buffer_acquire_entry(&ping, &cursor)->content = scheduled;
+                publisher_commit_entry_blocking(&ping, &cursor);
+        }
+
+        publisher_next_entry_blocking(&ping, &cursor);
+        ring_buffer_acquire_entry(&ping, &cursor)->content = STOP;
+        publisher_commit_entry_blocking(&ping, &cursor);
+        pthread_join(thread_id, NULL);
+
+        if (rate)
+                snprintf(name, sizeof(name), "One-way at %" PRIuFAST64 " entries per second", rate);
+        else
+                snprintf(name, sizeof(name), "One-way at saturation");
+        histogram_print(&histogram, name);
+}
+
+/*
+ * Publishes PING_PONG_ENTRIES entries, one at a time, and prints the
+ * round trip latencies.
+ */
+static void
+ping_pong_test(void)
+{
+        pthread_t thread_id;
+        struct cursor_t cursor;
+        struct cursor_t reply;
+        struct count_t reg_number;
+        uint_fast64_t timestamp;
+        uint_fast64_t n;
+
+        memset(&histogram, 0, sizeof(histogram));
+        ring_buffer_init(&ping);
+        ring_buffer_init(&pong);
+        ring_buffer_set_wait_strategy(&ping, WAIT_STRATEGY_YIELD);
+        ring_buffer_set_wait_strategy(&pong, WAIT_STRATEGY_YIELD);
+        reply.sequence = entry_processor_barrier_register(&pong, &reg_number);
+        if (!create_thread(&thread_id, NULL, echo_thread)) {
+                printf("could not create echo thread\n");
+                exit(EXIT_FAILURE);
+        }
+
+        for (n = 0; n <= PING_PONG_ENTRIES; ++n) {
+                timestamp = now();
+                publisher_next_entry_blocking(&ping, &cursor);
+                ring_buffer_acquire_entry(&ping, &cursor)->content = (n < PING_PONG_ENTRIES) ? timestamp : STOP;
+                publisher_commit_entry_blocking(&ping, &cursor);
+
+                entry_processor_barrier_wait_for_blocking(&pong, &reply);
+                if (ring_buffer_show_entry(&pong, &reply)->content != ((n < PING_PONG_ENTRIES) ? timestamp : STOP)) {
+                        printf("Ping-pong reply - ERROR\n");
+                        exit(EXIT_FAILURE);
+                }
+                if (n >= WARMUP_ENTRIES && n < PING_PONG_ENTRIES)
+                        histogram_record(&histogram, now() - timestamp);
+                entry_processor_barrier_release_entry(&pong, &reg_number, &reply);
+                ++reply.sequence;
+        }
+        pthread_join(thread_id, NULL);
+        entry_processor_barrier_unregister(&pong, &reg_number);
+
+        histogram_print(&histogram, "Round trip");
+}
+
+int
+main(int argc, char *argv[])
+{
+        const uint_fast64_t default_rates[] = DEFAULT_RATES;
+        unsigned int n;
+
+        if (argc > 1) {
+                for (n = 1; n < (unsigned int)argc; ++n)
+                        one_way_test(strtoull(argv[n], NULL, 10));
+        } else {
+                for (n = 0; n < sizeof(default_rates)/sizeof(default_rates[0]); ++n)
+                        one_way_test(default_rates[n]);
+        }
+        ping_pong_test();
+
+        return EXIT_SUCCESS;
+}
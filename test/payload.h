@@ -0,0 +1,104 @@
+/*
+ *  Copyright (C) 2012-2025 Jules Colding <jcolding@gmail.com>
+ *
+ *  All Rights Reserved.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *  You can use, modify and redistribute it in any way you want.
+ */
+
+/*
+ * Payloads shared by the performance tests and the benchmark driver,
+ * along with the loops writing and reading them, so that every tool
+ * measures the very same work per entry.
+ *
+ * A payload is an array of words. Entry publishers write the sequence
+ * number of the entry into every word, or STOP into the first word of
+ * the last entry. Entry processors add up every word. STOP must be
+ * defined by the includer.
+ */
+
+#ifndef DISRUPTORC_TEST_PAYLOAD_H
+#define DISRUPTORC_TEST_PAYLOAD_H
+
+#include "src/disruptor.h"
+
+typedef uint_fast64_t payload8_t[1];
+typedef uint_fast64_t payload16_t[2];
+typedef uint_fast64_t payload32_t[4];
+typedef uint_fast64_t payload64_t[8];
+typedef uint_fast64_t payload128_t[16];
+typedef uint_fast64_t payload256_t[32];
+
+/*
+ * Number of words in the payload of entry__.
+ */
+#define PAYLOAD_WORDS__(entry__) \
+        (sizeof((entry__)->content)/sizeof((entry__)->content[0]))
+
+/*
+ * Writes sequence__ into every word of the payload of entry__.
+ */
+#define PAYLOAD_WRITE__(entry__, sequence__)                                  \
+        do {                                                                  \
+                unsigned int word__;                                          \
+                                                                              \
+                for (word__ = 0; word__ < PAYLOAD_WORDS__(entry__); ++word__) \
+                        (entry__)->content[word__] = (sequence__);            \
+        } while (0)
+
+/*
+ * Returns the sum of the words of the payload of entry__.
+ */
+#define PAYLOAD_SUM__(entry__)                                           \
+({                                                                       \
+        unsigned int word__;                                             \
+        uint_fast64_t sum__ = 0;                                         \
+                                                                         \
+        for (word__ = 0; word__ < PAYLOAD_WORDS__(entry__); ++word__)    \
+                sum__ += (entry__)->content[word__];                     \
+        sum__;                                                           \
+})
+
+/*
+ * Processes the entries of ring_buffer__ from first_sequence__ on,
+ * adding up their payloads into sum__, until the STOP entry. wait_for__
+ * is the statement waiting for cursor_upper_limit__ to be available,
+ * which allows waiting for upstream entry processors as well. Every
+ * entry before the STOP entry is released by way of
+ * entry_processor_number__. Returns the sequence number of the STOP
+ * entry, which is left unreleased.
+ */
+#define PAYLOAD_PROCESS__(ring_buffer__, entry_processor_number__, first_sequence__, cursor_upper_limit__, wait_for__, sum__, ring_buffer_prefix__...) \
+({                                                                                                                                                     \
+        struct cursor_t n__;                                                                                                                           \
+        struct cursor_t cursor__;                                                                                                                      \
+        __typeof__(ring_buffer_prefix__ ## ring_buffer_show_entry((ring_buffer__), &n__)) entry__;                                                     \
+        uint_fast64_t stop__ = 0;                                                                                                                      \
+                                                                                                                                                       \
+        cursor__.sequence = (first_sequence__);                                                                                                        \
+        (cursor_upper_limit__).sequence = cursor__.sequence;                                                                                           \
+        do {                                                                                                                                           \
+                wait_for__;                                                                                                                            \
+                for (n__.sequence = cursor__.sequence; n__.sequence <= (cursor_upper_limit__).sequence; ++n__.sequence) {                              \
+                        entry__ = ring_buffer_prefix__ ## ring_buffer_show_entry((ring_buffer__), &n__);                                               \
+                        if (STOP == entry__->content[0]) {                                                                                             \
+                                stop__ = n__.sequence;                                                                                                 \
+                                break;                                                                                                                 \
+                        }                                                                                                                              \
+                        (sum__) += PAYLOAD_SUM__(entry__);                                                                                             \
+                }                                                                                                                                      \
+                if (stop__)                                                                                                                            \
+                        break;                                                                                                                         \
+                ring_buffer_prefix__ ## entry_processor_barrier_release_entry((ring_buffer__), (entry_processor_number__), &(cursor_upper_limit__));   \
+                                                                                                                                                       \
+                ++(cursor_upper_limit__).sequence;                                                                                                     \
+                cursor__.sequence = (cursor_upper_limit__).sequence;                                                                                   \
+        } while (1);                                                                                                                                   \
+        stop__;                                                                                                                                        \
+})
+
+#endif //  DISRUPTORC_TEST_PAYLOAD_H
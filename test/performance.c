@@ -10,25 +10,43 @@
  *  You can use, modify and redistribute it in any way you want.
  */
 
+#ifdef HAVE_CONFIG_H
+    #include "ac_config.h"
+#endif
 #include <unistd.h>
 #include <stdio.h>
 #include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
 #include <pthread.h>
 
-#ifdef HAVE_CONFIG_H
-    #include "ac_config.h"
-#endif
 #include "src/disruptor.h"
+#include "src/disruptor_processor.h"
+#include "src/disruptor_io.h"
+#include "src/disruptor_shard.h"
+#include "test/payload.h"
 
 #define STOP UINT_FAST64_MAX
 #define ENTRIES_TO_GENERATE (50 * 1000 * 1000 * 5)
 #define ENTRY_BUFFER_SIZE (1024*2) // must be a power of two
+#define LARGE_ENTRY_BUFFER_SIZE (1024*1024) // must be a power of two
 #define MAX_ENTRY_PROCESSORS (1)
+#define PAYLOAD_BATCH_SIZE (64) // must divide ENTRIES_TO_GENERATE
+#define MAX_WORKERS (16)
+#define WORKER_ENTRIES_TO_GENERATE (1000 * 1000)
+#define WORKER_ROUNDS (256) // CPU-heavy handler work per entry
+#define SCALING_ENTRIES_TO_GENERATE (4 * 1000 * 1000) // must be a multiple of every publisher count
+#define MAX_SCALING_PUBLISHERS (32)
+#define RING_SET_SHARD_COUNT (8)
+#define IO_DATAGRAM_SIZE (512)
+#define IO_DATAGRAMS_TO_GENERATE (IO_MAX_BATCH * 8 * 1000) // must be a multiple of IO_MAX_BATCH
 
 DEFINE_ENTRY_TYPE(uint_fast64_t, entry_t);
 DEFINE_RING_BUFFER_TYPE(MAX_ENTRY_PROCESSORS, ENTRY_BUFFER_SIZE, entry_t, ring_buffer_t);
 DEFINE_RING_BUFFER_MALLOC(ring_buffer_t);
 DEFINE_RING_BUFFER_INIT(ENTRY_BUFFER_SIZE, ring_buffer_t);
+DEFINE_RING_BUFFER_SET_WAIT_STRATEGY_FUNCTION(ring_buffer_t);
+DEFINE_RING_BUFFER_SET_SPIN_BUDGET_FUNCTION(ring_buffer_t);
 DEFINE_RING_BUFFER_SHOW_ENTRY_FUNCTION(entry_t, ring_buffer_t);
 DEFINE_RING_BUFFER_ACQUIRE_ENTRY_FUNCTION(entry_t, ring_buffer_t);
 DEFINE_ENTRY_PROCESSOR_BARRIER_REGISTER_FUNCTION(ring_buffer_t);
@@ -38,10 +56,88 @@ DEFINE_ENTRY_PROCESSOR_BARRIER_RELEASEENTRY_FUNCTION(ring_buffer_t);
 DEFINE_ENTRY_PUBLISHER_NEXTENTRY_BLOCKING_FUNCTION(ring_buffer_t);
 DEFINE_ENTRY_PUBLISHER_NEXTENTRY_NONBLOCKING_FUNCTION(ring_buffer_t);
 DEFINE_ENTRY_PUBLISHER_COMMITENTRY_BLOCKING_FUNCTION(ring_buffer_t);
+DEFINE_ENTRY_PUBLISHER_NEXTENTRIES_BLOCKING_FUNCTION(ring_buffer_t);
+DEFINE_ENTRY_PUBLISHER_COMMITENTRIES_BLOCKING_FUNCTION(ring_buffer_t);
+
+DEFINE_SP_RING_BUFFER_TYPE(MAX_ENTRY_PROCESSORS, ENTRY_BUFFER_SIZE, entry_t, sp_ring_buffer_t);
+DEFINE_RING_BUFFER_MALLOC(sp_ring_buffer_t, sp_);
+DEFINE_RING_BUFFER_INIT(ENTRY_BUFFER_SIZE, sp_ring_buffer_t, sp_);
+DEFINE_RING_BUFFER_SHOW_ENTRY_FUNCTION(entry_t, sp_ring_buffer_t, sp_);
+DEFINE_RING_BUFFER_ACQUIRE_ENTRY_FUNCTION(entry_t, sp_ring_buffer_t, sp_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_REGISTER_FUNCTION(sp_ring_buffer_t, sp_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_UNREGISTER_FUNCTION(sp_ring_buffer_t, sp_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_WAITFOR_BLOCKING_FUNCTION(sp_ring_buffer_t, sp_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_RELEASEENTRY_FUNCTION(sp_ring_buffer_t, sp_);
+DEFINE_SP_ENTRY_PUBLISHER_NEXTENTRY_BLOCKING_FUNCTION(sp_ring_buffer_t, sp_);
+DEFINE_SP_ENTRY_PUBLISHER_NEXTENTRY_NONBLOCKING_FUNCTION(sp_ring_buffer_t, sp_);
+DEFINE_SP_ENTRY_PUBLISHER_COMMITENTRY_BLOCKING_FUNCTION(sp_ring_buffer_t, sp_);
 
+DEFINE_RUNTIME_RING_BUFFER_TYPE(entry_t, rt_ring_buffer_t);
+DEFINE_RUNTIME_RING_BUFFER_MALLOC(entry_t, rt_ring_buffer_t, rt_);
+DEFINE_RUNTIME_RING_BUFFER_MMAP(entry_t, rt_ring_buffer_t, rt_);
+DEFINE_RUNTIME_RING_BUFFER_INIT(entry_t, rt_ring_buffer_t, rt_);
+DEFINE_RING_BUFFER_SHOW_ENTRY_FUNCTION(entry_t, rt_ring_buffer_t, rt_);
+DEFINE_RING_BUFFER_ACQUIRE_ENTRY_FUNCTION(entry_t, rt_ring_buffer_t, rt_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_REGISTER_FUNCTION(rt_ring_buffer_t, rt_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_UNREGISTER_FUNCTION(rt_ring_buffer_t, rt_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_WAITFOR_BLOCKING_FUNCTION(rt_ring_buffer_t, rt_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_RELEASEENTRY_FUNCTION(rt_ring_buffer_t, rt_);
+DEFINE_ENTRY_PUBLISHER_NEXTENTRY_BLOCKING_FUNCTION(rt_ring_buffer_t, rt_);
+DEFINE_ENTRY_PUBLISHER_NEXTENTRY_NONBLOCKING_FUNCTION(rt_ring_buffer_t, rt_);
+DEFINE_ENTRY_PUBLISHER_COMMITENTRY_BLOCKING_FUNCTION(rt_ring_buffer_t, rt_);
+DEFINE_WORKER_POOL_TYPE(entry_t, rt_ring_buffer_t, worker_pool_t, MAX_WORKERS);
+DEFINE_WORKER_POOL_INIT_FUNCTION(entry_t, rt_ring_buffer_t, worker_pool_t, rt_);
+DEFINE_WORKER_POOL_START_FUNCTION(entry_t, rt_ring_buffer_t, worker_pool_t, rt_);
+DEFINE_WORKER_POOL_HALT_FUNCTION(worker_pool_t, rt_);
+DEFINE_WORKER_POOL_JOIN_FUNCTION(worker_pool_t, rt_);
+
+DEFINE_BATCH_PROCESSOR_TYPE(entry_t, ring_buffer_t, batch_processor_t);
+DEFINE_BATCH_PROCESSOR_INIT_FUNCTION(entry_t, ring_buffer_t, batch_processor_t);
+DEFINE_BATCH_PROCESSOR_START_FUNCTION(entry_t, ring_buffer_t, batch_processor_t);
+DEFINE_BATCH_PROCESSOR_HALT_FUNCTION(batch_processor_t);
+DEFINE_BATCH_PROCESSOR_JOIN_FUNCTION(batch_processor_t);
+DEFINE_RING_SET_TYPE(ring_buffer_t, ring_set_t, RING_SET_SHARD_COUNT);
+DEFINE_RING_SET_INIT_FUNCTION(ring_buffer_t, ring_set_t);
+DEFINE_RING_SET_ROUTE_FUNCTION(ring_buffer_t, ring_set_t);
+DEFINE_RING_SET_INIT_PROCESSORS_FUNCTION(entry_t, ring_set_t, batch_processor_t);
+DEFINE_RING_SET_START_PROCESSORS_FUNCTION(ring_set_t, batch_processor_t);
+DEFINE_RING_SET_STOP_PROCESSORS_FUNCTION(ring_set_t, batch_processor_t);
+
+#if defined __linux__
+DEFINE_IO_CONTENT_TYPE(IO_DATAGRAM_SIZE, io_content_t);
+DEFINE_ENTRY_TYPE(io_content_t, net_entry_t);
+DEFINE_RING_BUFFER_TYPE(MAX_ENTRY_PROCESSORS, ENTRY_BUFFER_SIZE, net_entry_t, net_ring_buffer_t);
+DEFINE_RING_BUFFER_INIT(ENTRY_BUFFER_SIZE, net_ring_buffer_t, net_);
+DEFINE_RING_BUFFER_SHOW_ENTRY_FUNCTION(net_entry_t, net_ring_buffer_t, net_);
+DEFINE_RING_BUFFER_ACQUIRE_ENTRY_FUNCTION(net_entry_t, net_ring_buffer_t, net_);
+DEFINE_RING_BUFFER_ACQUIRE_SPANS_FUNCTION(net_entry_t, net_ring_buffer_t, net_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_REGISTER_FUNCTION(net_ring_buffer_t, net_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_UNREGISTER_FUNCTION(net_ring_buffer_t, net_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_WAITFOR_BLOCKING_FUNCTION(net_ring_buffer_t, net_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_RELEASEENTRY_FUNCTION(net_ring_buffer_t, net_);
+DEFINE_ENTRY_PUBLISHER_NEXTENTRIES_BLOCKING_FUNCTION(net_ring_buffer_t, net_);
+DEFINE_ENTRY_PUBLISHER_COMMITENTRIES_BLOCKING_FUNCTION(net_ring_buffer_t, net_);
+DEFINE_IO_RECVMMSG_FUNCTION(net_entry_t, net_ring_buffer_t, net_);
+
+struct net_ring_buffer_t net_ring_buffer;
+uint_fast64_t io_sum;
+#endif
 struct ring_buffer_t ring_buffer;
 struct timeval start;
 struct timeval end;
+uint_fast64_t payload_sum;
+struct worker_pool_t worker_pool;
+struct worker_sum_t {
+        uint_fast64_t sum;
+} __attribute__((aligned(CACHE_LINE_SIZE))) worker_sums[MAX_WORKERS];
+struct ring_set_t ring_set;
+struct batch_processor_t shard_processors[RING_SET_SHARD_COUNT];
+struct worker_sum_t shard_sums[RING_SET_SHARD_COUNT];
+struct scaling_publisher_t {
+        struct ring_set_t *ring_set; // NULL for the single ring buffer
+        uint_fast64_t first;
+        uint_fast64_t count;
+} scaling_publishers[MAX_SCALING_PUBLISHERS];
 
 static int
 create_thread(pthread_t * const thread_id,
@@ -102,24 +198,812 @@ out:
         return NULL;
 }
 
+static void*
+sp_entry_processor_thread(void *arg)
+{
+        struct cursor_t n;
+        struct sp_ring_buffer_t *buffer = (struct sp_ring_buffer_t*)arg;
+        struct cursor_t cursor;
+        struct cursor_t cursor_upper_limit;
+        struct count_t reg_number;
+        const struct entry_t *entry;
+
+        // register and setup entry processor
+        cursor.sequence = sp_entry_processor_barrier_register(buffer, &reg_number);
+        cursor_upper_limit.sequence = cursor.sequence;
+
+        do {
+                sp_entry_processor_barrier_wait_for_blocking(buffer, &cursor_upper_limit);
+                for (n.sequence = cursor.sequence; n.sequence <= cursor_upper_limit.sequence; ++n.sequence) { // batching
+                        entry = sp_ring_buffer_show_entry(buffer, &n);
+                        if (STOP == entry->content)
+                                goto out;
+                }
+                sp_entry_processor_barrier_release_entry(buffer, &reg_number, &cursor_upper_limit);
+
+                ++cursor_upper_limit.sequence;
+                cursor.sequence = cursor_upper_limit.sequence;
+        } while (1);
+out:
+        gettimeofday(&end, NULL);
+
+        sp_entry_processor_barrier_unregister(buffer, &reg_number);
+        printf("Entry processor done\n");
+
+        return NULL;
+}
+
+/*
+ * Defines a ring buffer, with entries as defined by entry_type_macro__
+ * holding content_type__, along with an entry processor thread that
+ * reads every word of each entry and a test function. The test
+ * function publishes ENTRIES_TO_GENERATE entries and returns the
+ * number of entries per second.
+ */
+#define DEFINE_PAYLOAD_TEST(entry_type_macro__, content_type__, prefix__)                                         \
+entry_type_macro__(content_type__, prefix__ ## entry_t);                                                          \
+DEFINE_RING_BUFFER_TYPE(MAX_ENTRY_PROCESSORS, ENTRY_BUFFER_SIZE, prefix__ ## entry_t, prefix__ ## ring_buffer_t); \
+DEFINE_RING_BUFFER_MALLOC(prefix__ ## ring_buffer_t, prefix__);                                                   \
+DEFINE_RING_BUFFER_INIT(ENTRY_BUFFER_SIZE, prefix__ ## ring_buffer_t, prefix__);                                  \
+DEFINE_RING_BUFFER_SHOW_ENTRY_FUNCTION(prefix__ ## entry_t, prefix__ ## ring_buffer_t, prefix__);                 \
+DEFINE_RING_BUFFER_ACQUIRE_ENTRY_FUNCTION(prefix__ ## entry_t, prefix__ ## ring_buffer_t, prefix__);              \
+DEFINE_ENTRY_PROCESSOR_BARRIER_REGISTER_FUNCTION(prefix__ ## ring_buffer_t, prefix__);                            \
+DEFINE_ENTRY_PROCESSOR_BARRIER_UNREGISTER_FUNCTION(prefix__ ## ring_buffer_t, prefix__);                          \
+DEFINE_ENTRY_PROCESSOR_BARRIER_WAITFOR_BLOCKING_FUNCTION(prefix__ ## ring_buffer_t, prefix__);                    \
+DEFINE_ENTRY_PROCESSOR_BARRIER_RELEASEENTRY_FUNCTION(prefix__ ## ring_buffer_t, prefix__);                        \
+DEFINE_ENTRY_PUBLISHER_NEXTENTRIES_BLOCKING_FUNCTION(prefix__ ## ring_buffer_t, prefix__);                        \
+DEFINE_ENTRY_PUBLISHER_COMMITENTRIES_BLOCKING_FUNCTION(prefix__ ## ring_buffer_t, prefix__);                      \
+                                                                                                                  \
+static void*                                                                                                      \
+prefix__ ## entry_processor_thread(void *arg)                                                                     \
+{                                                                                                                 \
+        struct prefix__ ## ring_buffer_t *buffer = (struct prefix__ ## ring_buffer_t*)arg;                        \
+        struct cursor_t cursor_upper_limit;                                                                       \
+        struct count_t reg_number;                                                                                \
+        uint_fast64_t first;                                                                                      \
+        uint_fast64_t sum = 0;                                                                                    \
+                                                                                                                  \
+        first = prefix__ ## entry_processor_barrier_register(buffer, &reg_number);                                \
+        PAYLOAD_PROCESS__(buffer, &reg_number, first, cursor_upper_limit,                                         \
+                          prefix__ ## entry_processor_barrier_wait_for_blocking(buffer, &cursor_upper_limit),     \
+                          sum, prefix__);                                                                         \
+        gettimeofday(&end, NULL);                                                                                 \
+        payload_sum += sum;                                                                                       \
+                                                                                                                  \
+        prefix__ ## entry_processor_barrier_unregister(buffer, &reg_number);                                      \
+        printf("Entry processor done\n");                                                                         \
+                                                                                                                  \
+        return NULL;                                                                                              \
+}                                                                                                                 \
+                                                                                                                  \
+static double                                                                                                     \
+prefix__ ## payload_test(const char * const name)                                                                 \
+{                                                                                                                 \
+        double start_time;                                                                                        \
+        double end_time;                                                                                          \
+        pthread_t thread_id;                                                                                      \
+        struct cursor_t n;                                                                                        \
+        struct cursor_t lo;                                                                                       \
+        struct cursor_t hi;                                                                                       \
+        struct prefix__ ## entry_t *entry;                                                                        \
+        struct prefix__ ## ring_buffer_t *buffer;                                                                 \
+        uint_fast64_t reps;                                                                                       \
+                                                                                                                  \
+        buffer = prefix__ ## ring_buffer_malloc();                                                                \
+        if (!buffer) {                                                                                            \
+                printf("Malloc ring buffer - ERROR\n");                                                           \
+                exit(EXIT_FAILURE);                                                                               \
+        }                                                                                                         \
+        prefix__ ## ring_buffer_init(buffer);                                                                     \
+        if (!create_thread(&thread_id, buffer, prefix__ ## entry_processor_thread)) {                             \
+                printf("could not create entry processor thread\n");                                              \
+                exit(EXIT_FAILURE);                                                                               \
+        }                                                                                                         \
+                                                                                                                  \
+        reps = ENTRIES_TO_GENERATE / PAYLOAD_BATCH_SIZE;                                                          \
+        gettimeofday(&start, NULL);                                                                               \
+        do {                                                                                                      \
+                prefix__ ## publisher_next_entries_blocking(buffer, PAYLOAD_BATCH_SIZE, &lo, &hi);                \
+                for (n.sequence = lo.sequence; n.sequence <= hi.sequence; ++n.sequence) {                         \
+                        entry = prefix__ ## ring_buffer_acquire_entry(buffer, &n);                                \
+                        PAYLOAD_WRITE__(entry, n.sequence);                                                       \
+                }                                                                                                 \
+                prefix__ ## publisher_commit_entries_blocking(buffer, &lo, &hi);                                  \
+        } while (--reps);                                                                                         \
+                                                                                                                  \
+        prefix__ ## publisher_next_entries_blocking(buffer, 1, &lo, &hi);                                         \
+        entry = prefix__ ## ring_buffer_acquire_entry(buffer, &lo);                                               \
+        entry->content[0] = STOP;                                                                                 \
+        prefix__ ## publisher_commit_entries_blocking(buffer, &lo, &hi);                                          \
+                                                                                                                  \
+        /* join entry processor */                                                                                \
+        pthread_join(thread_id, NULL);                                                                            \
+        printf("Publisher done\n");                                                                               \
+        free(buffer);                                                                                             \
+                                                                                                                  \
+        start_time = (double)start.tv_sec + (double)start.tv_usec/1000000.0;                                      \
+        end_time = (double)end.tv_sec + (double)end.tv_usec/1000000.0;                                            \
+        printf("Elapsed time = %lf seconds\n", end_time - start_time);                                            \
+        printf("Entries per second %lf\n", (double)ENTRIES_TO_GENERATE/(end_time - start_time));                  \
+        printf("%s test done\n\n", name);                                                                         \
+                                                                                                                  \
+        return (double)ENTRIES_TO_GENERATE/(end_time - start_time);                                               \
+}
+
+DEFINE_PAYLOAD_TEST(DEFINE_ENTRY_TYPE, payload8_t, padded8_);
+DEFINE_PAYLOAD_TEST(DEFINE_PACKED_ENTRY_TYPE, payload8_t, packed8_);
+DEFINE_PAYLOAD_TEST(DEFINE_ENTRY_TYPE, payload16_t, padded16_);
+DEFINE_PAYLOAD_TEST(DEFINE_PACKED_ENTRY_TYPE, payload16_t, packed16_);
+DEFINE_PAYLOAD_TEST(DEFINE_ENTRY_TYPE, payload32_t, padded32_);
+DEFINE_PAYLOAD_TEST(DEFINE_PACKED_ENTRY_TYPE, payload32_t, packed32_);
+
+/*
+ * Publishes ENTRIES_TO_GENERATE entries into a single publisher ring
+ * buffer and returns the number of entries per second.
+ */
+static double
+sp_test(struct sp_ring_buffer_t * const buffer,
+        const int blocking)
+{
+        double start_time;
+        double end_time;
+        pthread_t thread_id;
+        struct cursor_t cursor;
+        struct entry_t *entry;
+        uint_fast64_t reps;
+
+        sp_ring_buffer_init(buffer);
+        if (!create_thread(&thread_id, buffer, sp_entry_processor_thread)) {
+                printf("could not create entry processor thread\n");
+                exit(EXIT_FAILURE);
+        }
+
+        reps = ENTRIES_TO_GENERATE;
+        gettimeofday(&start, NULL);
+        if (blocking) {
+                do {
+                        sp_publisher_next_entry_blocking(buffer, &cursor);
+                        entry = sp_ring_buffer_acquire_entry(buffer, &cursor);
+                        entry->content = cursor.sequence;
+                        sp_publisher_commit_entry_blocking(buffer, &cursor);
+                } while (--reps);
+        } else {
+                do {
+                        while (!sp_publisher_next_entry_nonblocking(buffer, &cursor))
+                                ;
+                        entry = sp_ring_buffer_acquire_entry(buffer, &cursor);
+                        entry->content = cursor.sequence;
+                        sp_publisher_commit_entry_blocking(buffer, &cursor);
+                } while (--reps);
+        }
+
+        sp_publisher_next_entry_blocking(buffer, &cursor);
+        entry = sp_ring_buffer_acquire_entry(buffer, &cursor);
+        entry->content = STOP;
+        sp_publisher_commit_entry_blocking(buffer, &cursor);
+
+        // join entry processor
+        pthread_join(thread_id, NULL);
+        printf("Publisher done\n");
+
+        start_time = (double)start.tv_sec + (double)start.tv_usec/1000000.0;
+        end_time = (double)end.tv_sec + (double)end.tv_usec/1000000.0;
+        printf("Elapsed time = %lf seconds\n", end_time - start_time);
+        printf("Entries per second %lf\n", (double)ENTRIES_TO_GENERATE/(end_time - start_time));
+        printf("Single-Publisher %s test done\n\n", blocking ? "blocking" : "non-blocking");
+
+        return (double)ENTRIES_TO_GENERATE/(end_time - start_time);
+}
+
+static void*
+rt_entry_processor_thread(void *arg)
+{
+        struct cursor_t n;
+        struct rt_ring_buffer_t *buffer = (struct rt_ring_buffer_t*)arg;
+        struct cursor_t cursor;
+        struct cursor_t cursor_upper_limit;
+        struct count_t reg_number;
+        const struct entry_t *entry;
+
+        // register and setup entry processor
+        cursor.sequence = rt_entry_processor_barrier_register(buffer, &reg_number);
+        cursor_upper_limit.sequence = cursor.sequence;
+
+        do {
+                rt_entry_processor_barrier_wait_for_blocking(buffer, &cursor_upper_limit);
+                for (n.sequence = cursor.sequence; n.sequence <= cursor_upper_limit.sequence; ++n.sequence) { // batching
+                        entry = rt_ring_buffer_show_entry(buffer, &n);
+                        if (STOP == entry->content)
+                                goto out;
+                }
+                rt_entry_processor_barrier_release_entry(buffer, &reg_number, &cursor_upper_limit);
+
+                ++cursor_upper_limit.sequence;
+                cursor.sequence = cursor_upper_limit.sequence;
+        } while (1);
+out:
+        gettimeofday(&end, NULL);
+
+        rt_entry_processor_barrier_unregister(buffer, &reg_number);
+        printf("Entry processor done\n");
+
+        return NULL;
+}
+
+/*
+ * Publishes ENTRIES_TO_GENERATE entries into a ring buffer sized at
+ * run time and returns the number of entries per second.
+ */
+static double
+runtime_test(struct rt_ring_buffer_t * const buffer,
+             const int blocking)
+{
+        double start_time;
+        double end_time;
+        pthread_t thread_id;
+        struct cursor_t cursor;
+        struct entry_t *entry;
+        uint_fast64_t reps;
+
+        rt_ring_buffer_init(buffer);
+        if (!create_thread(&thread_id, buffer, rt_entry_processor_thread)) {
+                printf("could not create entry processor thread\n");
+                exit(EXIT_FAILURE);
+        }
+
+        reps = ENTRIES_TO_GENERATE;
+        gettimeofday(&start, NULL);
+        if (blocking) {
+                do {
+                        rt_publisher_next_entry_blocking(buffer, &cursor);
+                        entry = rt_ring_buffer_acquire_entry(buffer, &cursor);
+                        entry->content = cursor.sequence;
+                        rt_publisher_commit_entry_blocking(buffer, &cursor);
+                } while (--reps);
+        } else {
+                do {
+                        while (!rt_publisher_next_entry_nonblocking(buffer, &cursor))
+                                ;
+                        entry = rt_ring_buffer_acquire_entry(buffer, &cursor);
+                        entry->content = cursor.sequence;
+                        rt_publisher_commit_entry_blocking(buffer, &cursor);
+                } while (--reps);
+        }
+
+        rt_publisher_next_entry_blocking(buffer, &cursor);
+        entry = rt_ring_buffer_acquire_entry(buffer, &cursor);
+        entry->content = STOP;
+        rt_publisher_commit_entry_blocking(buffer, &cursor);
+
+        // join entry processor
+        pthread_join(thread_id, NULL);
+        printf("Publisher done\n");
+
+        start_time = (double)start.tv_sec + (double)start.tv_usec/1000000.0;
+        end_time = (double)end.tv_sec + (double)end.tv_usec/1000000.0;
+        printf("Elapsed time = %lf seconds\n", end_time - start_time);
+        printf("Entries per second %lf\n", (double)ENTRIES_TO_GENERATE/(end_time - start_time));
+        printf("Runtime-Sized %s test done\n\n", blocking ? "blocking" : "non-blocking");
+
+        return (double)ENTRIES_TO_GENERATE/(end_time - start_time);
+}
+
+/*
+ * Lets an entry processor wait for one second on an empty ring
+ * buffer and then publishes ENTRIES_TO_GENERATE entries, all with the
+ * given wait strategy and, if adaptive, the adaptive spin budget.
+ * Returns the number of entries per second and the CPU time used by
+ * the idle entry processor in percent of the one second.
+ */
+static double
+wait_strategy_test(struct ring_buffer_t * const buffer,
+                   const uint_fast32_t wait_strategy,
+                   const int adaptive,
+                   const char * const name,
+                   double * const idle_cpu)
+{
+        double start_time;
+        double end_time;
+        struct rusage usage_before;
+        struct rusage usage_after;
+        pthread_t thread_id;
+        struct cursor_t cursor;
+        struct entry_t *entry;
+        uint_fast64_t reps;
+
+        ring_buffer_init(buffer);
+        ring_buffer_set_wait_strategy(buffer, wait_strategy);
+        if (adaptive)
+                ring_buffer_set_spin_budget(buffer, BUILTIN_SPIN_NANOSECONDS__, 1);
+        if (!create_thread(&thread_id, buffer, entry_processor_thread)) {
+                printf("could not create entry processor thread\n");
+                exit(EXIT_FAILURE);
+        }
+
+        // the publisher sleeps, so all CPU time used is the entry processor waiting
+        getrusage(RUSAGE_SELF, &usage_before);
+        sleep(1);
+        getrusage(RUSAGE_SELF, &usage_after);
+        *idle_cpu = 100.0 * (((double)usage_after.ru_utime.tv_sec + (double)usage_after.ru_utime.tv_usec/1000000.0
+                              + (double)usage_after.ru_stime.tv_sec + (double)usage_after.ru_stime.tv_usec/1000000.0)
+                             - ((double)usage_before.ru_utime.tv_sec + (double)usage_before.ru_utime.tv_usec/1000000.0
+                                + (double)usage_before.ru_stime.tv_sec + (double)usage_before.ru_stime.tv_usec/1000000.0));
+
+        reps = ENTRIES_TO_GENERATE;
+        gettimeofday(&start, NULL);
+        do {
+                publisher_next_entry_blocking(buffer, &cursor);
+                entry = ring_buffer_acquire_entry(buffer, &cursor);
+                entry->content = cursor.sequence;
+                publisher_commit_entry_blocking(buffer, &cursor);
+        } while (--reps);
+
+        publisher_next_entry_blocking(buffer, &cursor);
+        entry = ring_buffer_acquire_entry(buffer, &cursor);
+        entry->content = STOP;
+        publisher_commit_entry_blocking(buffer, &cursor);
+
+        // join entry processor
+        pthread_join(thread_id, NULL);
+        printf("Publisher done\n");
+
+        start_time = (double)start.tv_sec + (double)start.tv_usec/1000000.0;
+        end_time = (double)end.tv_sec + (double)end.tv_usec/1000000.0;
+        printf("Elapsed time = %lf seconds\n", end_time - start_time);
+        printf("Entries per second %lf\n", (double)ENTRIES_TO_GENERATE/(end_time - start_time));
+        printf("Idle entry processor CPU usage %.1lf%%\n", *idle_cpu);
+        printf("Wait strategy %s test done\n\n", name);
+
+        return (double)ENTRIES_TO_GENERATE/(end_time - start_time);
+}
+
+/*
+ * Publishes ENTRIES_TO_GENERATE entries in batches of batch_size
+ * entries and returns the number of entries per second.
+ */
+static double
+batch_test(struct ring_buffer_t * const buffer,
+           const uint_fast64_t batch_size)
+{
+        double start_time;
+        double end_time;
+        pthread_t thread_id;
+        struct cursor_t n;
+        struct cursor_t lo;
+        struct cursor_t hi;
+        struct cursor_t cursor;
+        struct entry_t *entry;
+        uint_fast64_t count;
+        uint_fast64_t reps;
+
+        ring_buffer_init(buffer);
+        if (!create_thread(&thread_id, buffer, entry_processor_thread)) {
+                printf("could not create entry processor thread\n");
+                exit(EXIT_FAILURE);
+        }
+
+        reps = ENTRIES_TO_GENERATE;
+        gettimeofday(&start, NULL);
+        do {
+                count = (reps < batch_size) ? reps : batch_size;
+                publisher_next_entries_blocking(buffer, count, &lo, &hi);
+                for (n.sequence = lo.sequence; n.sequence <= hi.sequence; ++n.sequence) {
+                        entry = ring_buffer_acquire_entry(buffer, &n);
+                        entry->content = n.sequence;
+                }
+                publisher_commit_entries_blocking(buffer, &lo, &hi);
+                reps -= count;
+        } while (reps);
+
+        publisher_next_entry_blocking(buffer, &cursor);
+        entry = ring_buffer_acquire_entry(buffer, &cursor);
+        entry->content = STOP;
+        publisher_commit_entry_blocking(buffer, &cursor);
+
+        // join entry processor
+        pthread_join(thread_id, NULL);
+        printf("Publisher done\n");
+
+        start_time = (double)start.tv_sec + (double)start.tv_usec/1000000.0;
+        end_time = (double)end.tv_sec + (double)end.tv_usec/1000000.0;
+        printf("Elapsed time = %lf seconds\n", end_time - start_time);
+        printf("Entries per second %lf\n", (double)ENTRIES_TO_GENERATE/(end_time - start_time));
+        printf("Batch size %" PRIuFAST64 " test done\n\n", batch_size);
+
+        return (double)ENTRIES_TO_GENERATE/(end_time - start_time);
+}
+
+/*
+ * A CPU-heavy handler, so that the worker pool has work to share.
+ */
+static int
+worker_on_entry(const struct entry_t *entry,
+                uint_fast64_t sequence,
+                unsigned int worker,
+                void *context)
+{
+        uint_fast64_t x = entry->content;
+        unsigned int n;
+
+        (void)sequence;
+        (void)context;
+        if (STOP == x) {
+                rt_worker_pool_halt(&worker_pool);
+                return 0;
+        }
+        for (n = 0; n < WORKER_ROUNDS; ++n) {
+                x ^= x << 13;
+                x ^= x >> 7;
+                x ^= x << 17;
+        }
+        worker_sums[worker].sum += x;
+
+        return 0;
+}
+
+/*
+ * Publishes WORKER_ENTRIES_TO_GENERATE entries into a runtime-sized
+ * ring buffer handled by a pool of workers and returns the number of
+ * entries per second.
+ */
+static double
+worker_pool_test(struct rt_ring_buffer_t * const buffer,
+                 const unsigned int workers)
+{
+        double start_time;
+        double end_time;
+        struct cursor_t cursor;
+        struct entry_t *entry;
+        uint_fast64_t reps;
+
+        rt_ring_buffer_init(buffer);
+        rt_worker_pool_init(&worker_pool, buffer, workers, worker_on_entry, NULL);
+        if (!rt_worker_pool_start(&worker_pool)) {
+                printf("could not start worker pool\n");
+                exit(EXIT_FAILURE);
+        }
+
+        reps = WORKER_ENTRIES_TO_GENERATE;
+        gettimeofday(&start, NULL);
+        do {
+                rt_publisher_next_entry_blocking(buffer, &cursor);
+                entry = rt_ring_buffer_acquire_entry(buffer, &cursor);
+                entry->content = cursor.sequence;
+                rt_publisher_commit_entry_blocking(buffer, &cursor);
+        } while (--reps);
+
+        rt_publisher_next_entry_blocking(buffer, &cursor);
+        entry = rt_ring_buffer_acquire_entry(buffer, &cursor);
+        entry->content = STOP;
+        rt_publisher_commit_entry_blocking(buffer, &cursor);
+
+        rt_worker_pool_join(&worker_pool);
+        gettimeofday(&end, NULL);
+
+        start_time = (double)start.tv_sec + (double)start.tv_usec/1000000.0;
+        end_time = (double)end.tv_sec + (double)end.tv_usec/1000000.0;
+        printf("Elapsed time = %lf seconds\n", end_time - start_time);
+        printf("Entries per second %lf\n", (double)WORKER_ENTRIES_TO_GENERATE/(end_time - start_time));
+        printf("Worker pool of %u test done\n\n", workers);
+
+        return (double)WORKER_ENTRIES_TO_GENERATE/(end_time - start_time);
+}
+
+/*
+ * Publishes the entries given, keyed by their content.
+ */
+static void*
+scaling_publisher_thread(void *arg)
+{
+        const struct scaling_publisher_t * const publisher = (const struct scaling_publisher_t*)arg;
+        struct ring_buffer_t *buffer = &ring_buffer;
+        struct cursor_t cursor;
+        uint_fast64_t n;
+
+        for (n = publisher->first; n < publisher->first + publisher->count; ++n) {
+                if (publisher->ring_set)
+                        buffer = ring_set_route(publisher->ring_set, n);
+                publisher_next_entry_blocking(buffer, &cursor);
+                ring_buffer_acquire_entry(buffer, &cursor)->content = n;
+                publisher_commit_entry_blocking(buffer, &cursor);
+        }
+
+        return NULL;
+}
+
+static int
+scaling_on_entry(const struct entry_t *entry,
+                 uint_fast64_t sequence,
+                 int end_of_batch,
+                 void *context)
+{
+        (void)sequence;
+        (void)end_of_batch;
+        ((struct worker_sum_t*)context)->sum += entry->content;
+
+        return 0;
+}
+
+/*
+ * Publishes SCALING_ENTRIES_TO_GENERATE entries from publishers
+ * threads into either the single ring buffer, processed by a batch
+ * processor, or a ring set, each shard processed by a batch processor
+ * of its own. Returns the number of entries per second.
+ */
+static double
+scaling_test(const unsigned int publishers,
+             const int sharded)
+{
+        double start_time;
+        double end_time;
+        pthread_t thread_ids[MAX_SCALING_PUBLISHERS];
+        unsigned int n;
+
+        memset(shard_sums, 0, sizeof(shard_sums));
+        ring_set_init(&ring_set);
+        if (sharded) {
+                ring_set_init_processors(&ring_set, shard_processors, scaling_on_entry, NULL);
+                for (n = 0; n < RING_SET_SHARD_COUNT; ++n)
+                        shard_processors[n].context = &shard_sums[n];
+        } else {
+                ring_buffer_init(&ring_buffer);
+                batch_processor_init(&shard_processors[0], &ring_buffer, scaling_on_entry, &shard_sums[0]);
+        }
+        if (sharded ? !ring_set_start_processors(&ring_set, shard_processors) : !batch_processor_start(&shard_processors[0])) {
+                printf("could not start batch processors\n");
+                exit(EXIT_FAILURE);
+        }
+
+        gettimeofday(&start, NULL);
+        for (n = 0; n < publishers; ++n) {
+                scaling_publishers[n].ring_set = sharded ? &ring_set : NULL;
+                scaling_publishers[n].first = n * (SCALING_ENTRIES_TO_GENERATE / publishers);
+                scaling_publishers[n].count = SCALING_ENTRIES_TO_GENERATE / publishers;
+                if (!create_thread(&thread_ids[n], &scaling_publishers[n], scaling_publisher_thread)) {
+                        printf("could not create publisher thread\n");
+                        exit(EXIT_FAILURE);
+                }
+        }
+        for (n = 0; n < publishers; ++n)
+                pthread_join(thread_ids[n], NULL);
+        if (sharded) {
+                ring_set_stop_processors(&ring_set, shard_processors);
+        } else {
+                WAIT_UNTIL__(&ring_buffer,
+                             __atomic_load_n(&ring_buffer.entry_processor_cursors[shard_processors[0].entry_processor_number.count].sequence, __ATOMIC_ACQUIRE)
+                             >= ring_buffer.write_cursor.sequence,
+                             empty_waits);
+                batch_processor_halt(&shard_processors[0]);
+                batch_processor_join(&shard_processors[0]);
+        }
+        gettimeofday(&end, NULL);
+
+        for (n = 0; n < RING_SET_SHARD_COUNT; ++n)
+                payload_sum += shard_sums[n].sum;
+        start_time = (double)start.tv_sec + (double)start.tv_usec/1000000.0;
+        end_time = (double)end.tv_sec + (double)end.tv_usec/1000000.0;
+        printf("Elapsed time = %lf seconds\n", end_time - start_time);
+        printf("Entries per second %lf\n", (double)SCALING_ENTRIES_TO_GENERATE/(end_time - start_time));
+        printf("%s with %u publishers test done\n\n", sharded ? "Ring set" : "Ring buffer", publishers);
+
+        return (double)SCALING_ENTRIES_TO_GENERATE/(end_time - start_time);
+}
+
+#if defined __linux__
+/*
+ * Sends IO_DATAGRAMS_TO_GENERATE datagrams, IO_MAX_BATCH at a time.
+ */
+static void*
+io_sender_thread(void *arg)
+{
+        static uint8_t data[IO_MAX_BATCH][IO_DATAGRAM_SIZE];
+        const int fd = *(int*)arg;
+        struct mmsghdr msgs[IO_MAX_BATCH];
+        struct iovec iov[IO_MAX_BATCH];
+        uint_fast64_t reps;
+        unsigned int n;
+        int retv;
+
+        memset(msgs, 0, sizeof(msgs));
+        for (n = 0; n < IO_MAX_BATCH; ++n) {
+                memset(data[n], (int)n, IO_DATAGRAM_SIZE);
+                iov[n].iov_base = data[n];
+                iov[n].iov_len = IO_DATAGRAM_SIZE;
+                msgs[n].msg_hdr.msg_iov = &iov[n];
+                msgs[n].msg_hdr.msg_iovlen = 1;
+        }
+        for (reps = IO_DATAGRAMS_TO_GENERATE; reps; reps -= IO_MAX_BATCH) {
+                for (n = 0; n < IO_MAX_BATCH; n += (unsigned int)retv) {
+                        retv = sendmmsg(fd, &msgs[n], IO_MAX_BATCH - n, 0);
+                        if (0 > retv) {
+                                printf("could not send datagrams\n");
+                                exit(EXIT_FAILURE);
+                        }
+                }
+        }
+
+        return NULL;
+}
+
+/*
+ * Reads every byte of IO_DATAGRAMS_TO_GENERATE entries.
+ */
+static void*
+io_entry_processor_thread(void *arg)
+{
+        struct net_ring_buffer_t *buffer = (struct net_ring_buffer_t*)arg;
+        const struct net_entry_t *entry;
+        struct cursor_t n;
+        struct cursor_t cursor;
+        struct cursor_t cursor_upper_limit;
+        struct count_t reg_number;
+        uint_fast64_t reps = IO_DATAGRAMS_TO_GENERATE;
+        uint_fast64_t sum = 0;
+        unsigned int k;
+
+        cursor.sequence = net_entry_processor_barrier_register(buffer, &reg_number);
+        do {
+                cursor_upper_limit.sequence = cursor.sequence;
+                net_entry_processor_barrier_wait_for_blocking(buffer, &cursor_upper_limit);
+                for (n.sequence = cursor.sequence; n.sequence <= cursor_upper_limit.sequence; ++n.sequence) {
+                        entry = net_ring_buffer_show_entry(buffer, &n);
+                        for (k = 0; k < entry->content.length; ++k)
+                                sum += entry->content.data[k];
+                        --reps;
+                }
+                net_entry_processor_barrier_release_entry(buffer, &reg_number, &cursor_upper_limit);
+                cursor.sequence = cursor_upper_limit.sequence + 1;
+        } while (reps);
+        gettimeofday(&end, NULL);
+        net_entry_processor_barrier_unregister(buffer, &reg_number);
+        io_sum += sum;
+        printf("Entry processor done\n");
+
+        return NULL;
+}
+
+/*
+ * Publishes IO_DATAGRAMS_TO_GENERATE datagrams from a socket pair,
+ * either received into a buffer of their own and copied into the
+ * entries or received straight into the entries, and returns the
+ * number of entries per second.
+ */
+static double
+io_test(struct net_ring_buffer_t * const buffer,
+        const int copy)
+{
+        static uint8_t data[IO_MAX_BATCH][IO_DATAGRAM_SIZE];
+        double start_time;
+        double end_time;
+        pthread_t thread_id;
+        pthread_t sender_id;
+        struct mmsghdr msgs[IO_MAX_BATCH];
+        struct iovec iov[IO_MAX_BATCH];
+        struct cursor_t n;
+        struct cursor_t lo;
+        struct cursor_t hi;
+        struct net_entry_t *entry;
+        uint_fast64_t reps;
+        unsigned int k;
+        int fds[2];
+        int retv;
+
+        if (socketpair(AF_UNIX, SOCK_DGRAM, 0, fds)) {
+                printf("could not create socket pair\n");
+                exit(EXIT_FAILURE);
+        }
+        memset(msgs, 0, sizeof(msgs));
+        for (k = 0; k < IO_MAX_BATCH; ++k) {
+                iov[k].iov_base = data[k];
+                iov[k].iov_len = IO_DATAGRAM_SIZE;
+                msgs[k].msg_hdr.msg_iov = &iov[k];
+                msgs[k].msg_hdr.msg_iovlen = 1;
+        }
+        net_ring_buffer_init(buffer);
+        if (!create_thread(&thread_id, buffer, io_entry_processor_thread)) {
+                printf("could not create entry processor thread\n");
+                exit(EXIT_FAILURE);
+        }
+        sleep(1);
+
+        gettimeofday(&start, NULL);
+        if (!create_thread(&sender_id, &fds[0], io_sender_thread)) {
+                printf("could not create sender thread\n");
+                exit(EXIT_FAILURE);
+        }
+        for (reps = IO_DATAGRAMS_TO_GENERATE; reps; reps -= (uint_fast64_t)retv) {
+                if (copy) {
+                        retv = recvmmsg(fds[1], msgs, IO_MAX_BATCH, MSG_WAITFORONE, NULL);
+                        if (0 >= retv)
+                                break;
+                        net_publisher_next_entries_blocking(buffer, (uint_fast64_t)retv, &lo, &hi);
+                        for (k = 0, n.sequence = lo.sequence; n.sequence <= hi.sequence; ++k, ++n.sequence) {
+                                entry = net_ring_buffer_acquire_entry(buffer, &n);
+                                entry->content.length = msgs[k].msg_len;
+                                memcpy(entry->content.data, data[k], msgs[k].msg_len);
+                        }
+                        net_publisher_commit_entries_blocking(buffer, &lo, &hi);
+                } else {
+                        retv = net_io_recvmmsg(buffer, fds[1], IO_MAX_BATCH, MSG_WAITFORONE);
+                        if (0 >= retv)
+                                break;
+                }
+        }
+        if (reps) {
+                printf("could not receive datagrams\n");
+                exit(EXIT_FAILURE);
+        }
+
+        pthread_join(sender_id, NULL);
+        pthread_join(thread_id, NULL);
+        printf("Publisher done\n");
+        close(fds[0]);
+        close(fds[1]);
+
+        start_time = (double)start.tv_sec + (double)start.tv_usec/1000000.0;
+        end_time = (double)end.tv_sec + (double)end.tv_usec/1000000.0;
+        printf("Elapsed time = %lf seconds\n", end_time - start_time);
+        printf("Entries per second %lf\n", (double)IO_DATAGRAMS_TO_GENERATE/(end_time - start_time));
+        printf("%s datagrams test done\n\n", copy ? "Copied" : "Zero-copy");
+
+        return (double)IO_DATAGRAMS_TO_GENERATE/(end_time - start_time);
+}
+#endif
+
 int
 main(int argc, char *argv[])
 {
         double start_time;
         double end_time;
         double avg_entries_per_second = 0.0;
+        double batch_entries_per_second[4];
+        double mpmc_entries_per_second[2];
+        double sp_entries_per_second[2];
+        double rt_entries_per_second[2];
+        double large_entries_per_second[2];
+        double wait_entries_per_second[5];
+        double wait_idle_cpu[5];
+        double padded_entries_per_second[3];
+        double packed_entries_per_second[3];
+        double worker_entries_per_second[5];
+        double scaling_entries_per_second[6][2];
+#if defined __linux__
+        double io_entries_per_second[2];
+#endif
+        const unsigned int payload_sizes[3] = { sizeof(payload8_t), sizeof(payload16_t), sizeof(payload32_t) };
+        const uint_fast32_t wait_strategies[5] = { WAIT_STRATEGY_BUSY_SPIN, WAIT_STRATEGY_YIELD, WAIT_STRATEGY_BLOCKING, WAIT_STRATEGY_TIMED, WAIT_STRATEGY_YIELD };
+        const int wait_adaptive[5] = { 0, 0, 0, 0, 1 };
+        const char * const wait_strategy_names[5] = { "busy-spin", "yield", "blocking", "timed", "adaptive" };
+        const uint_fast64_t batch_sizes[4] = { 1, 8, 64, 256 };
+        const unsigned int worker_counts[5] = { 1, 2, 4, 8, 16 };
+        const unsigned int publisher_counts[6] = { 1, 2, 4, 8, 16, 32 };
+        uint_fast64_t worker_sum = 0;
+        unsigned int n;
         pthread_t thread_id; // consumer/entry processor
         struct cursor_t cursor;
         struct entry_t *entry;
         uint_fast64_t reps;
         struct ring_buffer_t *ring_buffer_heap;
         struct ring_buffer_t ring_buffer_stack;
+        struct sp_ring_buffer_t *sp_ring_buffer_heap;
+        struct rt_ring_buffer_t *rt_ring_buffer_heap;
+        struct rt_ring_buffer_t *rt_ring_buffer_large;
 
         ring_buffer_heap = ring_buffer_malloc();
         if (!ring_buffer_heap) {
                 printf("Malloc ring buffer - ERROR\n");
                 return EXIT_FAILURE;
         }
+        sp_ring_buffer_heap = sp_ring_buffer_malloc();
+        if (!sp_ring_buffer_heap) {
+                printf("Malloc ring buffer - ERROR\n");
+                return EXIT_FAILURE;
+        }
+        rt_ring_buffer_heap = rt_ring_buffer_malloc(ENTRY_BUFFER_SIZE, MAX_ENTRY_PROCESSORS);
+        if (!rt_ring_buffer_heap) {
+                printf("Malloc ring buffer - ERROR\n");
+                return EXIT_FAILURE;
+        }
 
         ////////////////////////////////////////////////////////////////////////////////////////
         //                global variable with a non-blocking next_entry test
@@ -305,6 +1189,7 @@ main(int argc, char *argv[])
         printf("Entries per second %lf\n", (double)ENTRIES_TO_GENERATE/(end_time - start_time));
         printf("On-The-Heap non-blocking test done\n\n");
         avg_entries_per_second += (double)ENTRIES_TO_GENERATE/(end_time - start_time);
+        mpmc_entries_per_second[0] = (double)ENTRIES_TO_GENERATE/(end_time - start_time);
 
 
         ////////////////////////////////////////////////////////////////////////////////////////
@@ -341,10 +1226,148 @@ main(int argc, char *argv[])
         printf("Entries per second %lf\n", (double)ENTRIES_TO_GENERATE/(end_time - start_time));
         printf("On-The-Heap blocking test done\n");
         avg_entries_per_second += (double)ENTRIES_TO_GENERATE/(end_time - start_time);
+        mpmc_entries_per_second[1] = (double)ENTRIES_TO_GENERATE/(end_time - start_time);
 
         avg_entries_per_second /= 6.0;
         printf("\n\nAverage number of entries per second: %lf\n\n", avg_entries_per_second);
 
 
+        ////////////////////////////////////////////////////////////////////////////////////////
+        //         heap allocated with batched next_entries and commit_entries
+        ////////////////////////////////////////////////////////////////////////////////////////
+
+        for (n = 0; n < sizeof(batch_sizes)/sizeof(batch_sizes[0]); ++n)
+                batch_entries_per_second[n] = batch_test(ring_buffer_heap, batch_sizes[n]);
+
+        for (n = 0; n < sizeof(batch_sizes)/sizeof(batch_sizes[0]); ++n)
+                printf("Batch size %3" PRIuFAST64 ": %lf entries per second\n", batch_sizes[n], batch_entries_per_second[n]);
+        printf("\n");
+
+
+        ////////////////////////////////////////////////////////////////////////////////////////
+        //        single publisher ring buffer on the heap compared to the MPMC one
+        ////////////////////////////////////////////////////////////////////////////////////////
+
+        sp_entries_per_second[0] = sp_test(sp_ring_buffer_heap, 0);
+        sp_entries_per_second[1] = sp_test(sp_ring_buffer_heap, 1);
+
+        printf("Non-blocking: MPMC %lf vs. Single-Publisher %lf entries per second\n", mpmc_entries_per_second[0], sp_entries_per_second[0]);
+        printf("Blocking:     MPMC %lf vs. Single-Publisher %lf entries per second\n\n", mpmc_entries_per_second[1], sp_entries_per_second[1]);
+
+
+        ////////////////////////////////////////////////////////////////////////////////////////
+        //        ring buffer sized at run time on the heap compared to the MPMC one
+        ////////////////////////////////////////////////////////////////////////////////////////
+
+        rt_entries_per_second[0] = runtime_test(rt_ring_buffer_heap, 0);
+        rt_entries_per_second[1] = runtime_test(rt_ring_buffer_heap, 1);
+
+        printf("Non-blocking: MPMC %lf vs. Runtime-Sized %lf entries per second\n", mpmc_entries_per_second[0], rt_entries_per_second[0]);
+        printf("Blocking:     MPMC %lf vs. Runtime-Sized %lf entries per second\n\n", mpmc_entries_per_second[1], rt_entries_per_second[1]);
+
+
+        ////////////////////////////////////////////////////////////////////////////////////////
+        //          large ring buffer on ordinary pages vs. pre-faulted huge pages
+        ////////////////////////////////////////////////////////////////////////////////////////
+
+        rt_ring_buffer_large = rt_ring_buffer_malloc(LARGE_ENTRY_BUFFER_SIZE, MAX_ENTRY_PROCESSORS);
+        if (!rt_ring_buffer_large) {
+                printf("Malloc ring buffer - ERROR\n");
+                return EXIT_FAILURE;
+        }
+        large_entries_per_second[0] = runtime_test(rt_ring_buffer_large, 1);
+        free(rt_ring_buffer_large);
+
+        rt_ring_buffer_large = rt_ring_buffer_mmap(LARGE_ENTRY_BUFFER_SIZE, MAX_ENTRY_PROCESSORS,
+                                                   RING_BUFFER_MAP_HUGETLB | RING_BUFFER_MAP_PREFAULT, RING_BUFFER_ANY_NUMA_NODE);
+        if (!rt_ring_buffer_large) {
+                printf("Map ring buffer - ERROR\n");
+                return EXIT_FAILURE;
+        }
+        large_entries_per_second[1] = runtime_test(rt_ring_buffer_large, 1);
+        rt_ring_buffer_munmap(rt_ring_buffer_large, RING_BUFFER_MAP_HUGETLB | RING_BUFFER_MAP_PREFAULT);
+
+        printf("Large ring buffer: ordinary pages %lf vs. huge pages %lf entries per second\n\n", large_entries_per_second[0], large_entries_per_second[1]);
+
+
+        ////////////////////////////////////////////////////////////////////////////////////////
+        //                  heap allocated with each of the wait strategies
+        ////////////////////////////////////////////////////////////////////////////////////////
+
+        for (n = 0; n < sizeof(wait_strategies)/sizeof(wait_strategies[0]); ++n)
+                wait_entries_per_second[n] = wait_strategy_test(ring_buffer_heap, wait_strategies[n], wait_adaptive[n], wait_strategy_names[n], &wait_idle_cpu[n]);
+
+        for (n = 0; n < sizeof(wait_strategies)/sizeof(wait_strategies[0]); ++n)
+                printf("Wait strategy %-9s: %lf entries per second, %5.1lf%% idle CPU\n", wait_strategy_names[n], wait_entries_per_second[n], wait_idle_cpu[n]);
+        printf("\n");
+
+
+        ////////////////////////////////////////////////////////////////////////////////////////
+        //               padded vs. packed entries with small payloads
+        ////////////////////////////////////////////////////////////////////////////////////////
+
+        padded_entries_per_second[0] = padded8_payload_test("Padded 8 byte payload");
+        packed_entries_per_second[0] = packed8_payload_test("Packed 8 byte payload");
+        padded_entries_per_second[1] = padded16_payload_test("Padded 16 byte payload");
+        packed_entries_per_second[1] = packed16_payload_test("Packed 16 byte payload");
+        padded_entries_per_second[2] = padded32_payload_test("Padded 32 byte payload");
+        packed_entries_per_second[2] = packed32_payload_test("Packed 32 byte payload");
+
+        for (n = 0; n < sizeof(payload_sizes)/sizeof(payload_sizes[0]); ++n)
+                printf("Payload %2u bytes: padded %lf vs. packed %lf entries per second (%.2lfx)\n", payload_sizes[n],
+                       padded_entries_per_second[n], packed_entries_per_second[n], packed_entries_per_second[n] / padded_entries_per_second[n]);
+        printf("Payload checksum %" PRIuFAST64 "\n\n", payload_sum);
+
+
+        ////////////////////////////////////////////////////////////////////////////////////////
+        //            worker pools sharing a CPU-heavy handler between workers
+        ////////////////////////////////////////////////////////////////////////////////////////
+
+        rt_ring_buffer_large = rt_ring_buffer_malloc(ENTRY_BUFFER_SIZE, MAX_WORKERS);
+        if (!rt_ring_buffer_large) {
+                printf("Malloc ring buffer - ERROR\n");
+                return EXIT_FAILURE;
+        }
+        for (n = 0; n < sizeof(worker_counts)/sizeof(worker_counts[0]); ++n)
+                worker_entries_per_second[n] = worker_pool_test(rt_ring_buffer_large, worker_counts[n]);
+        free(rt_ring_buffer_large);
+
+        for (n = 0; n < sizeof(worker_counts)/sizeof(worker_counts[0]); ++n)
+                printf("Workers %2u: %lf entries per second (%.2lfx)\n", worker_counts[n],
+                       worker_entries_per_second[n], worker_entries_per_second[n] / worker_entries_per_second[0]);
+        for (n = 0; n < MAX_WORKERS; ++n)
+                worker_sum += worker_sums[n].sum;
+        printf("Worker checksum %" PRIuFAST64 "\n\n", worker_sum);
+
+
+        ////////////////////////////////////////////////////////////////////////////////////////
+        //        one ring buffer vs. a ring set of shards with more and more publishers
+        ////////////////////////////////////////////////////////////////////////////////////////
+
+        payload_sum = 0;
+        for (n = 0; n < sizeof(publisher_counts)/sizeof(publisher_counts[0]); ++n) {
+                scaling_entries_per_second[n][0] = scaling_test(publisher_counts[n], 0);
+                scaling_entries_per_second[n][1] = scaling_test(publisher_counts[n], 1);
+        }
+
+        for (n = 0; n < sizeof(publisher_counts)/sizeof(publisher_counts[0]); ++n)
+                printf("Publishers %2u: ring buffer %lf vs. ring set of %u %lf entries per second (%.2lfx)\n", publisher_counts[n],
+                       scaling_entries_per_second[n][0], RING_SET_SHARD_COUNT, scaling_entries_per_second[n][1],
+                       scaling_entries_per_second[n][1] / scaling_entries_per_second[n][0]);
+        printf("Scaling checksum %" PRIuFAST64 "\n\n", payload_sum);
+
+#if defined __linux__
+        ////////////////////////////////////////////////////////////////////////////////////////
+        //       datagrams copied into the entries vs. received straight into them
+        ////////////////////////////////////////////////////////////////////////////////////////
+
+        io_entries_per_second[0] = io_test(&net_ring_buffer, 1);
+        io_entries_per_second[1] = io_test(&net_ring_buffer, 0);
+
+        printf("Datagrams of %u bytes: copied %lf vs. zero-copy %lf entries per second (%.2lfx)\n", IO_DATAGRAM_SIZE,
+               io_entries_per_second[0], io_entries_per_second[1], io_entries_per_second[1] / io_entries_per_second[0]);
+        printf("Datagram checksum %" PRIuFAST64 "\n\n", io_sum);
+#endif
+
         return EXIT_SUCCESS;
 }
@@ -0,0 +1,299 @@
+/*
+ *  Copyright (C) 2012-2025 Jules Colding <jcolding@gmail.com>
+ *
+ *  All Rights Reserved.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *  You can use, modify and redistribute it in any way you want.
+ */
+
+/*
+ * Compares the C++ front-end of disruptor.hpp with the C macros of
+ * disruptor.h, which it should match in speed. Each of the in-order,
+ * single publisher and out-of-order ring buffers is run with one
+ * entry publisher and one entry processor, once as defined by the
+ * macros and once as a disruptor::RingBuffer, with the very same
+ * entries.
+ */
+
+#ifdef HAVE_CONFIG_H
+    #include "ac_config.h"
+#endif
+#include <unistd.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include <pthread.h>
+
+#include "src/disruptor.h"
+#include "src/disruptor.hpp"
+#include "test/payload.h"
+
+#define STOP UINT_FAST64_MAX
+#define ENTRIES_TO_GENERATE (50 * 1000 * 1000)
+#define ENTRY_BUFFER_SIZE (1024*2) // must be a power of two
+#define MAX_ENTRY_PROCESSORS (1)
+
+DEFINE_ENTRY_TYPE(payload8_t, entry_t);
+
+DEFINE_RING_BUFFER_TYPE(MAX_ENTRY_PROCESSORS, ENTRY_BUFFER_SIZE, entry_t, ring_buffer_t);
+DEFINE_RING_BUFFER_INIT(ENTRY_BUFFER_SIZE, ring_buffer_t);
+DEFINE_RING_BUFFER_SHOW_ENTRY_FUNCTION(entry_t, ring_buffer_t);
+DEFINE_RING_BUFFER_ACQUIRE_ENTRY_FUNCTION(entry_t, ring_buffer_t);
+DEFINE_ENTRY_PROCESSOR_BARRIER_REGISTER_FUNCTION(ring_buffer_t);
+DEFINE_ENTRY_PROCESSOR_BARRIER_UNREGISTER_FUNCTION(ring_buffer_t);
+DEFINE_ENTRY_PROCESSOR_BARRIER_WAITFOR_BLOCKING_FUNCTION(ring_buffer_t);
+DEFINE_ENTRY_PROCESSOR_BARRIER_RELEASEENTRY_FUNCTION(ring_buffer_t);
+DEFINE_ENTRY_PUBLISHER_NEXTENTRY_BLOCKING_FUNCTION(ring_buffer_t);
+DEFINE_ENTRY_PUBLISHER_COMMITENTRY_BLOCKING_FUNCTION(ring_buffer_t);
+
+DEFINE_SP_RING_BUFFER_TYPE(MAX_ENTRY_PROCESSORS, ENTRY_BUFFER_SIZE, entry_t, sp_ring_buffer_t);
+DEFINE_RING_BUFFER_INIT(ENTRY_BUFFER_SIZE, sp_ring_buffer_t, sp_);
+DEFINE_RING_BUFFER_SHOW_ENTRY_FUNCTION(entry_t, sp_ring_buffer_t, sp_);
+DEFINE_RING_BUFFER_ACQUIRE_ENTRY_FUNCTION(entry_t, sp_ring_buffer_t, sp_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_REGISTER_FUNCTION(sp_ring_buffer_t, sp_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_UNREGISTER_FUNCTION(sp_ring_buffer_t, sp_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_WAITFOR_BLOCKING_FUNCTION(sp_ring_buffer_t, sp_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_RELEASEENTRY_FUNCTION(sp_ring_buffer_t, sp_);
+DEFINE_SP_ENTRY_PUBLISHER_NEXTENTRY_BLOCKING_FUNCTION(sp_ring_buffer_t, sp_);
+DEFINE_SP_ENTRY_PUBLISHER_COMMITENTRY_BLOCKING_FUNCTION(sp_ring_buffer_t, sp_);
+
+DEFINE_MP_RING_BUFFER_TYPE(MAX_ENTRY_PROCESSORS, ENTRY_BUFFER_SIZE, entry_t, mp_ring_buffer_t);
+DEFINE_RING_BUFFER_INIT(ENTRY_BUFFER_SIZE, mp_ring_buffer_t, mp_);
+DEFINE_RING_BUFFER_SHOW_ENTRY_FUNCTION(entry_t, mp_ring_buffer_t, mp_);
+DEFINE_RING_BUFFER_ACQUIRE_ENTRY_FUNCTION(entry_t, mp_ring_buffer_t, mp_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_REGISTER_FUNCTION(mp_ring_buffer_t, mp_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_UNREGISTER_FUNCTION(mp_ring_buffer_t, mp_);
+DEFINE_MP_ENTRY_PROCESSOR_BARRIER_WAITFOR_BLOCKING_FUNCTION(mp_ring_buffer_t, mp_);
+DEFINE_ENTRY_PROCESSOR_BARRIER_RELEASEENTRY_FUNCTION(mp_ring_buffer_t, mp_);
+DEFINE_ENTRY_PUBLISHER_NEXTENTRY_BLOCKING_FUNCTION(mp_ring_buffer_t, mp_);
+DEFINE_MP_ENTRY_PUBLISHER_COMMITENTRY_BLOCKING_FUNCTION(mp_ring_buffer_t, mp_);
+
+typedef disruptor::RingBuffer<struct entry_t, ENTRY_BUFFER_SIZE, MAX_ENTRY_PROCESSORS, disruptor::MultiProducer> cxx_ring_buffer_t;
+typedef disruptor::RingBuffer<struct entry_t, ENTRY_BUFFER_SIZE, MAX_ENTRY_PROCESSORS, disruptor::SingleProducer> cxx_sp_ring_buffer_t;
+typedef disruptor::RingBuffer<struct entry_t, ENTRY_BUFFER_SIZE, MAX_ENTRY_PROCESSORS, disruptor::UnorderedMultiProducer> cxx_mp_ring_buffer_t;
+
+struct ring_buffer_t ring_buffer;
+struct sp_ring_buffer_t sp_ring_buffer;
+struct mp_ring_buffer_t mp_ring_buffer;
+cxx_ring_buffer_t cxx_ring_buffer;
+cxx_sp_ring_buffer_t cxx_sp_ring_buffer;
+cxx_mp_ring_buffer_t cxx_mp_ring_buffer;
+struct timeval start;
+struct timeval end;
+uint_fast64_t checksum;
+struct count_t reg_number;
+uint_fast64_t first_sequence;
+
+static int
+create_thread(pthread_t * const thread_id,
+              void *thread_arg,
+              void *(*thread_func)(void *))
+{
+        int retv = 0;
+        pthread_attr_t thread_attr;
+
+        if (pthread_attr_init(&thread_attr))
+                return 0;
+
+        if (pthread_attr_setdetachstate(&thread_attr, PTHREAD_CREATE_JOINABLE))
+                goto err;
+
+        if (pthread_create(thread_id, &thread_attr, thread_func, thread_arg))
+                goto err;
+
+        retv = 1;
+err:
+        pthread_attr_destroy(&thread_attr);
+
+        return retv;
+}
+
+/*
+ * Prints the outcome of a test and returns the number of entries per
+ * second. Exits with EXIT_FAILURE if not every entry was seen.
+ */
+static double
+report(const char * const name)
+{
+        const uint_fast64_t expected = (uint_fast64_t)ENTRIES_TO_GENERATE * (ENTRIES_TO_GENERATE + 1) / 2;
+        double start_time;
+        double end_time;
+
+        if (expected != checksum) {
+                printf("%s checksum %" PRIuFAST64 " (expected %" PRIuFAST64 ") - ERROR\n", name, checksum, expected);
+                exit(EXIT_FAILURE);
+        }
+
+        start_time = (double)start.tv_sec + (double)start.tv_usec/1000000.0;
+        end_time = (double)end.tv_sec + (double)end.tv_usec/1000000.0;
+        printf("Elapsed time = %lf seconds\n", end_time - start_time);
+        printf("Entries per second %lf\n", (double)ENTRIES_TO_GENERATE/(end_time - start_time));
+        printf("%s test done\n\n", name);
+
+        return (double)ENTRIES_TO_GENERATE/(end_time - start_time);
+}
+
+/*
+ * Defines an entry processor thread and a test function for the ring
+ * buffer type ring_buffer_type_name__ defined by the C macros with
+ * prefix__. The test function publishes ENTRIES_TO_GENERATE entries
+ * one at a time and returns the number of entries per second. The
+ * entry processor is registered before the first entry is published,
+ * so that it sees every entry. The test function is kept out of line,
+ * as everything inlined into main() counts as unlikely to run and the
+ * publisher would not be inlined in turn.
+ */
+#define DEFINE_C_TEST(ring_buffer_type_name__, prefix__)                                                      \
+static void*                                                                                                  \
+prefix__ ## c_entry_processor_thread(void *arg)                                                               \
+{                                                                                                             \
+        struct ring_buffer_type_name__ *buffer = (struct ring_buffer_type_name__*)arg;                        \
+        struct cursor_t cursor_upper_limit;                                                                   \
+        uint_fast64_t sum = 0;                                                                                \
+                                                                                                              \
+        PAYLOAD_PROCESS__(buffer, &reg_number, first_sequence, cursor_upper_limit,                            \
+                          prefix__ ## entry_processor_barrier_wait_for_blocking(buffer, &cursor_upper_limit), \
+                          sum, prefix__);                                                                     \
+        gettimeofday(&end, NULL);                                                                             \
+        checksum = sum;                                                                                       \
+        printf("Entry processor done\n");                                                                     \
+                                                                                                              \
+        return NULL;                                                                                          \
+}                                                                                                             \
+                                                                                                              \
+static __attribute__((noinline)) double                                                                       \
+prefix__ ## c_test(struct ring_buffer_type_name__ * const buffer,                                             \
+                   const char * const name)                                                                   \
+{                                                                                                             \
+        pthread_t thread_id;                                                                                  \
+        struct cursor_t cursor;                                                                               \
+        struct entry_t *entry;                                                                                \
+        uint_fast64_t reps;                                                                                   \
+                                                                                                              \
+        prefix__ ## ring_buffer_init(buffer);                                                                 \
+        first_sequence = prefix__ ## entry_processor_barrier_register(buffer, &reg_number);                   \
+        if (!create_thread(&thread_id, buffer, prefix__ ## c_entry_processor_thread)) {                       \
+                printf("could not create entry processor thread\n");                                          \
+                exit(EXIT_FAILURE);                                                                           \
+        }                                                                                                     \
+                                                                                                              \
+        reps = ENTRIES_TO_GENERATE;                                                                           \
+        gettimeofday(&start, NULL);                                                                           \
+        do {                                                                                                  \
+                prefix__ ## publisher_next_entry_blocking(buffer, &cursor);                                   \
+                entry = prefix__ ## ring_buffer_acquire_entry(buffer, &cursor);                               \
+                PAYLOAD_WRITE__(entry, cursor.sequence);                                                      \
+                prefix__ ## publisher_commit_entry_blocking(buffer, &cursor);                                 \
+        } while (--reps);                                                                                     \
+                                                                                                              \
+        prefix__ ## publisher_next_entry_blocking(buffer, &cursor);                                           \
+        entry = prefix__ ## ring_buffer_acquire_entry(buffer, &cursor);                                       \
+        entry->content[0] = STOP;                                                                             \
+        prefix__ ## publisher_commit_entry_blocking(buffer, &cursor);                                         \
+                                                                                                              \
+        /* join entry processor */                                                                            \
+        pthread_join(thread_id, NULL);                                                                        \
+        prefix__ ## entry_processor_barrier_unregister(buffer, &reg_number);                                  \
+        printf("Publisher done\n");                                                                           \
+                                                                                                              \
+        return report(name);                                                                                  \
+}
+
+DEFINE_C_TEST(ring_buffer_t, );
+DEFINE_C_TEST(sp_ring_buffer_t, sp_);
+DEFINE_C_TEST(mp_ring_buffer_t, mp_);
+
+/*
+ * The same as the entry processor threads defined by DEFINE_C_TEST,
+ * for the entry processor of a disruptor::RingBuffer given by arg.
+ */
+template <typename RingBuffer>
+static void*
+cxx_entry_processor_thread(void *arg)
+{
+        typename RingBuffer::Processor &processor = *static_cast<typename RingBuffer::Processor*>(arg);
+        const RingBuffer &buffer = processor.ring_buffer();
+        uint_fast64_t n;
+        uint_fast64_t hi;
+        uint_fast64_t sum = 0;
+
+        do {
+                hi = processor.wait_for();
+                for (n = processor.sequence(); n <= hi; ++n) {
+                        if (STOP == buffer[n].content[0])
+                                goto out;
+                        sum += PAYLOAD_SUM__(&buffer[n]);
+                }
+                processor.release(hi);
+        } while (1);
+out:
+        gettimeofday(&end, NULL);
+        checksum = sum;
+        printf("Entry processor done\n");
+
+        return NULL;
+}
+
+/*
+ * The same as the test functions defined by DEFINE_C_TEST, for a
+ * disruptor::RingBuffer. The entry processor is registered for as long
+ * as the function runs.
+ */
+template <typename RingBuffer>
+static __attribute__((noinline)) double
+cxx_test(RingBuffer * const buffer,
+         const char * const name)
+{
+        pthread_t thread_id;
+        typename RingBuffer::Processor processor(*buffer);
+        uint_fast64_t n;
+        uint_fast64_t reps;
+
+        if (!create_thread(&thread_id, &processor, cxx_entry_processor_thread<RingBuffer>)) {
+                printf("could not create entry processor thread\n");
+                exit(EXIT_FAILURE);
+        }
+
+        reps = ENTRIES_TO_GENERATE;
+        gettimeofday(&start, NULL);
+        do {
+                n = buffer->next();
+                PAYLOAD_WRITE__(&(*buffer)[n], n);
+                buffer->commit(n);
+        } while (--reps);
+
+        n = buffer->next();
+        (*buffer)[n].content[0] = STOP;
+        buffer->commit(n);
+
+        // join entry processor
+        pthread_join(thread_id, NULL);
+        printf("Publisher done\n");
+
+        return report(name);
+}
+
+int
+main(int argc, char *argv[])
+{
+        double c_entries_per_second[3];
+        double cxx_entries_per_second[3];
+        const char * const names[3] = { "In-order", "Single-Publisher", "Out-of-order" };
+        unsigned int n;
+
+        c_entries_per_second[0] = c_test(&ring_buffer, "C in-order");
+        cxx_entries_per_second[0] = cxx_test(&cxx_ring_buffer, "C++ in-order");
+        c_entries_per_second[1] = sp_c_test(&sp_ring_buffer, "C single publisher");
+        cxx_entries_per_second[1] = cxx_test(&cxx_sp_ring_buffer, "C++ single publisher");
+        c_entries_per_second[2] = mp_c_test(&mp_ring_buffer, "C out-of-order");
+        cxx_entries_per_second[2] = cxx_test(&cxx_mp_ring_buffer, "C++ out-of-order");
+
+        for (n = 0; n < sizeof(names)/sizeof(names[0]); ++n)
+                printf("%-16s: C macros %lf vs. C++ templates %lf entries per second (%.2lfx)\n", names[n],
+                       c_entries_per_second[n], cxx_entries_per_second[n], cxx_entries_per_second[n] / c_entries_per_second[n]);
+
+        return EXIT_SUCCESS;
+}